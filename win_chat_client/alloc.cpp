@@ -0,0 +1,190 @@
+﻿#include "alloc.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#ifdef __WIN32__
+#include <malloc.h>
+#endif
+
+std::atomic<size_t> allocTrace_t::count[allocTags] = {};
+std::atomic<size_t> allocTrace_t::bytes[allocTags] = {};
+std::atomic<size_t> allocTrace_t::messages{ 0 };
+thread_local allocTag_t allocTrace_t::current = allocOther;
+
+/// <summary>
+/// метод учета выделения памяти (вызывается из operator new)
+/// </summary>
+/// <param name="size"> -- размер выделения </param>
+void allocTrace_t::Add(size_t size)
+{   // счетчики лишь растут и читаются отчетом, порядок с другими данными не нужен
+    count[current].fetch_add(1, std::memory_order_relaxed);
+    bytes[current].fetch_add(size, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// метод учета сообщения чата, на которое делятся счетчики в отчете
+/// </summary>
+void allocTrace_t::Message()
+{
+    messages.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// метод обнуления счетчиков, чтобы отчет не учитывал выделения запуска
+/// </summary>
+void allocTrace_t::Reset()
+{
+    for (int tag = 0; tag < allocTags; ++tag)
+    {
+        count[tag].store(0, std::memory_order_relaxed);
+        bytes[tag].store(0, std::memory_order_relaxed);
+    }
+    messages.store(0, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// метод замены метки текущего потока
+/// </summary>
+/// <param name="tag"> -- новая метка </param>
+/// <returns> прежняя метка </returns>
+allocTag_t allocTrace_t::Swap(allocTag_t tag)
+{
+    allocTag_t result = current;
+    current = tag;
+    return result;
+}
+
+/// <summary>
+/// метод вывода отчета: выделения и байты на одно сообщение по подсистемам
+/// </summary>
+/// <param name="out"> -- поток вывода </param>
+void allocTrace_t::Report(std::ostream& out)
+{
+#ifdef ALLOC_TRACE
+    static const char* const names[allocTags] = { "other", "recv", "send", "parse", "render", "log", "input", "peer" };
+    size_t msgCount = messages.load(std::memory_order_relaxed);
+    double divider = msgCount > 0 ? static_cast<double>(msgCount) : 1.0;
+    size_t totalCount = 0, totalBytes = 0;
+
+    out << "alloc per message (" << msgCount << " messages):";
+    std::streamsize precision = out.precision(1);
+    std::ios_base::fmtflags flags = out.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    for (int tag = 0; tag < allocTags; ++tag)
+    {
+        size_t tagCount = count[tag].load(std::memory_order_relaxed);
+        size_t tagBytes = bytes[tag].load(std::memory_order_relaxed);
+        totalCount += tagCount;
+        totalBytes += tagBytes;
+        out << ' ' << names[tag] << ' ' << tagCount / divider << '/' << tagBytes / divider << 'B';
+    }
+    out << " total " << totalCount / divider << '/' << totalBytes / divider << "B\n";
+    out.precision(precision);
+    out.flags(flags);
+#else
+    (void)out;
+#endif
+}
+
+#ifdef ALLOC_TRACE
+// Глобальные operator new/delete сборки с учетом выделений: память берется из malloc,
+// каждое выделение приписывается метке текущего потока
+
+void* operator new(size_t size)
+{
+    allocTrace_t::Add(size);
+    void* result = std::malloc(size != 0 ? size : 1);
+    if (result == nullptr)
+        throw std::bad_alloc();
+    return result;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    allocTrace_t::Add(size);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void* operator new(size_t size, std::align_val_t align)
+{
+    allocTrace_t::Add(size);
+    size_t alignment = static_cast<size_t>(align);
+#ifdef __WIN32__
+    void* result = _aligned_malloc(size != 0 ? size : 1, alignment);
+#else
+    void* result = std::aligned_alloc(alignment, ((size != 0 ? size : 1) + alignment - 1) / alignment * alignment); // размер кратен выравниванию
+#endif
+    if (result == nullptr)
+        throw std::bad_alloc();
+    return result;
+}
+
+void* operator new[](size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+#ifdef __WIN32__
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete[](void* ptr, std::align_val_t align) noexcept
+{
+    operator delete(ptr, align);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t align) noexcept
+{
+    operator delete(ptr, align);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t align) noexcept
+{
+    operator delete(ptr, align);
+}
+#endif
@@ -0,0 +1,97 @@
+﻿#pragma once
+#ifndef ALLOC_H_
+#define ALLOC_H_
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+/// <summary>
+/// подсистемы, которым приписываются выделения памяти
+/// </summary>
+enum allocTag_t
+{
+    allocOther, // вне помеченных областей
+    allocRecv, // прием из сокета
+    allocSend, // отправка в сокет
+    allocParse, // разбор принятых кадров
+    allocRender, // вывод на экран и запись истории
+    allocLog, // логгирование
+    allocInput, // ввод сообщений: консоль либо генератор прогона
+    allocPeer, // собеседник прогона (эхо), в работе чата не встречается
+    allocTags // количество меток
+};
+
+/// <summary>
+/// Класс учета выделений памяти по подсистемам. В сборке с ALLOC_TRACE глобальные operator new/delete
+/// приписывают каждое выделение метке текущего потока, метку на время области ставит ALLOC_SCOPE.
+/// Без ALLOC_TRACE счетчики не растут, а ALLOC_SCOPE ничего не стоит
+/// </summary>
+class allocTrace_t
+{
+public:
+    /// <summary>
+    /// метод учета выделения памяти (вызывается из operator new)
+    /// </summary>
+    /// <param name="size"> -- размер выделения </param>
+    static void Add(size_t size);
+
+    /// <summary>
+    /// метод учета сообщения чата, на которое делятся счетчики в отчете
+    /// </summary>
+    static void Message();
+
+    /// <summary>
+    /// метод обнуления счетчиков, чтобы отчет не учитывал выделения запуска
+    /// </summary>
+    static void Reset();
+
+    /// <summary>
+    /// метод замены метки текущего потока
+    /// </summary>
+    /// <param name="tag"> -- новая метка </param>
+    /// <returns> прежняя метка </returns>
+    static allocTag_t Swap(allocTag_t tag);
+
+    /// <summary>
+    /// метод вывода отчета: выделения и байты на одно сообщение по подсистемам.
+    /// Без ALLOC_TRACE ничего не выводит
+    /// </summary>
+    /// <param name="out"> -- поток вывода </param>
+    static void Report(std::ostream& out);
+protected:
+    static std::atomic<size_t> count[allocTags]; // количество выделений по меткам
+    static std::atomic<size_t> bytes[allocTags]; // байт выделено по меткам
+    static std::atomic<size_t> messages; // учтено сообщений чата
+    static thread_local allocTag_t current; // метка текущего потока
+};
+
+/// <summary>
+/// Класс области с меткой: на время жизни объекта выделения потока приписываются метке
+/// </summary>
+class allocScope_t
+{
+public:
+    explicit allocScope_t(allocTag_t tag) : previous(allocTrace_t::Swap(tag))
+    {}
+
+    ~allocScope_t()
+    {
+        allocTrace_t::Swap(previous);
+    }
+
+    allocScope_t(const allocScope_t&) = delete;
+    allocScope_t& operator = (const allocScope_t&) = delete;
+protected:
+    allocTag_t previous; // метка внешней области
+};
+
+#ifdef ALLOC_TRACE
+#define ALLOC_SCOPE(tag) allocScope_t allocScope_##tag(tag)
+#define ALLOC_MESSAGE() allocTrace_t::Message()
+#else
+#define ALLOC_SCOPE(tag)
+#define ALLOC_MESSAGE() ((void)0)
+#endif
+
+#endif /* ALLOC_H_ */
@@ -0,0 +1,59 @@
+﻿#include "arena.h"
+
+/// <summary>
+/// конструктор
+/// </summary>
+tickArena_t::tickArena_t() : resource(block, sizeof(block), &upstream)
+{}
+
+/// <summary>
+/// метод получения арены текущего потока
+/// </summary>
+/// <returns> ссылка на арену текущего потока </returns>
+tickArena_t& tickArena_t::Local()
+{
+    static thread_local tickArena_t arena;
+    return arena;
+}
+
+/// <summary>
+/// метод получения ресурса памяти арены для std::pmr контейнеров
+/// </summary>
+/// <returns> указатель на ресурс памяти </returns>
+std::pmr::memory_resource* tickArena_t::Resource()
+{
+    return &resource;
+}
+
+/// <summary>
+/// метод освобождения всей памяти, выделенной за такт
+/// </summary>
+void tickArena_t::Reset()
+{
+    resource.release(); // следующее выделение снова начнется с начала основного блока
+}
+
+/// <summary>
+/// метод возврата количества выделений сверх основного блока с момента создания арены
+/// </summary>
+/// <returns> количество выделений из кучи </returns>
+size_t tickArena_t::Overflow() const
+{
+    return upstream.count;
+}
+
+void* tickArena_t::upstream_t::do_allocate(size_t bytes, size_t alignment)
+{
+    ++count;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void tickArena_t::upstream_t::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool tickArena_t::upstream_t::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,76 @@
+﻿#pragma once
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+/// <summary>
+/// Класс арены временных выделений памяти на один такт цикла событий.
+/// Память выдается последовательно из заранее выделенного блока и освобождается вся сразу
+/// методом Reset() в конце такта. Строки и буферы, созданные на арене, не должны переживать такт.
+/// У каждого потока своя арена
+/// </summary>
+class tickArena_t
+{
+public:
+    static const size_t blockSize = 64 * 1024; // размер основного блока арены
+
+    /// <summary>
+    /// метод получения арены текущего потока
+    /// </summary>
+    /// <returns> ссылка на арену текущего потока </returns>
+    static tickArena_t& Local();
+
+    /// <summary>
+    /// метод получения ресурса памяти арены для std::pmr контейнеров
+    /// </summary>
+    /// <returns> указатель на ресурс памяти </returns>
+    std::pmr::memory_resource* Resource();
+
+    /// <summary>
+    /// метод освобождения всей памяти, выделенной за такт
+    /// </summary>
+    void Reset();
+
+    /// <summary>
+    /// метод возврата количества выделений сверх основного блока с момента создания арены
+    /// </summary>
+    /// <returns> количество выделений из кучи </returns>
+    size_t Overflow() const;
+
+    // арена привязана к потоку, копировать ее нельзя
+    tickArena_t(const tickArena_t&) = delete;
+    tickArena_t& operator = (const tickArena_t&) = delete;
+protected:
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    tickArena_t();
+
+    /// <summary>
+    /// Класс ресурса памяти для выделений сверх основного блока, считает обращения к куче
+    /// </summary>
+    class upstream_t : public std::pmr::memory_resource
+    {
+    public:
+        upstream_t() : count(0) {}
+        size_t count; // количество выделений из кучи
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    alignas(std::max_align_t) unsigned char block[blockSize]; // основной блок арены
+    upstream_t upstream; // куча, если основного блока не хватило
+    std::pmr::monotonic_buffer_resource resource; // последовательное выделение из блока
+};
+
+/// <summary>
+/// строка, размещаемая на арене такта
+/// </summary>
+typedef std::pmr::string arenaString_t;
+
+#endif /* ARENA_H_ */
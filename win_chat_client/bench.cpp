@@ -0,0 +1,656 @@
+﻿#include "bench.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+
+#ifndef __WIN32__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "alloc.h"
+#include "arena.h"
+
+/// <summary>
+/// конструктор
+/// </summary>
+benchText_t::benchText_t() : size(0), offset(0), b_corrupt(false), received(0), errors(0), bytes(0)
+{}
+
+/// <summary>
+/// метод построения текста сообщения
+/// </summary>
+/// <param name="text"> -- текст </param>
+/// <param name="seq"> -- номер сообщения </param>
+/// <param name="size"> -- длина заполнителя </param>
+void benchText_t::Make(std::string& text, size_t seq, size_t size)
+{
+    char digits[seqSize + 1];
+    std::snprintf(digits, sizeof(digits), "%08zx", seq & 0xffffffff);
+    text.assign(digits, seqSize);
+    text.append(size, static_cast<char>('a' + seq % 26));
+}
+
+/// <summary>
+/// метод начала сверки: счетчики обнуляются, ожидается сообщение с номером 0
+/// </summary>
+/// <param name="size"> -- длина заполнителя </param>
+void benchText_t::Reset(size_t size)
+{
+    this->size = size;
+    offset = received = errors = bytes = 0;
+    b_corrupt = false;
+    Make(expected, 0, size);
+}
+
+/// <summary>
+/// метод сверки очередной части текста ожидаемого сообщения
+/// </summary>
+/// <param name="piece"> -- часть текста </param>
+void benchText_t::Check(std::string_view piece)
+{
+    size_t rest = expected.size() - offset;
+    if (piece.size() > rest || expected.compare(offset, piece.size(), piece) != 0)
+        b_corrupt = true;
+    offset += std::min(piece.size(), rest);
+    bytes += piece.size();
+}
+
+/// <summary>
+/// метод отметки ожидаемого сообщения искаженным (например, кадр не того типа)
+/// </summary>
+void benchText_t::Reject()
+{
+    b_corrupt = true;
+}
+
+/// <summary>
+/// метод проверки, что текст ожидаемого сообщения принят целиком
+/// </summary>
+/// <returns> 1 -- принят целиком </returns>
+bool benchText_t::Whole() const
+{
+    return offset == expected.size();
+}
+
+/// <summary>
+/// метод завершения сообщения: неполное либо искаженное считается ошибкой, дальше ожидается следующий номер
+/// </summary>
+void benchText_t::End()
+{
+    if (b_corrupt || !Whole())
+        ++errors;
+    ++received;
+    offset = 0;
+    b_corrupt = false;
+    Make(expected, received, size);
+    ALLOC_MESSAGE();
+}
+
+/// <summary>
+/// метод возврата количества завершенных сообщений
+/// </summary>
+/// <returns> сообщений </returns>
+size_t benchText_t::Received() const
+{
+    return received;
+}
+
+/// <summary>
+/// метод возврата количества искаженных сообщений
+/// </summary>
+/// <returns> сообщений </returns>
+size_t benchText_t::Errors() const
+{
+    return errors;
+}
+
+/// <summary>
+/// метод возврата объема сверенного текста
+/// </summary>
+/// <returns> байт </returns>
+size_t benchText_t::Bytes() const
+{
+    return bytes;
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="profile"> -- параметры канала </param>
+/// <param name="shmRing"> -- емкость кольца общей памяти (0 - прогон через канал в памяти) </param>
+/// <param name="logger"> -- объект для логгирования </param>
+bench_t::bench_t(const network::pipeProfile_t& profile, size_t shmRing, log_t& logger) : profile(profile), shmRing(shmRing), pipeSender(logger), pipeReceiver(logger),
+    shmSender(logger), shmReceiver(logger), sender(&pipeSender), receiver(&pipeReceiver), rxLength(0), resumed(0), bytes(0), lastProgress(0), logger(logger)
+{
+    if (shmRing > 0)
+    {
+        sender = &shmSender;
+        receiver = &shmReceiver;
+    }
+    receiver->SetFrameLength(&msg_t::FrameLength); // разбор кадров тот же, что у клиента
+}
+
+/// <summary>
+/// метод прогона: сообщения через буфер исходящих (SendBuffered/Flush), затем прямой отправкой
+/// с продолжением по смещению (Send/SetOffset), затем закрытие канала сразу после последнего кадра,
+/// затем сеансы sessionMux_t с разной длиной кадров через одно соединение, затем (с общей памятью) обмен со вторым процессом
+/// </summary>
+/// <param name="count"> -- сообщений на этап </param>
+/// <param name="size"> -- длина текста сообщения, байт </param>
+/// <param name="out"> -- поток вывода отчета </param>
+/// <returns> 0 - все сообщения приняты без искажений; -1 - есть искаженные либо потерянные сообщения </returns>
+int bench_t::Run(size_t count, size_t size, std::ostream& out)
+{
+    struct stage_t
+    {
+        const char* name; // имя этапа
+        int (bench_t::*work)(size_t, size_t); // метод этапа
+    };
+    static const stage_t stages[] = { { "buffered", &bench_t::Buffered }, { "direct", &bench_t::Direct } };
+
+    out << "bench: " << count << " frames of " << msg_t::headerSize + benchText_t::seqSize + size + msg_t::eomSize << " bytes, ";
+    if (shmRing > 0)
+        out << "shared memory ring " << shmRing << " bytes\n";
+    else
+        out << "latency " << profile.latency << " us, bandwidth " << profile.bandwidth << " B/s, max write " << profile.maxWrite
+            << ", capacity " << profile.capacity << (profile.b_dropOnClose ? ", drop on close\n" : "\n");
+
+    int result = 0;
+    for (const stage_t& stage : stages)
+    {
+        if (!Connect())
+            return -1;
+        rxLength = resumed = bytes = lastProgress = 0;
+        check.Reset(size);
+        progressAt = clock_t::now();
+        allocTrace_t::Reset(); // отчет этапа не учитывает предыдущий
+
+        clock_t::time_point start = clock_t::now();
+        int code = (this->*stage.work)(count, size);
+        Report(stage.name, count, clock_t::now() - start, out);
+        if (code < 0 || check.Received() != count || check.Errors() != 0)
+        {
+            out << "bench " << stage.name << " failed: received " << check.Received() << " of " << count << ", corrupted " << check.Errors() << '\n';
+            result = -1;
+        }
+    }
+
+    if (Close(size, out) < 0)
+        result = -1;
+    if (Sessions(count, size, out) < 0)
+        result = -1;
+    if (shmRing > 0 && Process(count, size, out) < 0)
+        result = -1;
+    return result;
+}
+
+/// <summary>
+/// метод соединения отправителя и получателя новым каналом
+/// </summary>
+/// <returns> 1 - соединены </returns>
+bool bench_t::Connect()
+{
+    if (shmRing > 0)
+        return network::shmTransport_t::Connect(shmSender, shmReceiver, shmRing);
+    network::pipeTransport_t::Connect(pipeSender, pipeReceiver, profile);
+    return true;
+}
+
+/// <summary>
+/// метод этапа отправки через буфер исходящих
+/// </summary>
+/// <param name="count"> -- количество сообщений </param>
+/// <param name="size"> -- длина текста сообщения </param>
+/// <returns> 0 - удачно; -1 - сбой канала либо остановка </returns>
+int bench_t::Buffered(size_t count, size_t size)
+{
+    msg_t msg;
+    for (size_t seq = 0; seq < count; ++seq)
+    {
+        Make(msg, seq, size);
+        int code;
+        {
+            ALLOC_SCOPE(allocSend);
+            code = sender->SendBuffered(msg.Str());
+        }
+        while (code >= 0 && sender->Backlog() >= window) // как клиент: сверх окна ждем, пока канал примет буфер
+        {
+            {
+                ALLOC_SCOPE(allocSend);
+                code = sender->Flush();
+            }
+            if (code >= 0 && Wait() < 0)
+                return -1;
+        }
+        if (code < 0 || Pump() < 0)
+            return -1;
+    }
+
+    while (check.Received() < count)
+    {
+        int code;
+        {
+            ALLOC_SCOPE(allocSend);
+            code = sender->Flush();
+        }
+        if (code < 0 || Wait() < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/// <summary>
+/// метод этапа прямой отправки: недописанное сообщение продолжается с запомненного смещения
+/// </summary>
+/// <param name="count"> -- количество сообщений </param>
+/// <param name="size"> -- длина текста сообщения </param>
+/// <returns> 0 - удачно; -1 - сбой канала либо остановка </returns>
+int bench_t::Direct(size_t count, size_t size)
+{
+    msg_t msg;
+    for (size_t seq = 0; seq < count; ++seq)
+    {
+        Make(msg, seq, size);
+        for (;;)
+        {
+            int code;
+            {
+                ALLOC_SCOPE(allocSend);
+                code = sender->Send(msg.Str(), msg.GetOffset());
+            }
+            if (0 == code)
+                break;
+            if (code > 0)
+            {   // канал принял часть, остаток уйдет с запомненного смещения
+                msg.SetOffset(code);
+                ++resumed;
+            }
+            else if (-3 != code)
+                return -1;
+            if (Wait() < 0)
+                return -1;
+        }
+        if (Pump() < 0)
+            return -1;
+    }
+
+    while (check.Received() < count)
+        if (Wait() < 0)
+            return -1;
+    return 0;
+}
+
+/// <summary>
+/// метод этапа закрытия: последний кадр и закрытие канала без ожидания доставки
+/// </summary>
+/// <param name="size"> -- длина текста сообщения </param>
+/// <param name="out"> -- поток вывода отчета </param>
+/// <returns> 0 - получатель увидел закрытие; -1 - закрытие не дошло </returns>
+int bench_t::Close(size_t size, std::ostream& out)
+{
+    if (!Connect())
+        return -1;
+    rxLength = bytes = 0;
+    check.Reset(size);
+
+    msg_t msg;
+    Make(msg, 0, size);
+    sender->SendBuffered(msg.Str());
+    size_t unsent = sender->Backlog(); // не принятое каналом теряется при любом закрытии
+    sender->Shutdown();
+
+    int code = 0;
+    clock_t::time_point deadline = clock_t::now() + stallTimeout;
+    while (0 == code && clock_t::now() < deadline)
+        code = Pump();
+
+    out << "bench close: last frame " << (check.Received() == 1 && check.Errors() == 0 ? "delivered" : "lost") << ", unsent " << unsent
+        << " bytes, " << (-2 == code ? "receiver saw close\n" : "close not seen\n");
+    return -2 == code ? 0 : -1;
+}
+
+/// <summary>
+/// метод этапа сеансов: sessions сеансов с кадрами разной длины делят одно соединение через sessionMux_t.
+/// Пока все сеансы ждут отправки, разница принятых байт любых двух сеансов не должна превышать
+/// границы кругового обхода с кредитом (2 кванта и наибольший кадр), иначе сеанс с короткими кадрами голодает.
+/// Этап проверяет мультиплексор, а не транспорт: канал в памяти с емкостью в квант, чтобы узким местом было соединение,
+/// а не пополнение очередей сеансов. Разница считается между тактами, когда принятое соответствует началу потока байт
+/// </summary>
+/// <param name="count"> -- сообщений на этап (делятся между сеансами) </param>
+/// <param name="size"> -- длина текста самого длинного сообщения, байт </param>
+/// <param name="out"> -- поток вывода отчета </param>
+/// <returns> 0 - все кадры приняты без искажений и сеансы не голодали; -1 - иначе </returns>
+int bench_t::Sessions(size_t count, size_t size, std::ostream& out)
+{
+    network::pipeProfile_t narrow = profile; // мультиплексор владеет транспортом, поэтому канал свой
+    if (narrow.capacity > sessionMux_t::quantum)
+        narrow.capacity = sessionMux_t::quantum;
+    narrow.b_dropOnClose = false;
+    std::shared_ptr<network::pipeTransport_t> near = std::make_shared<network::pipeTransport_t>(logger);
+    std::shared_ptr<network::pipeTransport_t> far = std::make_shared<network::pipeTransport_t>(logger);
+    network::pipeTransport_t::Connect(*near, *far, narrow);
+    sessionMux_t muxSender(near, logger);
+    sessionMux_t muxReceiver(far, logger);
+
+    size_t perSession = count / sessions > 0 ? count / sessions : 1;
+    size_t fill[sessions]; // длина заполнителя сеанса: у сеанса 1 кадры самые короткие
+    size_t sent[sessions] = {}; // кадров сеанса поставлено в очередь
+    size_t sessionBytes[sessions] = {}; // принято байт сеанса вместе с меткой
+    benchText_t checks[sessions]; // сверка кадров сеанса
+    for (unsigned indx = 0; indx < sessions; ++indx)
+    {
+        fill[indx] = size * (indx + 1) / sessions;
+        checks[indx].Reset(fill[indx]);
+        muxSender.Open(indx + 1);
+    }
+    const size_t bound = 2 * sessionMux_t::quantum + msg_t::streamSize + msg_t::headerSize + benchText_t::seqSize + size + msg_t::eomSize;
+    size_t skew = 0; // наибольшая разница принятых байт сеансов, пока все ждут отправки
+    size_t finished = 0; // сеансов, принявших все кадры
+    bytes = lastProgress = 0;
+    allocTrace_t::Reset();
+
+    int code = 0;
+    msg_t pending[sessions]; // кадры, не принятые полной очередью сеанса
+    clock_t::time_point start = clock_t::now();
+    progressAt = start;
+    while (finished < sessions && code >= 0)
+    {
+        for (unsigned indx = 0; indx < sessions; ++indx) // очереди сеансов пополняются, пока принимают кадры
+            while (sent[indx] < perSession)
+            {
+                ALLOC_SCOPE(allocSend);
+                if (pending[indx].Str().empty())
+                    Make(pending[indx], sent[indx], fill[indx]);
+                if (muxSender.Send(indx + 1, std::move(pending[indx])) != 0) // очередь полна, кадр ждет следующего такта
+                    break;
+                pending[indx] = msg_t();
+                ++sent[indx];
+            }
+        {
+            ALLOC_SCOPE(allocSend);
+            code = muxSender.Work();
+        }
+        if (code >= 0)
+        {
+            ALLOC_SCOPE(allocRecv);
+            code = muxReceiver.Work();
+        }
+        tickArena_t::Local().Reset();
+
+        unsigned id;
+        while (muxReceiver.Accept(id)) // сеансы получателя открывают первые кадры отправителя
+            ;
+        for (unsigned indx = 0; indx < sessions; ++indx)
+            while (muxReceiver.Recive(indx + 1, msg_RX))
+            {
+                ALLOC_SCOPE(allocParse);
+                if (msg_RX.Type() != TypeMsg::normal)
+                    checks[indx].Reject();
+                checks[indx].Check(msg_RX.Payload());
+                checks[indx].End();
+                sessionBytes[indx] += msg_t::streamSize + msg_RX.Str().size();
+                bytes += msg_t::streamSize + msg_RX.Str().size();
+                if (checks[indx].Received() == perSession)
+                    ++finished;
+            }
+        if (finished == 0) // все сеансы еще ждут отправки
+        {
+            auto range = std::minmax_element(sessionBytes, sessionBytes + sessions);
+            skew = std::max(skew, *range.second - *range.first);
+        }
+
+        clock_t::time_point now = clock_t::now();
+        if (bytes != lastProgress)
+        {
+            lastProgress = bytes;
+            progressAt = now;
+        }
+        else if (now - progressAt > stallTimeout)
+        {
+            logger.doLog("bench_t::Sessions() no progress, sessions finished: ", static_cast<int>(finished));
+            code = -1;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(clock_t::now() - start).count();
+    size_t received = 0, errors = 0;
+    for (const benchText_t& check : checks)
+    {
+        received += check.Received();
+        errors += check.Errors();
+    }
+    out << "bench sessions: " << sessions << " sessions, " << received << " frames, " << bytes << " bytes, " << seconds * 1000.0 << " ms, "
+        << (seconds > 0.0 ? received / seconds : 0.0) << " frames/s, max skew " << skew << " bytes (bound " << bound << ")\n";
+    allocTrace_t::Report(out);
+    if (code < 0 || received != perSession * sessions || errors != 0 || skew > bound)
+    {
+        out << "bench sessions failed: received " << received << " of " << perSession * sessions << ", corrupted " << errors << ", skew " << skew << '\n';
+        return -1;
+    }
+    return 0;
+}
+
+/// <summary>
+/// метод этапа второго процесса: клиент в дочернем процессе подключается к локальному сокету (AF_UNIX),
+/// соединение переводится на общую память (Offer()/Attach()), и процесс возвращает каждый кадр обратно.
+/// Сверяются вернувшиеся кадры и код завершения процесса. Только Linux
+/// </summary>
+/// <param name="count"> -- количество сообщений </param>
+/// <param name="size"> -- длина текста сообщения </param>
+/// <param name="out"> -- поток вывода отчета </param>
+/// <returns> 0 - все кадры вернулись без искажений и процесс завершился удачно; -1 - иначе </returns>
+int bench_t::Process(size_t count, size_t size, std::ostream& out)
+{
+#ifdef __WIN32__
+    out << "bench process: shared memory transport is not supported\n";
+    return 0;
+#else
+    std::string path = "/tmp/chat_bench_" + std::to_string(getpid()) + ".sock";
+    network::endpoint_t local;
+    if (!local.SetPath(path.c_str()))
+        return -1;
+
+    int result = -1;
+    pid_t peer = -1;
+    {   // сокеты закрываются до ожидания процесса: без сегмента он увидит закрытие и завершится
+        network::TCP_socketServer_t server(local, logger);
+        peer = fork();
+        if (0 == peer)
+            _exit(Echo(local)); // стек родителя в дочернем процессе не разматывается
+        if (peer < 0)
+            logger.doLog("bench_t::Process() fork fail, errno: ", errno);
+
+        network::TCP_socketClient_t channel(logger);
+        int code = peer > 0 ? server.AddClient(channel) : -1;
+        unlink(path.c_str()); // соединение установлено либо не будет, файл сокета больше не нужен
+        if (0 == code && shmSender.Create(shmRing) && 0 == shmSender.Offer(channel))
+        {
+            shmSender.SetFrameLength(&msg_t::FrameLength);
+            sender = receiver = &shmSender; // кадры возвращаются тем же транспортом
+            msg_RX.Update().clear(); // в буфере приема остался последний кадр этапа сеансов
+            rxLength = resumed = bytes = lastProgress = 0;
+            check.Reset(size);
+            progressAt = clock_t::now();
+            allocTrace_t::Reset();
+
+            clock_t::time_point start = clock_t::now();
+            code = Buffered(count, size);
+            Report("process", count, clock_t::now() - start, out);
+            if (code < 0 || check.Received() != count || check.Errors() != 0)
+                out << "bench process failed: received " << check.Received() << " of " << count << ", corrupted " << check.Errors() << '\n';
+            else
+                result = 0;
+            receiver = &shmReceiver;
+        }
+        else
+            out << "bench process failed: shared memory was not handed to the peer\n";
+        shmSender.Shutdown(); // процесс дочитывает кольцо и получает закрытие
+    }
+
+    int status = 0;
+    if (peer > 0 && (waitpid(peer, &status, 0) != peer || !WIFEXITED(status) || WEXITSTATUS(status) != 0))
+    {
+        out << "bench process failed: peer exit status " << status << '\n';
+        result = -1;
+    }
+    return result;
+#endif
+}
+
+/// <summary>
+/// метод работы дочернего процесса этапа второго процесса: подключение, прием сегмента и возврат кадров до закрытия
+/// </summary>
+/// <param name="server"> -- адрес локального сокета родителя </param>
+/// <returns> код завершения процесса: 0 - собеседник закрыл канал; 1 - сбой либо остановка </returns>
+int bench_t::Echo(const network::endpoint_t& server)
+{
+#ifdef __WIN32__
+    return 1;
+#else
+    network::TCP_socketClient_t channel(server, logger); // блокирующий: Attach() ждет дескрипторы
+    std::shared_ptr<network::shmTransport_t> peer = std::make_shared<network::shmTransport_t>(logger);
+    if (0 != peer->Attach(channel))
+        return 1;
+    peer->SetFrameLength(&msg_t::FrameLength);
+
+    network::NonBlockSocket_manager_t mux(logger); // на пустом кольце процесс спит до звонка
+    mux.AddReader(peer);
+    std::string piece;
+    clock_t::time_point progress = clock_t::now();
+    for (;;)
+    {
+        int code = peer->ReciveStream(piece, msg_t::EOM(), rxChunk);
+        if (-2 == code)
+            return 0;
+        if (code >= 0)
+        {
+            progress = clock_t::now();
+            if (2 != code)
+            {   // часть кадра уходит обратно как есть
+                if (peer->SendBuffered(piece) < 0)
+                    return 1;
+                piece.clear();
+            }
+            continue;
+        }
+        if (-3 != code || peer->Flush() == -1)
+            return 1;
+        if (!mux.Work(100) && clock_t::now() - progress > stallTimeout)
+            return 1;
+    }
+#endif
+}
+
+/// <summary>
+/// метод приема всего доставленного
+/// </summary>
+/// <returns> 0 - данных больше нет; -1 - системная ошибка; -2 - соединение закрыто; -4 - кадр сверх предела </returns>
+int bench_t::Pump()
+{
+    for (;;)
+    {
+        int code;
+        {
+            ALLOC_SCOPE(allocRecv);
+            code = receiver->ReciveStream(msg_RX.Update(), msg_t::EOM(), rxChunk); // длинный кадр приходит частями
+        }
+        tickArena_t::Local().Reset(); // временный буфер приема живет один вызов, как такт цикла клиента
+        if (-3 == code)
+            return 0;
+        if (code < 0)
+            return code;
+        if (2 == code) // часть еще не набрана, принятое остается в буфере
+            continue;
+
+        Check(0 == code);
+        msg_RX.Update().clear();
+    }
+}
+
+/// <summary>
+/// метод проверки принятой части кадра
+/// </summary>
+/// <param name="b_last"> -- часть заканчивает кадр </param>
+void bench_t::Check(bool b_last)
+{
+    ALLOC_SCOPE(allocParse);
+    std::string_view piece = msg_RX.Str();
+    bool b_first = rxLength == 0;
+    rxLength += piece.size();
+    bytes += piece.size();
+    if (b_first)
+    {   // начало кадра: заголовок
+        if (piece.size() < msg_t::headerSize || msg_RX.Type() != TypeMsg::normal)
+            check.Reject();
+        piece.remove_prefix(piece.size() < msg_t::headerSize ? piece.size() : msg_t::headerSize);
+    }
+    if (b_last) // конец сообщения нашел сам разбор кадров
+        piece.remove_suffix(piece.size() < msg_t::eomSize ? piece.size() : msg_t::eomSize);
+
+    check.Check(piece);
+    if (b_last)
+    {
+        check.End();
+        rxLength = 0;
+    }
+}
+
+/// <summary>
+/// метод построения очередного сообщения (benchText_t::Make())
+/// </summary>
+/// <param name="msg"> -- сообщение </param>
+/// <param name="seq"> -- номер сообщения </param>
+/// <param name="size"> -- длина заполнителя </param>
+void bench_t::Make(msg_t& msg, size_t seq, size_t size)
+{
+    ALLOC_SCOPE(allocInput);
+    benchText_t::Make(text, seq, size);
+    msg = msg_t(TypeMsg::normal, text);
+}
+
+/// <summary>
+/// метод ожидания продвижения: прием доставленного и контроль времени без принятых байт
+/// </summary>
+/// <returns> 0 - ждем дальше; -1 - канал разорван либо продвижения нет дольше stallTimeout </returns>
+int bench_t::Wait()
+{
+    int code = Pump();
+    if (code < 0)
+    {
+        logger.doLog("bench_t::Wait() recive fail, code: ", code);
+        return -1;
+    }
+
+    clock_t::time_point now = clock_t::now();
+    if (bytes != lastProgress)
+    {
+        lastProgress = bytes;
+        progressAt = now;
+    }
+    else if (now - progressAt > stallTimeout)
+    {
+        logger.doLog("bench_t::Wait() no progress, frames received: ", static_cast<int>(check.Received()));
+        return -1;
+    }
+    return 0;
+}
+
+/// <summary>
+/// метод вывода строки отчета этапа и отчета о выделениях памяти
+/// </summary>
+/// <param name="name"> -- имя этапа </param>
+/// <param name="count"> -- количество сообщений </param>
+/// <param name="elapsed"> -- время этапа </param>
+/// <param name="out"> -- поток вывода </param>
+void bench_t::Report(const char* name, size_t count, clock_t::duration elapsed, std::ostream& out)
+{
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double divider = count > 0 ? static_cast<double>(count) : 1.0;
+    out << "bench " << name << ": " << check.Received() << " frames, " << bytes << " bytes, " << seconds * 1000.0 << " ms, "
+        << (seconds > 0.0 ? check.Received() / seconds : 0.0) << " frames/s, " << seconds * 1e9 / divider << " ns/frame, partial writes "
+        << sender->PartialSends() << ", resumed sends " << resumed << '\n';
+    allocTrace_t::Report(out);
+}
@@ -0,0 +1,249 @@
+﻿#pragma once
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "log.h"
+#include "pipe.h"
+#include "shm.h"
+#include "message.h"
+#include "session.h"
+
+/// <summary>
+/// Класс текста сообщений прогона и его сверки: номер и заполнитель, зависящий от номера, поэтому сдвинутые,
+/// перемешанные либо чужие части не совпадут с ожидаемым текстом. Один для прогона транспорта (bench_t)
+/// и прогона цикла клиента, текст сообщения может приходить несколькими частями
+/// </summary>
+class benchText_t
+{
+public:
+    static const size_t seqSize = 8; // номер сообщения в начале текста (шестнадцатеричные цифры)
+
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    benchText_t();
+
+    /// <summary>
+    /// метод построения текста сообщения
+    /// </summary>
+    /// <param name="text"> -- текст </param>
+    /// <param name="seq"> -- номер сообщения </param>
+    /// <param name="size"> -- длина заполнителя </param>
+    static void Make(std::string& text, size_t seq, size_t size);
+
+    /// <summary>
+    /// метод начала сверки: счетчики обнуляются, ожидается сообщение с номером 0
+    /// </summary>
+    /// <param name="size"> -- длина заполнителя </param>
+    void Reset(size_t size);
+
+    /// <summary>
+    /// метод сверки очередной части текста ожидаемого сообщения
+    /// </summary>
+    /// <param name="piece"> -- часть текста </param>
+    void Check(std::string_view piece);
+
+    /// <summary>
+    /// метод отметки ожидаемого сообщения искаженным (например, кадр не того типа)
+    /// </summary>
+    void Reject();
+
+    /// <summary>
+    /// метод проверки, что текст ожидаемого сообщения принят целиком
+    /// </summary>
+    /// <returns> 1 -- принят целиком </returns>
+    bool Whole() const;
+
+    /// <summary>
+    /// метод завершения сообщения: неполное либо искаженное считается ошибкой, дальше ожидается следующий номер
+    /// </summary>
+    void End();
+
+    /// <summary>
+    /// метод возврата количества завершенных сообщений
+    /// </summary>
+    /// <returns> сообщений </returns>
+    size_t Received() const;
+
+    /// <summary>
+    /// метод возврата количества искаженных сообщений
+    /// </summary>
+    /// <returns> сообщений </returns>
+    size_t Errors() const;
+
+    /// <summary>
+    /// метод возврата объема сверенного текста
+    /// </summary>
+    /// <returns> байт </returns>
+    size_t Bytes() const;
+protected:
+    std::string expected; // текст ожидаемого сообщения
+    size_t size; // длина заполнителя
+    size_t offset; // принято текста ожидаемого сообщения
+    bool b_corrupt; // в ожидаемом сообщении есть искажения
+    size_t received; // завершенных сообщений
+    size_t errors; // искаженных сообщений
+    size_t bytes; // сверено байт текста
+};
+
+/// <summary>
+/// Класс прогона сообщений чата через канал в памяти (--bench) либо кольца общей памяти (--bench-shm):
+/// прием и отправка транспорта без сети, затем несколько сеансов sessionMux_t через одно соединение;
+/// с общей памятью последним этапом сегмент передается через локальный сокет второму процессу, который возвращает кадры;
+/// цикл клиента с полосами и сборкой частей тот же канал проходит следом (benchChat_t::Bench()).
+/// Прогон измеряет время и выделения памяти на сообщение и проверяет каждый принятый кадр, поэтому с частичными
+/// записями канала (maxWrite) он же проверяет дописывание буфера исходящих и продолжение отправки по смещению сообщения
+/// </summary>
+class bench_t
+{
+public:
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="profile"> -- параметры канала </param>
+    /// <param name="shmRing"> -- емкость кольца общей памяти (0 - прогон через канал в памяти) </param>
+    /// <param name="logger"> -- объект для логгирования </param>
+    bench_t(const network::pipeProfile_t& profile, size_t shmRing, log_t& logger);
+
+    bench_t(const bench_t&) = delete;
+    bench_t& operator = (const bench_t&) = delete;
+
+    /// <summary>
+    /// метод прогона: сообщения через буфер исходящих (SendBuffered/Flush), затем прямой отправкой
+    /// с продолжением по смещению (Send/SetOffset), затем закрытие канала сразу после последнего кадра,
+    /// затем сеансы sessionMux_t с разной длиной кадров через одно соединение, затем (с общей памятью) обмен со вторым процессом
+    /// </summary>
+    /// <param name="count"> -- сообщений на этап </param>
+    /// <param name="size"> -- длина текста сообщения, байт </param>
+    /// <param name="out"> -- поток вывода отчета </param>
+    /// <returns> 0 - все сообщения приняты без искажений; -1 - есть искаженные либо потерянные сообщения </returns>
+    int Run(size_t count, size_t size, std::ostream& out);
+protected:
+    typedef std::chrono::steady_clock clock_t;
+
+    static const size_t rxChunk = 16 * 1024; // наименьшая часть длинного кадра при приеме, как у клиента
+    static const size_t window = 64 * 1024; // буфер исходящих, сверх которого отправитель ждет приема
+    static constexpr std::chrono::seconds stallTimeout{ 5 }; // время без продвижения, после которого этап прерывается
+    static const unsigned sessions = 4; // сеансов на этапе сеансов
+
+    /// <summary>
+    /// метод соединения отправителя и получателя новым каналом
+    /// </summary>
+    /// <returns> 1 - соединены </returns>
+    bool Connect();
+
+    /// <summary>
+    /// метод этапа отправки через буфер исходящих
+    /// </summary>
+    /// <param name="count"> -- количество сообщений </param>
+    /// <param name="size"> -- длина текста сообщения </param>
+    /// <returns> 0 - удачно; -1 - сбой канала либо остановка </returns>
+    int Buffered(size_t count, size_t size);
+
+    /// <summary>
+    /// метод этапа прямой отправки: недописанное сообщение продолжается с запомненного смещения
+    /// </summary>
+    /// <param name="count"> -- количество сообщений </param>
+    /// <param name="size"> -- длина текста сообщения </param>
+    /// <returns> 0 - удачно; -1 - сбой канала либо остановка </returns>
+    int Direct(size_t count, size_t size);
+
+    /// <summary>
+    /// метод этапа закрытия: последний кадр и закрытие канала без ожидания доставки
+    /// </summary>
+    /// <param name="size"> -- длина текста сообщения </param>
+    /// <param name="out"> -- поток вывода отчета </param>
+    /// <returns> 0 - получатель увидел закрытие; -1 - закрытие не дошло </returns>
+    int Close(size_t size, std::ostream& out);
+
+    /// <summary>
+    /// метод этапа сеансов: sessions сеансов с кадрами разной длины делят одно соединение через sessionMux_t.
+    /// Пока все сеансы ждут отправки, разница принятых байт любых двух сеансов не должна превышать
+    /// границы кругового обхода с кредитом (2 кванта и наибольший кадр), иначе сеанс с короткими кадрами голодает.
+    /// Этап проверяет мультиплексор, а не транспорт: канал в памяти с емкостью в квант, чтобы узким местом было соединение,
+    /// а не пополнение очередей сеансов. Разница считается между тактами, когда принятое соответствует началу потока байт
+    /// </summary>
+    /// <param name="count"> -- сообщений на этап (делятся между сеансами) </param>
+    /// <param name="size"> -- длина текста самого длинного сообщения, байт </param>
+    /// <param name="out"> -- поток вывода отчета </param>
+    /// <returns> 0 - все кадры приняты без искажений и сеансы не голодали; -1 - иначе </returns>
+    int Sessions(size_t count, size_t size, std::ostream& out);
+
+    /// <summary>
+    /// метод этапа второго процесса: клиент в дочернем процессе подключается к локальному сокету (AF_UNIX),
+    /// соединение переводится на общую память (Offer()/Attach()), и процесс возвращает каждый кадр обратно.
+    /// Сверяются вернувшиеся кадры и код завершения процесса. Только Linux
+    /// </summary>
+    /// <param name="count"> -- количество сообщений </param>
+    /// <param name="size"> -- длина текста сообщения </param>
+    /// <param name="out"> -- поток вывода отчета </param>
+    /// <returns> 0 - все кадры вернулись без искажений и процесс завершился удачно; -1 - иначе </returns>
+    int Process(size_t count, size_t size, std::ostream& out);
+
+    /// <summary>
+    /// метод работы дочернего процесса этапа второго процесса: подключение, прием сегмента и возврат кадров до закрытия
+    /// </summary>
+    /// <param name="server"> -- адрес локального сокета родителя </param>
+    /// <returns> код завершения процесса: 0 - собеседник закрыл канал; 1 - сбой либо остановка </returns>
+    int Echo(const network::endpoint_t& server);
+
+    /// <summary>
+    /// метод приема всего доставленного
+    /// </summary>
+    /// <returns> 0 - данных больше нет; -1 - системная ошибка; -2 - соединение закрыто; -4 - кадр сверх предела </returns>
+    int Pump();
+
+    /// <summary>
+    /// метод проверки принятой части кадра
+    /// </summary>
+    /// <param name="b_last"> -- часть заканчивает кадр </param>
+    void Check(bool b_last);
+
+    /// <summary>
+    /// метод построения очередного сообщения (benchText_t::Make())
+    /// </summary>
+    /// <param name="msg"> -- сообщение </param>
+    /// <param name="seq"> -- номер сообщения </param>
+    /// <param name="size"> -- длина заполнителя </param>
+    void Make(msg_t& msg, size_t seq, size_t size);
+
+    /// <summary>
+    /// метод ожидания продвижения: прием доставленного и контроль времени без принятых байт
+    /// </summary>
+    /// <returns> 0 - ждем дальше; -1 - канал разорван либо продвижения нет дольше stallTimeout </returns>
+    int Wait();
+
+    /// <summary>
+    /// метод вывода строки отчета этапа и отчета о выделениях памяти
+    /// </summary>
+    /// <param name="name"> -- имя этапа </param>
+    /// <param name="count"> -- количество сообщений </param>
+    /// <param name="elapsed"> -- время этапа </param>
+    /// <param name="out"> -- поток вывода </param>
+    void Report(const char* name, size_t count, clock_t::duration elapsed, std::ostream& out);
+
+    network::pipeProfile_t profile; // параметры канала
+    size_t shmRing; // емкость кольца общей памяти (0 - канал в памяти)
+    network::pipeTransport_t pipeSender; // сторона отправителя в канале
+    network::pipeTransport_t pipeReceiver; // сторона получателя в канале
+    network::shmTransport_t shmSender; // сторона отправителя в общей памяти
+    network::shmTransport_t shmReceiver; // сторона получателя в общей памяти
+    network::transport_t* sender; // сторона отправителя прогона
+    network::transport_t* receiver; // сторона получателя прогона
+    msg_t msg_RX; // принимаемая часть кадра
+    std::string text; // буфер текста отправляемого сообщения
+    benchText_t check; // сверка принятых сообщений
+    size_t rxLength; // принято байт текущего кадра
+    size_t resumed; // отправок, продолженных по смещению
+    size_t bytes; // принято байт этапа
+    size_t lastProgress; // принято байт к последнему продвижению
+    clock_t::time_point progressAt; // время последнего продвижения
+    log_t& logger; // объект логгирования
+};
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,287 @@
+﻿#include "dns.h"
+
+#ifndef __WIN32__
+#include <netdb.h>
+#endif
+
+/// <summary>
+/// Конструктор
+/// </summary>
+/// <param name="logger"> - объект для логгирования </param>
+/// <param name="ttl"> - время жизни удачного результата в кэше, сек </param>
+/// <param name="negativeTtl"> - время жизни неудачного результата в кэше, сек </param>
+network::resolver_t::resolver_t(log_t& logger, unsigned ttl, unsigned negativeTtl) : RAII_OSsock(logger), ttl(ttl), negativeTtl(negativeTtl), b_stop(false), logger(logger)
+{
+    worker = std::thread(&resolver_t::Worker, this);
+}
+
+/// <summary>
+/// деструктор, дожидается завершения рабочего потока
+/// </summary>
+network::resolver_t::~resolver_t()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        b_stop = true;
+    }
+    cv.notify_one();
+    if (worker.joinable())
+        worker.join();
+}
+
+/// <summary>
+/// Метод получения адресов узла. IP адрес в текстовом виде разрешается сразу, без рабочего потока
+/// </summary>
+/// <param name="host"> - имя узла либо IP адрес </param>
+/// <param name="port"> - номер порта, записывается в адреса результата </param>
+/// <param name="v_result"> - массив адресов узла (заполняется при коде 0) </param>
+/// <returns> 0 - адреса получены;
+///           1 - имя разрешается, повторите вызов позже;
+///          -1 - имя не разрешено </returns>
+int network::resolver_t::Resolve(const std::string& host, unsigned short port, std::vector<endpoint_t>& v_result)
+{
+    v_result.clear();
+
+    endpoint_t literal;
+    if (literal.Set(host.c_str(), port))
+    {   // IP адрес, разрешать нечего
+        v_result.push_back(literal);
+        return 0;
+    }
+
+    int result = 1;
+    bool b_wake = false; // нужно разбудить рабочий поток
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = m_cache.find(host);
+        if (iter == m_cache.end() || (iter->second.status != 1 && iter->second.expires <= clock_t::now()))
+        {   // записи нет либо она устарела - ставим имя в очередь
+            entry_t& entry = m_cache[host];
+            entry.status = 1;
+            entry.b_logged = false;
+            d_queue.push_back(host);
+            b_wake = true;
+        }
+        else
+        {
+            entry_t& entry = iter->second;
+            result = entry.status;
+            if (result == 0)
+                for (const endpoint_t& endpoint : entry.v_endpoint)
+                {   // порт в кэше не хранится, записываем запрошенный
+                    v_result.push_back(endpoint);
+                    endpoint_t& item = v_result.back();
+                    if (item.Family() == AF_INET)
+                        reinterpret_cast<sockaddr_in*>(item.Addr())->sin_port = htons(port);
+                    else if (item.Family() == AF_INET6)
+                        reinterpret_cast<sockaddr_in6*>(item.Addr())->sin6_port = htons(port);
+                }
+            else if (result < 0 && !entry.b_logged)
+            {   // ошибку выводим один раз и только из потока цикла событий
+                entry.b_logged = true;
+#ifdef __WIN32__
+                logger.doLog("resolver_t: can't resolve " + host, entry.error);
+#else
+                logger.doLog("resolver_t: can't resolve " + host + " - " + gai_strerror(entry.error), entry.error);
+#endif
+            }
+        }
+    }
+    if (b_wake)
+        cv.notify_one();
+
+    return result;
+}
+
+/// <summary>
+/// Метод удаления записи из кэша (например, все адреса узла оказались недоступны)
+/// </summary>
+/// <param name="host"> - имя узла </param>
+void network::resolver_t::Forget(const std::string& host)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = m_cache.find(host);
+    if (iter != m_cache.end() && iter->second.status != 1) // запись в процессе разрешения оставляем рабочему потоку
+        m_cache.erase(iter);
+}
+
+/// <summary>
+/// Метод рабочего потока: разрешает имена из очереди
+/// </summary>
+void network::resolver_t::Worker()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [this] { return b_stop || !d_queue.empty(); });
+        if (b_stop)
+            break;
+
+        std::string host = d_queue.front();
+        d_queue.pop_front();
+        lock.unlock(); // getaddrinfo может идти долго, кэш в это время доступен циклу событий
+
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC; // и IPv4, и IPv6
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* list = nullptr;
+        int error = getaddrinfo(host.c_str(), nullptr, &hints, &list);
+
+        std::vector<endpoint_t> v_endpoint;
+        if (error == 0)
+        {
+            for (addrinfo* item = list; item; item = item->ai_next)
+            {
+                endpoint_t endpoint;
+                if (endpoint.Set(item->ai_addr, static_cast<socklen_t>(item->ai_addrlen)) && endpoint.Family() != AF_UNSPEC)
+                {
+                    bool b_duplicate = false; // getaddrinfo может вернуть один адрес несколько раз
+                    for (const endpoint_t& known : v_endpoint)
+                        b_duplicate |= known == endpoint;
+                    if (!b_duplicate)
+                        v_endpoint.push_back(endpoint);
+                }
+            }
+            freeaddrinfo(list);
+        }
+
+        lock.lock();
+        entry_t& entry = m_cache[host];
+        entry.v_endpoint.swap(v_endpoint);
+        entry.status = entry.v_endpoint.empty() ? -1 : 0;
+        entry.error = error;
+        entry.expires = clock_t::now() + (entry.status == 0 ? ttl : negativeTtl);
+    }
+}
+
+/// <summary>
+/// Конструктор
+/// </summary>
+/// <param name="multiplexor"> - мультиплексор, отслеживающий подключения </param>
+/// <param name="logger"> - объект для логгирования </param>
+/// <param name="delay"> - задержка запуска следующей попытки, мс </param>
+network::connector_t::connector_t(NonBlockSocket_manager_t& multiplexor, log_t& logger, unsigned delay) : multiplexor(multiplexor), logger(logger), delay(delay), next(0), profile(profile_t::NONE), deadTimeout(0)
+{}
+
+/// <summary>
+/// деструктор, снимает незавершенные попытки с мультиплексора
+/// </summary>
+network::connector_t::~connector_t()
+{
+    Stop();
+}
+
+/// <summary>
+/// Метод начала подключения
+/// </summary>
+/// <param name="v_endpoint"> - адреса узла </param>
+void network::connector_t::Start(const std::vector<endpoint_t>& v_endpoint)
+{
+    Stop();
+    if (v_endpoint.empty())
+        return;
+    // чередуем семейства адресов, начиная с семейства первого адреса (RFC 8305, 4)
+    std::vector<endpoint_t> v_first, v_second;
+    for (const endpoint_t& endpoint : v_endpoint)
+        (endpoint.Family() == v_endpoint.front().Family() ? v_first : v_second).push_back(endpoint);
+    for (size_t indx = 0; indx < v_first.size() || indx < v_second.size(); ++indx)
+    {
+        if (indx < v_first.size())
+            v_order.push_back(v_first[indx]);
+        if (indx < v_second.size())
+            v_order.push_back(v_second[indx]);
+    }
+}
+
+/// <summary>
+/// Метод продвижения подключения, вызывается каждый такт после NonBlockSocket_manager_t::Work()
+/// </summary>
+/// <param name="target"> - сокет, в который переносится установленное соединение </param>
+/// <returns> 0 - соединение установлено и перенесено в target;
+///           1 - подключение в процессе;
+///          -1 - ни к одному адресу подключиться не удалось </returns>
+int network::connector_t::Work(TCP_socketClient_t& target)
+{
+    // проверяем начатые попытки
+    for (auto iter = v_attempt.begin(); iter != v_attempt.end(); )
+    {
+        int code = multiplexor.GetReadyClient(*iter) ? (*iter)->CheckConnect() : 1;
+        if (code == 0)
+        {   // победитель: переносим соединение, остальные попытки закрываем
+            multiplexor.deleteClient(*iter);
+            target.Move(**iter);
+            v_attempt.erase(iter);
+            Stop();
+            return 0;
+        }
+        if (code < 0)
+        {
+            multiplexor.deleteClient(*iter);
+            iter = v_attempt.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    // запускаем следующую попытку, если предыдущие не успели за задержку или все уже провалились
+    clock_t::time_point now = clock_t::now();
+    while (next < v_order.size() && (v_attempt.empty() || now - lastStart >= delay))
+    {
+        auto attempt = std::make_shared<TCP_socketClient_t>(logger);
+        attempt->SetProfile(profile); // опции задаются до connect
+        attempt->SetDeadTimeout(deadTimeout);
+        int code = attempt->ConnectAsync(v_order[next++]);
+        lastStart = now;
+        if (code == 0)
+        {
+            target.Move(*attempt);
+            Stop();
+            return 0;
+        }
+        if (code > 0 && multiplexor.AddClient(attempt))
+            v_attempt.push_back(attempt);
+    }
+
+    return v_attempt.empty() && next >= v_order.size() ? -1 : 1;
+}
+
+/// <summary>
+/// Метод проверки наличия подключения в процессе
+/// </summary>
+/// <returns> 1 - подключение в процессе </returns>
+bool network::connector_t::Active() const
+{
+    return !v_attempt.empty() || next < v_order.size();
+}
+
+/// <summary>
+/// Метод задания профиля производительности для новых попыток подключения
+/// </summary>
+/// <param name="profile"> - профиль (profile_t) </param>
+void network::connector_t::SetProfile(int profile)
+{
+    this->profile = profile;
+}
+
+/// <summary>
+/// Метод задания предела ожидания подтверждения отправленных данных для новых попыток подключения
+/// (TCP_socketClient_t::SetDeadTimeout())
+/// </summary>
+/// <param name="timeout"> - предел, мс (0 - по умолчанию ОС) </param>
+void network::connector_t::SetDeadTimeout(unsigned timeout)
+{
+    deadTimeout = timeout;
+}
+
+/// <summary>
+/// Метод остановки всех попыток
+/// </summary>
+void network::connector_t::Stop()
+{
+    for (auto& attempt : v_attempt)
+        multiplexor.deleteClient(attempt);
+    v_attempt.clear();
+    v_order.clear();
+    next = 0;
+}
@@ -0,0 +1,168 @@
+﻿#pragma once
+#ifndef DNS_H_
+#define DNS_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "network.h"
+
+/// <summary>
+/// простанство имен классов для работы с сетью
+/// </summary>
+namespace network
+{
+    /// <summary>
+    /// Класс асинхронного разрешения имен узлов (getaddrinfo в рабочем потоке) с кэшем результатов.
+    /// Цикл событий не блокируется: пока имя разрешается, Resolve() возвращает 1 и вызывается повторно на следующих тактах.
+    /// getaddrinfo не сообщает TTL записей, поэтому время жизни записей кэша задается конструктором
+    /// </summary>
+    class resolver_t : private RAII_OSsock
+    {
+    public:
+        /// <summary>
+        /// Конструктор
+        /// </summary>
+        /// <param name="logger"> - объект для логгирования </param>
+        /// <param name="ttl"> - время жизни удачного результата в кэше, сек </param>
+        /// <param name="negativeTtl"> - время жизни неудачного результата в кэше, сек </param>
+        resolver_t(log_t& logger, unsigned ttl = 60, unsigned negativeTtl = 5);
+
+        /// <summary>
+        /// деструктор, дожидается завершения рабочего потока
+        /// </summary>
+        virtual ~resolver_t();
+
+        // рабочий поток привязан к объекту, копирование запрещено
+        resolver_t(const resolver_t&) = delete;
+        resolver_t& operator = (const resolver_t&) = delete;
+
+        /// <summary>
+        /// Метод получения адресов узла. IP адрес в текстовом виде разрешается сразу, без рабочего потока
+        /// </summary>
+        /// <param name="host"> - имя узла либо IP адрес </param>
+        /// <param name="port"> - номер порта, записывается в адреса результата </param>
+        /// <param name="v_result"> - массив адресов узла (заполняется при коде 0) </param>
+        /// <returns> 0 - адреса получены;
+        ///           1 - имя разрешается, повторите вызов позже;
+        ///          -1 - имя не разрешено </returns>
+        int Resolve(const std::string& host, unsigned short port, std::vector<endpoint_t>& v_result);
+
+        /// <summary>
+        /// Метод удаления записи из кэша (например, все адреса узла оказались недоступны)
+        /// </summary>
+        /// <param name="host"> - имя узла </param>
+        void Forget(const std::string& host);
+    protected:
+        typedef std::chrono::steady_clock clock_t;
+
+        /// <summary>
+        /// Запись кэша
+        /// </summary>
+        struct entry_t
+        {
+            std::vector<endpoint_t> v_endpoint; // адреса узла (порт не задан)
+            clock_t::time_point expires; // момент устаревания записи
+            int status = 1; // 0 - разрешено, 1 - в процессе, -1 - ошибка
+            int error = 0; // код ошибки getaddrinfo
+            bool b_logged = false; // ошибка уже выведена в лог
+        };
+
+        /// <summary>
+        /// Метод рабочего потока: разрешает имена из очереди
+        /// </summary>
+        void Worker();
+    protected:
+        std::unordered_map<std::string, entry_t> m_cache; // кэш результатов по имени узла
+        std::deque<std::string> d_queue; // очередь имен на разрешение
+        std::mutex mutex; // защита кэша и очереди
+        std::condition_variable cv; // пробуждение рабочего потока
+        std::thread worker; // рабочий поток
+        std::chrono::seconds ttl; // время жизни удачного результата
+        std::chrono::seconds negativeTtl; // время жизни неудачного результата
+        bool b_stop; // флаг остановки рабочего потока
+        log_t& logger; // объект логгирования, используется только из потока цикла событий
+    };
+
+    /// <summary>
+    /// Класс подключения к узлу с несколькими адресами по алгоритму happy eyeballs (RFC 8305):
+    /// попытки подключения к адресам IPv6 и IPv4 чередуются и запускаются с задержкой друг за другом,
+    /// побеждает первое установленное соединение, остальные закрываются
+    /// </summary>
+    class connector_t
+    {
+    public:
+        /// <summary>
+        /// Конструктор
+        /// </summary>
+        /// <param name="multiplexor"> - мультиплексор, отслеживающий подключения </param>
+        /// <param name="logger"> - объект для логгирования </param>
+        /// <param name="delay"> - задержка запуска следующей попытки, мс </param>
+        connector_t(NonBlockSocket_manager_t& multiplexor, log_t& logger, unsigned delay = 250);
+
+        /// <summary>
+        /// деструктор, снимает незавершенные попытки с мультиплексора
+        /// </summary>
+        ~connector_t();
+
+        /// <summary>
+        /// Метод начала подключения
+        /// </summary>
+        /// <param name="v_endpoint"> - адреса узла </param>
+        void Start(const std::vector<endpoint_t>& v_endpoint);
+
+        /// <summary>
+        /// Метод продвижения подключения, вызывается каждый такт после NonBlockSocket_manager_t::Work()
+        /// </summary>
+        /// <param name="target"> - сокет, в который переносится установленное соединение </param>
+        /// <returns> 0 - соединение установлено и перенесено в target;
+        ///           1 - подключение в процессе;
+        ///          -1 - ни к одному адресу подключиться не удалось </returns>
+        int Work(TCP_socketClient_t& target);
+
+        /// <summary>
+        /// Метод проверки наличия подключения в процессе
+        /// </summary>
+        /// <returns> 1 - подключение в процессе </returns>
+        bool Active() const;
+
+        /// <summary>
+        /// Метод задания профиля производительности для новых попыток подключения
+        /// </summary>
+        /// <param name="profile"> - профиль (profile_t) </param>
+        void SetProfile(int profile);
+
+        /// <summary>
+        /// Метод задания предела ожидания подтверждения отправленных данных для новых попыток подключения
+        /// (TCP_socketClient_t::SetDeadTimeout())
+        /// </summary>
+        /// <param name="timeout"> - предел, мс (0 - по умолчанию ОС) </param>
+        void SetDeadTimeout(unsigned timeout);
+    protected:
+        /// <summary>
+        /// Метод остановки всех попыток
+        /// </summary>
+        void Stop();
+    protected:
+        typedef std::chrono::steady_clock clock_t;
+
+        NonBlockSocket_manager_t& multiplexor; // мультиплексор
+        log_t& logger; // объект логгирования
+        std::chrono::milliseconds delay; // задержка между попытками
+        std::vector<endpoint_t> v_order; // адреса в порядке попыток
+        size_t next; // индекс следующего адреса
+        int profile; // профиль производительности сокетов
+        unsigned deadTimeout; // предел ожидания подтверждения, мс
+        clock_t::time_point lastStart; // время запуска последней попытки
+        std::vector<std::shared_ptr<TCP_socketClient_t>> v_attempt; // незавершенные попытки
+    };
+};
+
+#endif /* DNS_H_ */
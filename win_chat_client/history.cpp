@@ -0,0 +1,549 @@
+﻿#include "history.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+
+#ifdef __WIN32__
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // !WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const char dataMagic[8] = { 'C', 'H', 'A', 'T', 'H', 'I', 'S', '1' }; // сигнатура файла данных
+static const char indexMagic[8] = { 'C', 'H', 'A', 'T', 'I', 'D', 'X', '1' }; // сигнатура файла индекса
+
+/// <summary>
+/// функция перевода времени в местное
+/// </summary>
+/// <param name="time"> -- время, сек от начала эпохи </param>
+/// <param name="result"> -- местное время </param>
+/// <returns> 1 -- время переведено </returns>
+static bool LocalTime(std::time_t time, std::tm& result)
+{
+#ifdef __WIN32__
+    return localtime_s(&result, &time) == 0;
+#else
+    return localtime_r(&time, &result) != nullptr;
+#endif
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+history_t::mapping_t::mapping_t() : data(nullptr), size(0), fileSize(0),
+#ifdef __WIN32__
+    file(INVALID_HANDLE_VALUE), map(NULL)
+#else
+    fd(-1)
+#endif
+{}
+
+/// <summary>
+/// деструктор
+/// </summary>
+history_t::mapping_t::~mapping_t()
+{
+    Unmap();
+#ifdef __WIN32__
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+#else
+    if (fd >= 0)
+        close(fd);
+#endif
+}
+
+/// <summary>
+/// метод открытия файла и отображения его в память
+/// </summary>
+/// <param name="path"> -- путь к файлу </param>
+/// <param name="minSize"> -- наименьший размер отображения </param>
+/// <param name="logger"> -- объект для логгирования </param>
+/// <returns> 1 -- файл отображен </returns>
+bool history_t::mapping_t::Open(const std::string& path, size_t minSize, log_t& logger)
+{
+    this->path = path;
+    fileSize = SIZE_MAX; // пока размер не известен, закрытие файл не обрезает
+#ifdef __WIN32__
+    // без совместного доступа: второй клиент в том же каталоге историю не испортит
+    file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        logger.doLog("history_t: can't open " + path, GetLastError());
+        return false;
+    }
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length))
+    {
+        logger.doLog("history_t: can't get size " + path, GetLastError());
+        return false;
+    }
+    fileSize = static_cast<size_t>(length.QuadPart);
+#else
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        logger.doLog("history_t: can't open " + path, errno);
+        return false;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) // второй клиент в том же каталоге историю не испортит
+    {
+        logger.doLog("history_t: file in use " + path, errno);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        logger.doLog("history_t: can't get size " + path, errno);
+        return false;
+    }
+    fileSize = static_cast<size_t>(info.st_size);
+#endif
+    // отображение не читает файл: страницы подгружаются только при обращении
+    return Map((std::max)(fileSize, minSize), logger);
+}
+
+/// <summary>
+/// метод увеличения файла и отображения
+/// </summary>
+/// <param name="size"> -- требуемый размер </param>
+/// <param name="logger"> -- объект для логгирования </param>
+/// <returns> 1 -- отображение не меньше требуемого размера </returns>
+bool history_t::mapping_t::Reserve(size_t size, log_t& logger)
+{
+    if (size <= this->size)
+        return true;
+    size_t grow = (std::max)(size, this->size + this->size / 2); // увеличиваем с запасом, чтобы реже переотображать
+    return Map((grow + growStep - 1) / growStep * growStep, logger);
+}
+
+/// <summary>
+/// метод отображения файла заданного размера (файл увеличивается до него)
+/// </summary>
+/// <param name="size"> -- размер отображения </param>
+/// <param name="logger"> -- объект для логгирования </param>
+/// <returns> 1 -- файл отображен </returns>
+bool history_t::mapping_t::Map(size_t size, log_t& logger)
+{
+    // новое отображение создается до снятия прежнего: при ошибке прежнее остается в силе
+#ifdef __WIN32__
+    unsigned long long length = size;
+    HANDLE newMap = CreateFileMappingA(file, NULL, PAGE_READWRITE, static_cast<DWORD>(length >> 32), static_cast<DWORD>(length), NULL); // увеличивает файл
+    if (newMap == NULL)
+    {
+        logger.doLog("history_t: can't map " + path, GetLastError());
+        return false;
+    }
+    char* address = static_cast<char*>(MapViewOfFile(newMap, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (address == nullptr)
+    {
+        logger.doLog("history_t: can't map " + path, GetLastError());
+        CloseHandle(newMap);
+        return false;
+    }
+    Unmap();
+    map = newMap;
+    data = address;
+#else
+    if (size > this->size && ftruncate(fd, size) != 0) // файл только растет: прежнее отображение остается в его пределах
+    {
+        logger.doLog("history_t: can't resize " + path, errno);
+        return false;
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+    {
+        logger.doLog("history_t: can't map " + path, errno);
+        return false;
+    }
+    Unmap();
+    data = static_cast<char*>(address);
+#endif
+    this->size = size;
+    return true;
+}
+
+/// <summary>
+/// метод снятия отображения
+/// </summary>
+void history_t::mapping_t::Unmap()
+{
+#ifdef __WIN32__
+    if (data)
+        UnmapViewOfFile(data);
+    if (map != NULL)
+        CloseHandle(map);
+    map = NULL;
+#else
+    if (data)
+        munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+/// <summary>
+/// метод закрытия: отображение снимается, файл обрезается до заданного размера
+/// </summary>
+/// <param name="size"> -- размер файла после закрытия; SIZE_MAX - не менять </param>
+void history_t::mapping_t::Close(size_t size)
+{
+    Unmap();
+#ifdef __WIN32__
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER length;
+        length.QuadPart = static_cast<LONGLONG>(size);
+        if (size != SIZE_MAX && SetFilePointerEx(file, length, NULL, FILE_BEGIN))
+            SetEndOfFile(file);
+        CloseHandle(file);
+    }
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (fd >= 0)
+    {
+        if (size != SIZE_MAX && ftruncate(fd, size) != 0) {} // запас в конце файла не мешает: занятый размер хранится в заголовке
+        close(fd);
+    }
+    fd = -1;
+#endif
+    fileSize = size;
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="logger"> -- объект для логгирования </param>
+history_t::history_t(log_t& logger) : nextIndex(dataStart), b_open(false), logger(logger)
+{}
+
+/// <summary>
+/// деструктор, закрывает файлы
+/// </summary>
+history_t::~history_t()
+{
+    Close();
+}
+
+/// <summary>
+/// метод открытия (создания) истории
+/// </summary>
+/// <param name="path"> -- путь к файлам истории без расширения </param>
+/// <returns> 1 -- история открыта </returns>
+bool history_t::Open(const std::string& path)
+{
+    Close();
+
+    bool b_result = data.Open(path + ".dat", growStep, logger) && index.Open(path + ".idx", growStep, logger);
+    if (b_result)
+    {
+        if (data.fileSize == 0)
+        {   // новая история
+            memcpy(DataHeader()->magic, dataMagic, sizeof(dataMagic));
+            DataHeader()->used = dataStart;
+            DataHeader()->count = 0;
+            DataHeader()->lastTime = 0;
+        }
+        if (index.fileSize == 0)
+        {
+            memcpy(IndexHeader()->magic, indexMagic, sizeof(indexMagic));
+            IndexHeader()->count = 0;
+        }
+        // проверяются только заголовки: открытие не зависит от размера истории
+        const dataHeader_t* header = DataHeader();
+        b_result = memcmp(header->magic, dataMagic, sizeof(dataMagic)) == 0 && header->used >= dataStart && (header->used <= data.fileSize || data.fileSize == 0)
+            && memcmp(IndexHeader()->magic, indexMagic, sizeof(indexMagic)) == 0
+            && IndexHeader()->count <= (index.size - sizeof(indexHeader_t)) / sizeof(indexEntry_t);
+        if (!b_result)
+            logger.doLog("history_t: bad history file " + path);
+    }
+    if (!b_result)
+    {   // чужие или испорченные файлы не трогаем: возвращаем прежний размер
+        data.Close(data.fileSize);
+        index.Close(index.fileSize);
+        return false;
+    }
+
+    // элементы индекса, записанные до сбоя позже самих записей, отбрасываем
+    uint64_t& count = IndexHeader()->count;
+    while (count > 0 && Index()[count - 1].offset >= DataHeader()->used)
+        --count;
+    nextIndex = count > 0 ? Index()[count - 1].offset + indexStep : dataStart;
+    b_open = true;
+
+    return true;
+}
+
+/// <summary>
+/// метод закрытия истории, файлы обрезаются до занятого размера
+/// </summary>
+void history_t::Close()
+{
+    if (!b_open)
+        return;
+    b_open = false;
+    size_t dataSize = static_cast<size_t>(DataHeader()->used);
+    size_t indexSize = sizeof(indexHeader_t) + static_cast<size_t>(IndexHeader()->count) * sizeof(indexEntry_t);
+    data.Close(dataSize);
+    index.Close(indexSize);
+}
+
+/// <summary>
+/// метод добавления сообщения в историю
+/// </summary>
+/// <param name="direction"> -- направление сообщения </param>
+/// <param name="msg"> -- сообщение; сообщения без текста для вывода не сохраняются </param>
+/// <returns> 1 -- сообщение сохранено </returns>
+bool history_t::Append(direction_t direction, const msg_t& msg)
+{
+    std::string_view text = msg.Print();
+    if (!b_open || text.empty() || text.size() > UINT32_MAX)
+        return false;
+
+    uint64_t offset = DataHeader()->used;
+    if (!data.Reserve(static_cast<size_t>(offset + recordHeaderSize + text.size()), logger))
+        return false;
+    dataHeader_t* header = DataHeader(); // отображение могло переехать
+
+    // время не убывает (часы могли перевести назад), иначе двоичный поиск по индексу неверен
+    uint64_t time = (std::max)(Now(), header->lastTime);
+    uint32_t length = static_cast<uint32_t>(text.size());
+    char* record = data.data + offset;
+    memcpy(record, &time, sizeof(time));
+    memcpy(record + 8, &length, sizeof(length));
+    record[12] = static_cast<char>(direction);
+    record[13] = static_cast<char>(msg.Type());
+    memcpy(record + recordHeaderSize, text.data(), text.size());
+
+    if (offset >= nextIndex)
+    {   // элемент индекса; без него запись все равно найдется - поиск начнется раньше
+        uint64_t count = IndexHeader()->count;
+        if (index.Reserve(sizeof(indexHeader_t) + static_cast<size_t>(count + 1) * sizeof(indexEntry_t), logger))
+        {
+            Index()[count] = indexEntry_t{ time, offset };
+            IndexHeader()->count = count + 1;
+            nextIndex = offset + indexStep;
+        }
+    }
+
+    // занятый размер меняется последним: запись, прерванная сбоем, при открытии не видна
+    header->lastTime = time;
+    ++header->count;
+    header->used = offset + recordHeaderSize + text.size();
+
+    return true;
+}
+
+/// <summary>
+/// метод выборки записей за интервал времени
+/// </summary>
+/// <param name="from"> -- начало интервала, мкс от начала эпохи </param>
+/// <param name="to"> -- конец интервала включительно, мкс от начала эпохи </param>
+/// <param name="v_result"> -- записи интервала в порядке времени </param>
+/// <param name="limit"> -- наибольшее количество записей </param>
+/// <returns> 0 -- выбраны все записи интервала;
+///           1 -- записей больше limit, выбраны первые;
+///          -1 -- история не открыта </returns>
+int history_t::Query(uint64_t from, uint64_t to, std::vector<record_t>& v_result, size_t limit) const
+{
+    v_result.clear();
+    if (!b_open)
+        return -1;
+
+    // первый элемент индекса со временем не меньше from; записи до предыдущего элемента заведомо раньше from
+    const indexEntry_t* begin = Index();
+    const indexEntry_t* end = begin + IndexHeader()->count;
+    const indexEntry_t* iter = std::lower_bound(begin, end, from, [](const indexEntry_t& entry, uint64_t time) { return entry.time < time; });
+    uint64_t offset = iter == begin ? dataStart : static_cast<uint64_t>((iter - 1)->offset);
+
+    uint64_t used = DataHeader()->used;
+    record_t record;
+    while (offset < used)
+    {
+        offset = ReadRecord(offset, record);
+        if (record.time > to)
+            break;
+        if (record.time < from)
+            continue;
+        if (v_result.size() == limit)
+            return 1;
+        v_result.push_back(record);
+    }
+
+    return 0;
+}
+
+/// <summary>
+/// метод возврата количества записей
+/// </summary>
+/// <returns> количество записей </returns>
+uint64_t history_t::Count() const
+{
+    return b_open ? DataHeader()->count : 0;
+}
+
+/// <summary>
+/// метод чтения записи по смещению (для внешних индексов истории)
+/// </summary>
+/// <param name="offset"> -- смещение записи, от Begin() до End() </param>
+/// <param name="record"> -- запись </param>
+/// <returns> смещение следующей записи; 0 -- смещение вне истории </returns>
+uint64_t history_t::Read(uint64_t offset, record_t& record) const
+{
+    if (!b_open || offset < dataStart || offset + recordHeaderSize > DataHeader()->used)
+        return 0;
+    offset = ReadRecord(offset, record);
+    return record.time == UINT64_MAX ? 0 : offset;
+}
+
+/// <summary>
+/// метод возврата смещения первой записи
+/// </summary>
+/// <returns> смещение первой записи </returns>
+uint64_t history_t::Begin() const
+{
+    return dataStart;
+}
+
+/// <summary>
+/// метод возврата смещения за последней записью (смещение следующей записи)
+/// </summary>
+/// <returns> смещение за последней записью; 0 -- история не открыта </returns>
+uint64_t history_t::End() const
+{
+    return b_open ? DataHeader()->used : 0;
+}
+
+/// <summary>
+/// метод чтения заголовка записи
+/// </summary>
+/// <param name="offset"> -- смещение записи в файле данных </param>
+/// <param name="record"> -- запись </param>
+/// <returns> смещение следующей записи </returns>
+uint64_t history_t::ReadRecord(uint64_t offset, record_t& record) const
+{
+    const char* source = data.data + offset;
+    uint32_t length = 0;
+    memcpy(&record.time, source, sizeof(record.time)); // записи не выровнены
+    memcpy(&length, source + 8, sizeof(length));
+    record.direction = static_cast<direction_t>(source[12]);
+    record.type = static_cast<TypeMsg>(source[13]);
+
+    uint64_t next = offset + recordHeaderSize + length;
+    if (next > DataHeader()->used) // испорченная запись, дальше не читаем
+    {
+        record.time = UINT64_MAX;
+        return DataHeader()->used;
+    }
+    record.text = std::string_view(source + recordHeaderSize, length);
+    return next;
+}
+
+history_t::dataHeader_t* history_t::DataHeader() const
+{
+    return reinterpret_cast<dataHeader_t*>(data.data);
+}
+
+history_t::indexHeader_t* history_t::IndexHeader() const
+{
+    return reinterpret_cast<indexHeader_t*>(index.data);
+}
+
+history_t::indexEntry_t* history_t::Index() const
+{
+    return reinterpret_cast<indexEntry_t*>(index.data + sizeof(indexHeader_t));
+}
+
+/// <summary>
+/// метод разбора времени: "now", секунды от начала эпохи, "ЧЧ:ММ[:СС]" (сегодня),
+/// "ГГГГ-ММ-ДД[TЧЧ:ММ[:СС]]" (местное время)
+/// </summary>
+/// <param name="text"> -- текст времени </param>
+/// <param name="time"> -- время, мкс от начала эпохи </param>
+/// <param name="b_end"> -- конец интервала: последняя микросекунда указанной секунды, минуты либо дня </param>
+/// <returns> 1 -- время распознано </returns>
+bool history_t::ParseTime(std::string_view text, uint64_t& time, bool b_end)
+{
+    std::string str(text);
+    if (str == "now")
+    {
+        time = Now();
+        return true;
+    }
+    if (!str.empty() && str.find_first_not_of("0123456789") == std::string::npos)
+    {
+        time = std::strtoull(str.c_str(), NULL, 10) * 1000000 + (b_end ? 999999 : 0);
+        return true;
+    }
+
+    std::tm tm;
+    if (!LocalTime(std::time(nullptr), tm))
+        return false;
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    char tail = 0;
+    int count = sscanf(str.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d%c", &year, &month, &day, &hour, &minute, &second, &tail);
+    if (count == 3 || count == 5 || count == 6)
+    {
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+    }
+    else
+    {   // только время - сегодня
+        hour = minute = second = 0;
+        count = sscanf(str.c_str(), "%2d:%2d:%2d%c", &hour, &minute, &second, &tail);
+        if (count != 2 && count != 3)
+            return false;
+    }
+    if (month < 0 || month > 12 || day < 0 || day > 31 || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60)
+        return false;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    if (b_end) // начало следующей единицы; mktime нормализует переполнение полей
+        ++(count == 3 ? tm.tm_mday : count == 2 || count == 5 ? tm.tm_min : tm.tm_sec);
+    tm.tm_isdst = -1; // летнее время определит mktime
+
+    std::time_t result = std::mktime(&tm);
+    if (result == static_cast<std::time_t>(-1))
+        return false;
+    time = static_cast<uint64_t>(result) * 1000000 - (b_end ? 1 : 0);
+    return true;
+}
+
+/// <summary>
+/// метод форматирования времени записи "ГГГГ-ММ-ДД ЧЧ:ММ:СС.ммм" (местное время)
+/// </summary>
+/// <param name="time"> -- время, мкс от начала эпохи </param>
+/// <returns> текст времени </returns>
+std::string history_t::FormatTime(uint64_t time)
+{
+    char buf[32] = "";
+    std::tm tm;
+    if (LocalTime(static_cast<std::time_t>(time / 1000000), tm))
+    {
+        size_t size = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        snprintf(buf + size, sizeof(buf) - size, ".%03u", static_cast<unsigned>(time / 1000 % 1000));
+    }
+    return buf;
+}
+
+/// <summary>
+/// метод получения текущего времени
+/// </summary>
+/// <returns> время, мкс от начала эпохи </returns>
+uint64_t history_t::Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
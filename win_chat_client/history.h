@@ -0,0 +1,250 @@
+﻿#pragma once
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log.h"
+#include "message.h"
+
+/// <summary>
+/// Класс локальной истории чата. Каждое отправленное и принятое сообщение дописывается в конец файла
+/// "<путь>.dat" компактной двоичной записью: время (мкс), длина текста, направление, тип, текст.
+/// Время записей не убывает, поэтому файл упорядочен по времени. Раз в indexStep байт данных
+/// в файл "<путь>.idx" добавляется элемент разреженного индекса: время и смещение записи.
+/// Оба файла отображены в память: запись - копирование в отображение, запрос диапазона -
+/// двоичный поиск по индексу и чтение только нужных записей. Открытие не читает файл целиком,
+/// поэтому не зависит от размера истории
+/// </summary>
+class history_t
+{
+public:
+    /// <summary>
+    /// направление сообщения
+    /// </summary>
+    enum direction_t
+    {
+        in, // принято от собеседника
+        out // отправлено собеседнику
+    };
+
+    /// <summary>
+    /// запись истории, текст указывает в отображение файла и действителен до следующего Append()
+    /// </summary>
+    struct record_t
+    {
+        uint64_t time; // время, мкс от начала эпохи
+        direction_t direction; // направление
+        TypeMsg type; // тип сообщения
+        std::string_view text; // текст сообщения
+    };
+
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="logger"> -- объект для логгирования </param>
+    history_t(log_t& logger);
+
+    /// <summary>
+    /// деструктор, закрывает файлы
+    /// </summary>
+    ~history_t();
+
+    history_t(const history_t&) = delete;
+    history_t& operator = (const history_t&) = delete;
+
+    /// <summary>
+    /// метод открытия (создания) истории
+    /// </summary>
+    /// <param name="path"> -- путь к файлам истории без расширения </param>
+    /// <returns> 1 -- история открыта </returns>
+    bool Open(const std::string& path);
+
+    /// <summary>
+    /// метод закрытия истории, файлы обрезаются до занятого размера
+    /// </summary>
+    void Close();
+
+    /// <summary>
+    /// метод добавления сообщения в историю
+    /// </summary>
+    /// <param name="direction"> -- направление сообщения </param>
+    /// <param name="msg"> -- сообщение; сообщения без текста для вывода не сохраняются </param>
+    /// <returns> 1 -- сообщение сохранено </returns>
+    bool Append(direction_t direction, const msg_t& msg);
+
+    /// <summary>
+    /// метод выборки записей за интервал времени
+    /// </summary>
+    /// <param name="from"> -- начало интервала, мкс от начала эпохи </param>
+    /// <param name="to"> -- конец интервала включительно, мкс от начала эпохи </param>
+    /// <param name="v_result"> -- записи интервала в порядке времени </param>
+    /// <param name="limit"> -- наибольшее количество записей </param>
+    /// <returns> 0 -- выбраны все записи интервала;
+    ///           1 -- записей больше limit, выбраны первые;
+    ///          -1 -- история не открыта </returns>
+    int Query(uint64_t from, uint64_t to, std::vector<record_t>& v_result, size_t limit) const;
+
+    /// <summary>
+    /// метод возврата количества записей
+    /// </summary>
+    /// <returns> количество записей </returns>
+    uint64_t Count() const;
+
+    /// <summary>
+    /// метод чтения записи по смещению (для внешних индексов истории)
+    /// </summary>
+    /// <param name="offset"> -- смещение записи, от Begin() до End() </param>
+    /// <param name="record"> -- запись </param>
+    /// <returns> смещение следующей записи; 0 -- смещение вне истории </returns>
+    uint64_t Read(uint64_t offset, record_t& record) const;
+
+    /// <summary>
+    /// метод возврата смещения первой записи
+    /// </summary>
+    /// <returns> смещение первой записи </returns>
+    uint64_t Begin() const;
+
+    /// <summary>
+    /// метод возврата смещения за последней записью (смещение следующей записи)
+    /// </summary>
+    /// <returns> смещение за последней записью; 0 -- история не открыта </returns>
+    uint64_t End() const;
+
+    /// <summary>
+    /// метод разбора времени: "now", секунды от начала эпохи, "ЧЧ:ММ[:СС]" (сегодня),
+    /// "ГГГГ-ММ-ДД[TЧЧ:ММ[:СС]]" (местное время)
+    /// </summary>
+    /// <param name="text"> -- текст времени </param>
+    /// <param name="time"> -- время, мкс от начала эпохи </param>
+    /// <param name="b_end"> -- конец интервала: последняя микросекунда указанной секунды, минуты либо дня </param>
+    /// <returns> 1 -- время распознано </returns>
+    static bool ParseTime(std::string_view text, uint64_t& time, bool b_end = false);
+
+    /// <summary>
+    /// метод форматирования времени записи "ГГГГ-ММ-ДД ЧЧ:ММ:СС.ммм" (местное время)
+    /// </summary>
+    /// <param name="time"> -- время, мкс от начала эпохи </param>
+    /// <returns> текст времени </returns>
+    static std::string FormatTime(uint64_t time);
+
+    /// <summary>
+    /// метод получения текущего времени
+    /// </summary>
+    /// <returns> время, мкс от начала эпохи </returns>
+    static uint64_t Now();
+protected:
+    /// <summary>
+    /// Класс отображения файла в память. Файл увеличивается вместе с отображением
+    /// </summary>
+    class mapping_t
+    {
+    public:
+        mapping_t();
+        ~mapping_t();
+
+        /// <summary>
+        /// метод открытия файла и отображения его в память
+        /// </summary>
+        /// <param name="path"> -- путь к файлу </param>
+        /// <param name="minSize"> -- наименьший размер отображения </param>
+        /// <param name="logger"> -- объект для логгирования </param>
+        /// <returns> 1 -- файл отображен </returns>
+        bool Open(const std::string& path, size_t minSize, log_t& logger);
+
+        /// <summary>
+        /// метод увеличения файла и отображения
+        /// </summary>
+        /// <param name="size"> -- требуемый размер </param>
+        /// <param name="logger"> -- объект для логгирования </param>
+        /// <returns> 1 -- отображение не меньше требуемого размера </returns>
+        bool Reserve(size_t size, log_t& logger);
+
+        /// <summary>
+        /// метод закрытия: отображение снимается, файл обрезается до заданного размера
+        /// </summary>
+        /// <param name="size"> -- размер файла после закрытия; SIZE_MAX - не менять </param>
+        void Close(size_t size);
+
+        /// <summary>
+        /// метод снятия отображения
+        /// </summary>
+        void Unmap();
+
+        /// <summary>
+        /// метод отображения файла заданного размера (файл увеличивается до него)
+        /// </summary>
+        /// <param name="size"> -- размер отображения </param>
+        /// <param name="logger"> -- объект для логгирования </param>
+        /// <returns> 1 -- файл отображен </returns>
+        bool Map(size_t size, log_t& logger);
+
+        char* data; // начало отображения
+        size_t size; // размер отображения
+        size_t fileSize; // размер файла при открытии (SIZE_MAX - не известен)
+        std::string path; // путь к файлу
+#ifdef __WIN32__
+        void* file; // описатель файла (HANDLE)
+        void* map; // описатель отображения (HANDLE)
+#else
+        int fd; // дескриптор файла
+#endif
+    };
+
+    /// <summary>
+    /// заголовок файла данных
+    /// </summary>
+    struct dataHeader_t
+    {
+        char magic[8]; // сигнатура dataMagic
+        uint64_t used; // занятый размер файла, включая заголовок
+        uint64_t count; // количество записей
+        uint64_t lastTime; // время последней записи
+    };
+
+    /// <summary>
+    /// заголовок файла индекса
+    /// </summary>
+    struct indexHeader_t
+    {
+        char magic[8]; // сигнатура indexMagic
+        uint64_t count; // количество элементов индекса
+    };
+
+    /// <summary>
+    /// элемент разреженного индекса
+    /// </summary>
+    struct indexEntry_t
+    {
+        uint64_t time; // время записи
+        uint64_t offset; // смещение записи в файле данных
+    };
+
+    static const size_t dataStart = 64; // начало записей в файле данных (заголовок с запасом)
+    static const size_t recordHeaderSize = 14; // время 8 + длина 4 + направление 1 + тип 1
+    static const size_t indexStep = 4096; // байт данных на один элемент индекса
+    static const size_t growStep = 1024 * 1024; // шаг увеличения файлов
+
+    /// <summary>
+    /// метод чтения заголовка записи
+    /// </summary>
+    /// <param name="offset"> -- смещение записи в файле данных </param>
+    /// <param name="record"> -- запись </param>
+    /// <returns> смещение следующей записи </returns>
+    uint64_t ReadRecord(uint64_t offset, record_t& record) const;
+
+    dataHeader_t* DataHeader() const;
+    indexHeader_t* IndexHeader() const;
+    indexEntry_t* Index() const;
+
+    mapping_t data; // файл данных
+    mapping_t index; // файл индекса
+    uint64_t nextIndex; // смещение данных, после которого нужен следующий элемент индекса
+    bool b_open; // флаг открытой истории
+    log_t& logger; // объект логгирования
+};
+
+#endif /* HISTORY_H_ */
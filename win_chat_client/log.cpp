@@ -1,25 +1,25 @@
 #include "log.h"
+#include "alloc.h"
 #include <chrono>
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
 
 /// <summary>
-///   
-///      ,    
+/// Конструктор по умолчанию
+/// Если не задаем имя файла логгирования, выводим тоьько в консоль
 /// </summary>
 log_t::log_t() : consoleActive(true), lastErr(0)
 {
     time_zone = 3; // TO_DO
 }
 /// <summary>
-///   3- 
+/// Конструктор с 3-я параметрами
 /// </summary>
-/// <param name="nameLogFile"> -    </param>
-/// <param name="consoleActive"> -      </param>
+/// <param name="nameLogFile"> - имя файла логгирования </param>
+/// <param name="consoleActive"> - флаг на вывод в консоль </param>
 log_t::log_t(std::string nameLogFile, bool consoleActive) : consoleActive(consoleActive), lastErr(0)
 {
     time_zone = 3; // TO_DO
-    logFile.open(nameLogFile.c_str(), std::ios::app); //     
+    logFile.open(nameLogFile.c_str(), std::ios::app); // открываем файл логиррования для дозаписи
     if (!logFile)
     {
         if (consoleActive) std::cout << "logFile.open fail";
@@ -29,30 +29,36 @@ log_t::log_t(std::string nameLogFile, bool consoleActive) : consoleActive(consol
 
 log_t::~log_t()
 {
-    if (logFile.is_open()) //    - 
+    if (logFile.is_open()) // если файл открыт - закрываем
         logFile.close();
 }
 /// <summary>
-///     
+/// Метод для записи в лог
 /// </summary>
-/// <param name="log"> -   </param>
-/// <param name="errCode"> -   () </param>
-void log_t::doLog(std::string log, int errCode)
+/// <param name="log"> - строка лога </param>
+/// <param name="errCode"> - код ошибки (опционально) </param>
+void log_t::doLog(std::string_view log, int errCode)
 {
-    //    
-    std::string msg = getTime();
+    ALLOC_SCOPE(allocLog);
+    // готовим итоговое сообщение лога на арене такта
+    char time[64];
+    arenaString_t msg(time, formatTime(time, sizeof(time)), tickArena_t::Local().Resource());
     msg.append(" :: "); 
     msg.append(log);
-    //    ,  
-    if (errCode != 0x80000000)
+    // если есть код ошибки, добавляем его
+    bool b_code = errCode != static_cast<int>(0x80000000); // 0x80000000 - код не задан
+    if (b_code)
     {
-        lastErr = errCode; //   
         msg.append(" errno: ");
-        msg.append(std::to_string(errCode));
+        char code[16];
+        msg.append(code, std::snprintf(code, sizeof(code), "%d", errCode));
     }
-    //   
+    std::lock_guard<std::mutex> lock(mutex); // строки из разных потоков не перемешиваются
+    if (b_code)
+        lastErr = errCode; // запоминаем значение ошибки
+    // вывод в консоль
     if (consoleActive) std::cout << msg << '\n';
-    //   
+    // вывод в файл
     if (logFile.is_open())
     {
         logFile << msg << '\n';
@@ -61,52 +67,64 @@ void log_t::doLog(std::string log, int errCode)
 }
 #ifdef DEBUG
 /// <summary>
-///         
+/// Метод для записи в лог трейса в режиме отладки
 /// </summary>
-/// <param name="log"> -   </param>
+/// <param name="log"> - строка лога </param>
 void log_t::doDebugTrace(std::string trace)
 {
-    //    
-    std::string msg = getTime();
+    // готовим итоговое сообщение трейса
+    char time[64];
+    arenaString_t msg(time, formatTime(time, sizeof(time)), tickArena_t::Local().Resource());
     msg.append(" :: ");
     msg.append(trace);
-    //   
+    // вывод в консоль
     if (consoleActive) std::cout << trace << '\n';
-    //   
+    // вывод в файл
     if (logFile.is_open()) logFile << trace << '\n';
 }
 #endif
 /// <summary>
-///     ,    doLog()
+/// Метод возврата кода последней ошибки, переданой через метод doLog()
 /// </summary>
-/// <returns>   ,    doLog() </returns>
+/// <returns> код последней ошибки, переданой через метод doLog() </returns>
 int log_t::GetLastErr() const
 {
+    std::lock_guard<std::mutex> lock(mutex);
     return lastErr;
 }
 /// <summary>
-///   
+/// метод вывода времени
 /// </summary>
-/// <returns>   "..->::"</returns>
+/// <returns> строка формата "гггг.мм.дд->чч:мм:сс"</returns>
 std::string log_t::getTime()
 {
-    // ++17 
-    std::stringstream result; // 
+    char result[64]; // результат
+    return std::string(result, formatTime(result, sizeof(result)));
+}
 
-    bool leap = false; //   
+/// <summary>
+/// метод форматирования времени в буфер без выделения памяти
+/// </summary>
+/// <param name="buf"> - буфер для строки времени </param>
+/// <param name="size"> - размер буфера </param>
+/// <returns> длина строки формата "гггг.мм.дд-день недели-чч:мм:сс.мсмс" </returns>
+size_t log_t::formatTime(char* buf, size_t size)
+{
+    // С++17 вариант
+    bool leap = false; // флаг весокосного года
 
-    auto now = std::chrono::system_clock::now().time_since_epoch();// 1970 
-    auto msec = std::chrono::duration_cast<std::chrono::milliseconds> (now); // 
-    auto sec = std::chrono::duration_cast<std::chrono::seconds> (now); // 
-    auto min = std::chrono::duration_cast<std::chrono::minutes> (now); // 
-    auto tempHour = std::chrono::duration_cast<std::chrono::hours> (now); // 
-    //  ++17   ,   (   ++20) 
-    int hour = tempHour.count() + time_zone; // +3    
+    auto now = std::chrono::system_clock::now().time_since_epoch();// 1970 четверг
+    auto msec = std::chrono::duration_cast<std::chrono::milliseconds> (now); // миллисекунды
+    auto sec = std::chrono::duration_cast<std::chrono::seconds> (now); // секунды
+    auto min = std::chrono::duration_cast<std::chrono::minutes> (now); // минуты
+    auto tempHour = std::chrono::duration_cast<std::chrono::hours> (now); // часы
+    // больше С++17 нам не дает, дальше решаем сами(не актуально в С++20) 
+    int hour = tempHour.count() + time_zone; // +3 московский часовой пояс 
 
-    int totalDay = hour / 24; //   
-    std::string weekDays; //  
+    int totalDay = hour / 24; // общее количество дней
+    const char* weekDays = ""; // день недели
 
-    switch ((totalDay + 3) % 7) //    1970 
+    switch ((totalDay + 3) % 7) // начинаем с четверга 1970 года
     {
     case 0:
         weekDays = "monday";
@@ -133,18 +151,18 @@ std::string log_t::getTime()
         break;
     }
 
-    int year = 1969; //   
-    int day = 0; // 
+    int year = 1969; // общее количество лет
+    int day = 0; // дни
 
-    while (totalDay > 0) //      
+    while (totalDay > 0) // пока общее количество дней еще есть
     {
-        ++year; //  
-        leap = year % 4 == 0; //   ?
-        day = totalDay; //   
-        totalDay -= leap ? 366 : 365; //       
+        ++year; // плюс год
+        leap = year % 4 == 0; // год был весокосный?
+        day = totalDay; // предварительно устанавливаем дату
+        totalDay -= leap ? 366 : 365; // вычитаем год дней из общего количества 
     }
 
-    int mounth = 0; //           
+    int mounth = 0; // месяц устанавливаем в  зависимости от количества дней в этом году
     if (day < 31) mounth = 1;
     else if (leap ? day < 59 : day < 60) { mounth = 2; day -= 31; }
     else if (leap ? day < 90 : day < 91) { mounth = 3; day -= leap ? 59 : 60; }
@@ -157,18 +175,18 @@ std::string log_t::getTime()
     else if (leap ? day < 304 : day < 305) { mounth = 10; day -= leap ? 273 : 274; }
     else if (leap ? day < 334 : day < 335) { mounth = 11; day -= leap ? 304 : 305; }
     else if (leap ? day < 365 : day < 366) { mounth = 12; day -= leap ? 334 : 335; }
-    //    "..- -:::"
-    result << std::setfill('0') << year << '.' << std::setw(2) << mounth << '.' << std::setw(2) << day << '-' << weekDays << '-' //
-        << std::setw(2) << hour % 24 << ':' << std::setw(2) << min.count() % 60 << ':' << std::setw(2) << sec.count() % 60 //
-        << '.' << std::setw(3) << msec.count() % 1000;//
+    // готовим результат формата "гггг.мм.дд-день недели-чч:мм:сс:мсмс"
+    int length = std::snprintf(buf, size, "%04d.%02d.%02d-%s-%02d:%02d:%02d.%03d", year, mounth, day, weekDays, //дата
+        hour % 24, static_cast<int>(min.count() % 60), static_cast<int>(sec.count() % 60), //время
+        static_cast<int>(msec.count() % 1000)); //милисекунды
 
-     return std::string(result.str());
+    return length < 0 ? 0 : (static_cast<size_t>(length) < size ? length : size - 1);
 
-    // ++03 -  (,  )
-    /*char result[64]; // 
+    // С++03 - вариант (устаревший, не используется)
+    /*char result[64]; // результат
     std::memset(&result, 0, sizeof(result));
-    time_t t1 = time(NULL);//     time_t   ,   00:00 1  1970.
-    tm t = *localtime(&t1);// localtime()   time_t   tm,    ,   , , ,   . .
+    time_t t1 = time(NULL);//возвращающая текущее время в формате time_t — количество секунд, прошедших с 00:00 1 января 1970.
+    tm t = *localtime(&t1);//Функция localtime() позволяет перевести time_t в структуру tm, которая состоит из полей, представляющих отдельно часы, минуты, месяц, год и т. д.
     std::sprintf(result ,"%.4d.%.2d.%.2d.->%.2d:%.2d:%.2d", t.tm_year + 1900, t.tm_mon, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
     return std::string(result);*/
 }
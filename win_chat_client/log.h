@@ -5,6 +5,10 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <mutex>
+
+#include "arena.h"
 
 #ifdef DEBUG
 #define DEBUG_TRACE(logger, string) logger.doDebugTrace(string)
@@ -13,7 +17,7 @@
 #endif
 
 /// <summary>
-///       / 
+/// Класс для логгирования событий через файл и/или консоль
 /// </summary>
 class log_t
 {
@@ -21,17 +25,19 @@ public:
     log_t();
     log_t(std::string nameLogFile, bool consoleActive);
     std::string getTime();
-    void doLog(std::string log, int errCode = 0x80000000);
+    size_t formatTime(char* buf, size_t size);
+    void doLog(std::string_view log, int errCode = 0x80000000);
 #ifdef DEBUG
     void doDebugTrace(std::string trace);
 #endif
     int GetLastErr() const;
     virtual ~log_t();
 protected:
-    std::ofstream logFile; //   
-    bool consoleActive; //    
-    int time_zone; //  
-    int lastErr; //   
+    std::ofstream logFile; // файл для логгирования
+    bool consoleActive; // флаг вывода в консоль
+    int time_zone; // часовой пояс
+    int lastErr; // код последней ошибки
+    mutable std::mutex mutex; // вывод из потока ввода-вывода и потока интерфейса
 };
 
 #endif // !LOG_T
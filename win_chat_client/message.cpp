@@ -0,0 +1,77 @@
+﻿#include "message.h"
+
+/// <summary>
+/// метод получения пула текущего потока
+/// </summary>
+/// <returns> ссылка на пул текущего потока </returns>
+msgPool_t& msgPool_t::Local()
+{
+    static thread_local msgPool_t pool;
+    return pool;
+}
+
+/// <summary>
+/// метод получения пустого буфера
+/// </summary>
+/// <param name="capacity"> -- требуемая емкость буфера </param>
+/// <returns> пустой буфер с емкостью не меньше заданной </returns>
+std::string msgPool_t::Acquire(size_t capacity)
+{
+    std::string result;
+
+    if (!v_free.empty())
+    {   // берем последний возвращенный буфер, его память скорее всего еще в кэше
+        result.swap(v_free.back());
+        v_free.pop_back();
+        result.clear();
+    }
+    // выделение памяти только если пул пуст или сообщение крупнее обычного
+    result.reserve(capacity < minCapacity ? minCapacity : capacity);
+
+    return result;
+}
+
+/// <summary>
+/// метод возврата буфера в пул
+/// </summary>
+/// <param name="buffer"> -- возвращаемый буфер </param>
+void msgPool_t::Release(std::string&& buffer)
+{   // пустые (перемещенные) буферы и излишки не храним
+    if (buffer.capacity() >= minCapacity && v_free.size() < maxFree)
+    {
+        if (v_free.capacity() == 0)
+            v_free.reserve(maxFree); // один раз, чтобы возврат не выделял память
+        v_free.push_back(std::move(buffer));
+    }
+}
+
+/// <summary>
+/// метод передачи излишка свободных буферов пулу другого потока
+/// </summary>
+/// <param name="channel"> -- очередь к другому потоку (пишет только этот поток) </param>
+/// <param name="keep"> -- сколько свободных буферов оставить себе </param>
+void msgPool_t::Give(spscQueue_t<std::string>& channel, size_t keep)
+{   // очередь полна - другой поток еще не разобрал прошлое, остаток ждет следующего раза
+    while (v_free.size() > keep && channel.Push(std::move(v_free.back())))
+        v_free.pop_back();
+}
+
+/// <summary>
+/// метод приема буферов, переданных другим потоком
+/// </summary>
+/// <param name="channel"> -- очередь от другого потока (читает только этот поток) </param>
+void msgPool_t::Take(spscQueue_t<std::string>& channel)
+{
+    std::string buffer;
+    while (v_free.size() < maxFree && channel.Pop(buffer))
+        Release(std::move(buffer));
+}
+
+/// <summary>
+/// метод возврата количества свободных буферов в пуле
+/// </summary>
+/// <returns> количество свободных буферов </returns>
+size_t msgPool_t::Size() const
+{
+    return v_free.size();
+}
@@ -0,0 +1,483 @@
+﻿#pragma once
+#ifndef MESSAGE_H_
+#define MESSAGE_H_
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "queue.h"
+
+/// <summary>
+/// тип сообщений
+/// </summary>
+enum TypeMsg
+{
+    defaul, // неопознанное
+    normal, // нормальное, с полезной нагрузкой
+    // сервисные:
+    Exit, // отключение клиента
+    shutDown, // отключение сервера
+    linkOn, // собеседники на связи
+    printinfo, // вывод информации по соединению
+    // передача файла:
+    fileBegin, // начало файла: размер и имя
+    fileData, // часть файла, кадр с длиной
+    fileEnd, // конец файла
+    sendFile, // локальная команда отправки файла (в сеть не уходит)
+    history, // локальная команда выборки истории (в сеть не уходит)
+    find, // локальная команда поиска по истории (в сеть не уходит)
+    acceptFile, // локальная команда разрешения приема следующего файла (в сеть не уходит)
+    systemMsg, // локальное системное сообщение клиента для вывода (в сеть не уходит)
+    heartbeat, // проверка связи, уходит, когда клиенту долго нечего отправить
+    part // часть длинного сообщения, последняя часть уходит обычным сообщением
+};
+
+/// <summary>
+/// класс пула буферов сообщений. Буферы возвращаются в пул вместе с выделенной памятью
+/// и выдаются повторно, поэтому в установившемся режиме сообщения не выделяют память.
+/// У каждого потока свой пул, синхронизация не нужна. Сообщение, созданное одним потоком и удаленное другим,
+/// возвращает буфер в пул удалившего, поэтому потоки, обменивающиеся сообщениями, отдают друг другу
+/// излишки через очереди SPSC (Give()/Take())
+/// </summary>
+class msgPool_t
+{
+public:
+    /// <summary>
+    /// метод получения пула текущего потока
+    /// </summary>
+    /// <returns> ссылка на пул текущего потока </returns>
+    static msgPool_t& Local();
+
+    /// <summary>
+    /// метод получения пустого буфера
+    /// </summary>
+    /// <param name="capacity"> -- требуемая емкость буфера </param>
+    /// <returns> пустой буфер с емкостью не меньше заданной </returns>
+    std::string Acquire(size_t capacity);
+
+    /// <summary>
+    /// метод возврата буфера в пул
+    /// </summary>
+    /// <param name="buffer"> -- возвращаемый буфер </param>
+    void Release(std::string&& buffer);
+
+    /// <summary>
+    /// метод передачи излишка свободных буферов пулу другого потока
+    /// </summary>
+    /// <param name="channel"> -- очередь к другому потоку (пишет только этот поток) </param>
+    /// <param name="keep"> -- сколько свободных буферов оставить себе </param>
+    void Give(spscQueue_t<std::string>& channel, size_t keep);
+
+    /// <summary>
+    /// метод приема буферов, переданных другим потоком
+    /// </summary>
+    /// <param name="channel"> -- очередь от другого потока (читает только этот поток) </param>
+    void Take(spscQueue_t<std::string>& channel);
+
+    /// <summary>
+    /// метод возврата количества свободных буферов в пуле
+    /// </summary>
+    /// <returns> количество свободных буферов </returns>
+    size_t Size() const;
+protected:
+    static const size_t minCapacity = 256; // минимальная емкость буфера, меньше не выделяем
+    static const size_t maxFree = 64; // сколько свободных буферов храним, лишние освобождаем
+    std::vector<std::string> v_free; // свободные буферы
+};
+
+/// <summary>
+/// класс декоратор над std::string для хранения сообщения, состоящего из
+/// заголовка (тип сообщения)-6 символов + текст + конец сообщения(EOM)-5 символов.
+/// Буфер сообщения берется из пула потока и возвращается в него при удалении сообщения
+/// </summary>
+class msg_t
+{
+public:
+    static const size_t headerSize = 6; // размер заголовка
+    static const size_t eomSize = 5; // размер конца сообщения
+    static const size_t lengthSize = 8; // размер поля длины кадра с длиной (шестнадцатеричное число)
+    static const size_t maxDataSize = 1024 * 1024; // наибольшая длина тела кадра с длиной
+    static const size_t streamSize = headerSize + lengthSize; // размер метки сеанса [STRM]
+
+    /// <summary>
+    /// контсруктор
+    /// </summary>
+    /// <param name="type"> -- тип сообщения</param>
+    /// <param name="text"> -- текст сообщения</param>
+    msg_t(TypeMsg type = TypeMsg::defaul, std::string_view text = std::string_view()) : msg_t(type, std::string_view(), text)
+    {}
+
+    /// <summary>
+    /// контсруктор, текст сообщения собирается из двух частей сразу в буфере сообщения
+    /// </summary>
+    /// <param name="type"> -- тип сообщения</param>
+    /// <param name="prefix"> -- начало текста сообщения</param>
+    /// <param name="text"> -- продолжение текста сообщения</param>
+    msg_t(TypeMsg type, std::string_view prefix, std::string_view text) : offset(0), type(TypeMsg::defaul), b_typed(true)
+    {
+        this->text = msgPool_t::Local().Acquire(headerSize + prefix.size() + text.size() + eomSize); // место под заголовок и конец сразу
+        if (static_cast<size_t>(type) < std::size(tags) && !tags[type].header.empty() && type != fileData) // кадр с длиной собирает DataHeader()
+        {
+            const tag_t& tag = tags[type];
+            this->text.append(tag.header);
+            if (tag.b_payload) // полезная нагрузка лишь здесь
+                this->text.append(prefix).append(text);
+            this->text.append("[EOM]");
+            this->type = type; // тип известен без разбора заголовка
+        }
+    }
+
+    /// <summary>
+    /// конструктор копирования, копия получает свой буфер из пула
+    /// </summary>
+    /// <param name="rvalue"> -- копируемое сообщение </param>
+    msg_t(const msg_t& rvalue) : text(msgPool_t::Local().Acquire(rvalue.text.size())), offset(rvalue.offset), type(rvalue.type), b_typed(rvalue.b_typed)
+    {
+        text.assign(rvalue.text);
+    }
+
+    /// <summary>
+    /// конструктор перемещения
+    /// </summary>
+    /// <param name="rvalue"> -- перемещаемое сообщение </param>
+    msg_t(msg_t&& rvalue) noexcept : text(std::move(rvalue.text)), offset(rvalue.offset), type(rvalue.type), b_typed(rvalue.b_typed)
+    {
+        rvalue.offset = 0;
+        rvalue.b_typed = false; // текст источника после перемещения не определен
+    }
+
+    /// <summary>
+    /// оператор присваивания, буфер сообщения переиспользуется
+    /// </summary>
+    /// <param name="rvalue"> -- копируемое сообщение </param>
+    /// <returns> ссылка на сообщение </returns>
+    msg_t& operator = (const msg_t& rvalue)
+    {
+        text.assign(rvalue.text);
+        offset = rvalue.offset;
+        type = rvalue.type;
+        b_typed = rvalue.b_typed;
+        return *this;
+    }
+
+    /// <summary>
+    /// оператор перемещения, старый буфер возвращается в пул
+    /// </summary>
+    /// <param name="rvalue"> -- перемещаемое сообщение </param>
+    /// <returns> ссылка на сообщение </returns>
+    msg_t& operator = (msg_t&& rvalue) noexcept
+    {
+        text.swap(rvalue.text);
+        std::swap(type, rvalue.type); // тип переходит вместе с текстом
+        std::swap(b_typed, rvalue.b_typed);
+        offset = rvalue.offset;
+        rvalue.offset = 0;
+        return *this;
+    }
+
+    /// <summary>
+    /// деструктор, возвращает буфер в пул
+    /// </summary>
+    ~msg_t()
+    {
+        msgPool_t::Local().Release(std::move(text));
+    }
+
+    /// <summary>
+    /// метод получения не константной ссылки на внутренний std::string с сообщением.
+    /// Тип изменяемого сообщения разбирается заново при следующем Type()
+    /// </summary>
+    /// <returns> не константная ссылка на внутренний std::string с сообщением </returns>
+    std::string& Update()
+    {
+        offset = 0;
+        b_typed = false;
+        return text;
+    }
+
+    /// <summary>
+    /// метод получения константной ссылки на внутренний std::string с сообщением
+    /// </summary>
+    /// <returns> константная ссылка на внутренний std::string с сообщением </returns>
+    const std::string& Str() const
+    {
+        return text;
+    }
+
+    /// <summary>
+    /// метод получения типа сообщения: заголовок разбирается один раз на кадр, дальше тип берется из сообщения
+    /// </summary>
+    /// <returns> типа сообщения </returns>
+    TypeMsg Type() const
+    {
+        if (!b_typed)
+        {
+            type = Decode(text);
+            b_typed = true;
+        }
+        return type;
+    }
+
+    /// <summary>
+    /// метод кода заголовка: четыре буквы между скобками в одном целом, поэтому заголовок сравнивается
+    /// одним сравнением целых, а коды известных заголовков вычисляются при компиляции
+    /// </summary>
+    /// <param name="header"> -- заголовок либо начало кадра </param>
+    /// <returns> код заголовка; 0 - нет заголовка в скобках </returns>
+    static constexpr uint32_t TagCode(std::string_view header)
+    {
+        if (header.size() < headerSize || header[0] != '[' || header[headerSize - 1] != ']')
+            return 0;
+        return static_cast<uint32_t>(static_cast<unsigned char>(header[1])) | static_cast<uint32_t>(static_cast<unsigned char>(header[2])) << 8 |
+            static_cast<uint32_t>(static_cast<unsigned char>(header[3])) << 16 | static_cast<uint32_t>(static_cast<unsigned char>(header[4])) << 24;
+    }
+
+    /// <summary>
+    /// метод разбора типа по заголовку кадра
+    /// </summary>
+    /// <param name="frame"> -- кадр либо его начало </param>
+    /// <returns> тип сообщения; defaul - заголовок не опознан </returns>
+    static TypeMsg Decode(std::string_view frame)
+    {
+        switch (TagCode(frame))
+        {
+        case TagCode(tags[normal].header): return normal;
+        case TagCode(tags[Exit].header): return Exit;
+        case TagCode(tags[shutDown].header): return shutDown;
+        case TagCode(tags[linkOn].header): return linkOn;
+        case TagCode(tags[printinfo].header): return printinfo;
+        case TagCode(tags[fileBegin].header): return fileBegin;
+        case TagCode(tags[fileData].header): return fileData;
+        case TagCode(tags[fileEnd].header): return fileEnd;
+        case TagCode(tags[sendFile].header): return sendFile;
+        case TagCode(tags[history].header): return history;
+        case TagCode(tags[find].header): return find;
+        case TagCode(tags[acceptFile].header): return acceptFile;
+        case TagCode(tags[systemMsg].header): return systemMsg;
+        case TagCode(tags[heartbeat].header): return heartbeat;
+        case TagCode(tags[part].header): return part;
+        default: return defaul;
+        }
+    }
+
+    /// <summary>
+    /// метод построения заголовка кадра с длиной: [FILD] + длина тела (8 шестнадцатеричных цифр).
+    /// За заголовком идет тело заданной длины и конец сообщения
+    /// </summary>
+    /// <param name="size"> -- длина тела кадра </param>
+    /// <returns> заголовок кадра </returns>
+    static std::string DataHeader(size_t size)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string result("[FILD]");
+        for (int shift = (lengthSize - 1) * 4; shift >= 0; shift -= 4)
+            result.push_back(digits[(size >> shift) & 0xF]);
+        return result;
+    }
+
+    /// <summary>
+    /// метод дописывания метки сеанса: [STRM] + номер сеанса (8 шестнадцатеричных цифр).
+    /// За меткой идет обычный кадр сеанса вместе со своим концом сообщения
+    /// </summary>
+    /// <param name="out"> -- строка, в конец которой пишется метка </param>
+    /// <param name="id"> -- номер сеанса </param>
+    static void StreamHeader(std::string& out, unsigned id)
+    {
+        static const char digits[] = "0123456789abcdef";
+        out.append("[STRM]");
+        for (int shift = (lengthSize - 1) * 4; shift >= 0; shift -= 4)
+            out.push_back(digits[(id >> shift) & 0xF]);
+    }
+
+    /// <summary>
+    /// метод разбора метки сеанса в начале кадра
+    /// </summary>
+    /// <param name="frame"> -- кадр либо его начало </param>
+    /// <param name="id"> -- номер сеанса </param>
+    /// <returns> 1 - кадр помечен сеансом, вложенный кадр начинается через streamSize байт </returns>
+    static bool StreamId(std::string_view frame, unsigned& id)
+    {
+        if (frame.size() < streamSize || TagCode(frame) != TagCode("[STRM]"))
+            return false;
+
+        unsigned result = 0;
+        for (size_t indx = headerSize; indx < streamSize; ++indx)
+        {
+            char c = frame[indx];
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0)
+                return false;
+            result = result * 16 + digit;
+        }
+        id = result;
+        return true;
+    }
+
+    /// <summary>
+    /// метод определения длины кадра по его началу (TCP_socketClient_t::frameLength_t).
+    /// Длину имеют только кадры [FILD] (в том числе под меткой сеанса), остальные ограничиваются концом сообщения
+    /// </summary>
+    /// <param name="data"> -- начало кадра </param>
+    /// <param name="size"> -- количество принятых байт кадра </param>
+    /// <returns> полная длина кадра; 0 - кадр без длины либо заголовок еще не принят </returns>
+    static size_t FrameLength(const char* data, size_t size)
+    {
+        unsigned id = 0;
+        if (StreamId(std::string_view(data, size), id))
+        {   // кадр сеанса: длину определяет вложенный кадр
+            size_t inner = FrameLength(data + streamSize, size - streamSize);
+            return inner != 0 ? streamSize + inner : 0;
+        }
+        if (size < headerSize + lengthSize || TagCode(std::string_view(data, size)) != TagCode(tags[fileData].header))
+            return 0;
+
+        size_t length = 0;
+        for (size_t indx = headerSize; indx < headerSize + lengthSize; ++indx)
+        {
+            char c = data[indx];
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0)
+                return 0; // испорченный заголовок разбираем как обычный кадр
+            length = length * 16 + digit;
+        }
+        return length <= maxDataSize ? headerSize + lengthSize + length + eomSize : 0;
+    }
+
+    /// <summary>
+    /// метод получения тела кадра с длиной без копирования
+    /// </summary>
+    /// <returns> тело кадра, пусто - если сообщение не кадр с длиной </returns>
+    std::string_view Data() const
+    {
+        std::string_view result;
+        size_t length = FrameLength(text.data(), text.size());
+        if (length != 0 && text.size() == length)
+            result = std::string_view(text.data() + headerSize + lengthSize, length - headerSize - lengthSize - eomSize);
+        return result;
+    }
+
+    /// <summary>
+    /// метод получения конца сообщения
+    /// </summary>
+    /// <returns> конец сообщения </returns>
+    static const std::string& EOM()
+    {
+        static const std::string eom("[EOM]");
+        return eom;
+    }
+
+    /// <summary>
+    /// метод получения полезной нагрузки сообщения без копирования
+    /// </summary>
+    /// <returns> текст сообщения без заголовка и конца сообщения, пусто - если сообщение без текста </returns>
+    std::string_view Payload() const
+    {
+        std::string_view result;
+        if (tags[Type()].b_payload && text.size() >= headerSize + eomSize)
+            result = std::string_view(text.data() + headerSize, text.size() - headerSize - eomSize);
+        return result;
+    }
+
+    /// <summary>
+    /// метод получения текста сообщения для вывода без заголовка и конца сообщения
+    /// </summary>
+    /// <returns> текст сообщения либо расшифровка сервисного сообщения </returns>
+    std::string_view Print() const
+    {
+        std::string_view result;
+        switch (Type())
+        { // расшифровка сервесных сообщений
+        case TypeMsg::shutDown:
+            result = "SYSTEM MSG: server get command shutdown";
+            break;
+        case TypeMsg::Exit:
+            result = "SYSTEM MSG: server get command exit from visavi client";
+            break;
+        case TypeMsg::printinfo:
+            result = "SYSTEM MSG: other visavi not connected";
+            break;
+        case TypeMsg::linkOn:
+            result = "SYSTEM MSG: server get connected from other visavi";
+            break;
+        case TypeMsg::defaul:
+            result = "SYSTEM MSG: server recived defined message";
+            break;
+        case TypeMsg::normal:
+        case TypeMsg::systemMsg:
+            result = Payload(); // выдаем текст без заголовка и конца сообщения
+            break;
+        case TypeMsg::fileBegin:
+            result = "SYSTEM MSG: visavi sends a file";
+            break;
+        case TypeMsg::fileEnd:
+            result = "SYSTEM MSG: file from visavi received";
+            break;
+        default:
+            break;
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// метод задания смещения
+    /// </summary>
+    /// <param name="offset"> -- смещение </param>
+    void SetOffset(unsigned offset)
+    {
+        if (offset < text.size())
+            this->offset = offset;
+    }
+
+    /// <summary>
+    /// метод возврата смещения
+    /// </summary>
+    /// <returns> -- смещение </returns>
+    unsigned GetOffset() const
+    {
+        return offset;
+    }
+
+protected:
+    /// <summary>
+    /// описание типа сообщения
+    /// </summary>
+    struct tag_t
+    {
+        std::string_view header; // заголовок
+        bool b_payload; // сообщение несет текст между заголовком и концом сообщения
+    };
+
+    /// <summary>
+    /// заголовки по типам сообщений (индекс - TypeMsg)
+    /// </summary>
+    static constexpr tag_t tags[] = {
+        { "", false }, // defaul
+        { "[NORM]", true }, // normal
+        { "[EXIT]", false }, // Exit
+        { "[SHUT]", false }, // shutDown
+        { "[LINK]", false }, // linkOn
+        { "[INFO]", false }, // printinfo
+        { "[FILB]", true }, // fileBegin
+        { "[FILD]", false }, // fileData: тело с длиной, не текст
+        { "[FILE]", true }, // fileEnd: текст есть, только если отправитель прервал файл
+        { "[SFIL]", true }, // sendFile
+        { "[HIST]", true }, // history
+        { "[FIND]", true }, // find
+        { "[ACPT]", false }, // acceptFile
+        { "[SYST]", true }, // systemMsg
+        { "[HRBT]", false }, // heartbeat
+        { "[PART]", true } // part
+    };
+    static_assert(std::size(tags) == TypeMsg::part + 1, "each TypeMsg needs its header");
+
+    std::string text; // строка хранящее сообщение, согласно формату, опраделенному выше
+    unsigned offset; // смещение от начала сообщения
+    mutable TypeMsg type; // тип, разобранный по заголовку
+    mutable bool b_typed; // type соответствует тексту
+};
+
+#endif /* MESSAGE_H_ */
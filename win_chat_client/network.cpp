@@ -1,43 +1,48 @@
 #include "network.h"
 
+#include <cstddef> // offsetof для адреса AF_UNIX
+#ifndef __WIN32__
+#include <sys/stat.h> // lstat для файла сокета AF_UNIX
+#endif
+
 #ifdef __WIN32__
-std::unordered_set<unsigned> g_journal; //       
+std::unordered_set<unsigned> g_journal; // журнал для регистрации объектов с сетевым взаимодействием
 #endif
 
 void network::RAII_OSsock::registration()
 {
 #ifdef __WIN32__
-    if (g_journal.empty()) //         = 0
-        if (WSAStartup(MAKEWORD(2, 2), &wsdata))//  
-            logger.doLog("RAII_OSsock - WSAStartup ", GetError());//  
+    if (g_journal.empty()) // если интерфейс еще не открывали и количество пользователей = 0
+        if (WSAStartup(MAKEWORD(2, 2), &wsdata))// открыть интерфейс
+            logger.doLog("RAII_OSsock - WSAStartup ", GetError());// логгируем ошибку
 
-    objectID = ++countWSAusers; //   ID
-    g_journal.insert(objectID); //  
+    objectID = ++countWSAusers; // создаем уникальный ID
+    g_journal.insert(objectID); // регистрируемся 
 #endif
 }
 
 /// <summary>
-/// 
+/// Конструктор
 /// </summary>
-/// <param name="logger"> --      </param>
+/// <param name="logger"> -- ссылка на объект для логгирования </param>
 network::RAII_OSsock::RAII_OSsock(log_t& logger) : logger(logger)
 {
     registration();
 }
 
 /// <summary>
-///  
+/// конструктор копирования
 /// </summary>
-/// <param name="rvalue"> --  </param>
+/// <param name="rvalue"> -- копируемый объект</param>
 network::RAII_OSsock::RAII_OSsock(const RAII_OSsock& rvalue) : logger(rvalue.logger)
 {
     registration();
 }
 
 /// <summary>
-///  
+/// конструктор перемещения
 /// </summary>
-/// <param name="rvalue"> --  </param>
+/// <param name="rvalue"> -- перемещаемый объект</param>
 /// <returns></returns>
 network::RAII_OSsock::RAII_OSsock(RAII_OSsock&& rvalue) noexcept : logger(rvalue.logger)
 {
@@ -45,22 +50,22 @@ network::RAII_OSsock::RAII_OSsock(RAII_OSsock&& rvalue) noexcept : logger(rvalue
 }
 
 /// <summary>
-/// 
+/// деструктор
 /// </summary>
 network::RAII_OSsock::~RAII_OSsock()
 {
 #ifdef __WIN32__
-    g_journal.erase(objectID); //   ,       (Move )
+    g_journal.erase(objectID); // удаляем свою запись, если уже не сделали этого раньше (Move семантика)
 
-    if (g_journal.empty()) //      
-        WSACleanup(); //  
+    if (g_journal.empty()) // как только работу закончил последний юзер
+        WSACleanup(); // закрыть интерфейс
 #endif
 }
 
 /// <summary>
-///     
+/// Метод вывода номера последней ошибки
 /// </summary>
-/// <returns>    </returns>
+/// <returns> номер последней ошибки </returns>
 int network::RAII_OSsock::GetError()
 {
 #ifdef __WIN32__
@@ -71,40 +76,119 @@ int network::RAII_OSsock::GetError()
 }
 
 /// <summary>
-///     
+/// Метод установки опций для сокета
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <param name="option"> - </param>
-/// <param name="logger"> -    </param>
-/// <returns> 1 -  </returns>
-bool network::RAII_OSsock::setSocketOpt(SOCKET sock, int option, log_t& logger)
+/// <param name="socket"> - дескриптор сокета </param>
+/// <param name="option"> - опция</param>
+/// <param name="logger"> - объект для логгированя </param>
+/// <param name="value"> - значение опции (для опций-флагов 1 - включить, 0 - выключить) </param>
+/// <returns> 1 - успех, 0 - ошибка либо опция не поддерживается ОС </returns>
+bool network::RAII_OSsock::setSocketOpt(SOCKET sock, int option, log_t& logger, int value)
 {
     bool result = false;
+    int level = -1; // уровень и имя опции для setsockopt
+    int name = -1;
 
     switch (option)
     {
-    case option_t::NON_BLOCK: //     
+    case option_t::NON_BLOCK: // опция по устаеновке неблокирующего сокета
     {
 #ifdef __WIN32__
-        u_long mode = 0;
+        u_long mode = value ? 1 : 0; // ненулевое значение включает неблокирующий режим
         if (ioctlsocket(sock, FIONBIO, &mode))
-            logger.doLog("RAII_OSsock - ioctlsocket ", GetError());//  
+            logger.doLog("RAII_OSsock - ioctlsocket ", GetError());// логгируем ошибку
         else
             result = true;
 #else
-        if (fcntl(sock, F_SETFL, O_NONBLOCK))
-            logger.doLog("RAII_OSsock - ioctl ", GetError());//  
+        int flags = fcntl(sock, F_GETFL, 0); // остальные флаги дескриптора сохраняем
+        if (flags == -1 || fcntl(sock, F_SETFL, value ? flags | O_NONBLOCK : flags & ~O_NONBLOCK))
+            logger.doLog("RAII_OSsock - fcntl ", GetError());// логгируем ошибку
         else
             result = true;
 #endif
+        return result;
     }
-    default:
+    case option_t::NO_DELAY:
+        level = IPPROTO_TCP;
+        name = TCP_NODELAY;
+        break;
+    case option_t::SEND_BUFFER:
+        level = SOL_SOCKET;
+        name = SO_SNDBUF;
+        break;
+    case option_t::RECV_BUFFER:
+        level = SOL_SOCKET;
+        name = SO_RCVBUF;
+        break;
+    case option_t::KEEP_ALIVE:
+        level = SOL_SOCKET;
+        name = SO_KEEPALIVE;
+        break;
+#ifdef __WIN32__
+#ifdef TCP_MAXRT
+    case option_t::USER_TIMEOUT: // TCP_MAXRT задается в секундах
+        level = IPPROTO_TCP;
+        name = TCP_MAXRT;
+        value = (value + 999) / 1000;
+        break;
+#endif
+#endif
+#ifndef __WIN32__
+    case option_t::QUICK_ACK:
+        level = IPPROTO_TCP;
+        name = TCP_QUICKACK;
+        break;
+    case option_t::CORK:
+        level = IPPROTO_TCP;
+        name = TCP_CORK;
+        break;
+#ifdef TCP_NOTSENT_LOWAT
+    case option_t::NOTSENT_LOWAT:
+        level = IPPROTO_TCP;
+        name = TCP_NOTSENT_LOWAT;
         break;
+#endif
+#ifdef SO_BUSY_POLL
+    case option_t::BUSY_POLL:
+        level = SOL_SOCKET;
+        name = SO_BUSY_POLL;
+        break;
+#endif
+#ifdef TCP_USER_TIMEOUT
+    case option_t::USER_TIMEOUT:
+        level = IPPROTO_TCP;
+        name = TCP_USER_TIMEOUT;
+        break;
+#endif
+#endif
+    default: // опция не поддерживается этой ОС
+        return result;
     }
 
+    if (setsockopt(sock, level, name, reinterpret_cast<const char*>(&value), sizeof(value)))
+        logger.doLog("RAII_OSsock - setsockopt option " + std::to_string(option) + " ", GetError());// логгируем ошибку
+    else
+        result = true;
+
     return result;
 }
 
+/// <summary>
+/// Метод получения профиля по имени
+/// </summary>
+/// <param name="name"> - имя профиля: "default", "low-latency", "throughput" </param>
+/// <returns> профиль, -1 - имя не распознано </returns>
+int network::profile_t::Parse(const std::string& name)
+{
+    if (name == "default")
+        return NONE;
+    if (name == "low-latency")
+        return LOW_LATENCY;
+    if (name == "throughput")
+        return THROUGHPUT;
+    return -1;
+}
+
 #ifdef __WIN32__
 WSADATA network::RAII_OSsock::wsdata;
 int network::RAII_OSsock::countWSAusers = 0;
@@ -112,45 +196,272 @@ int network::RAII_OSsock::countWSAusers = 0;
 
 
 /// <summary>
-///     .         UpdateSockInfo()
+/// Метод очистки адреса
+/// </summary>
+void network::endpoint_t::Clear()
+{
+    *this = endpoint_t();
+}
+
+/// <summary>
+/// Метод установки адреса из текстового представления
+/// </summary>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" либо IPv6 </param>
+/// <param name="port"> - номер порта </param>
+/// <returns> true - адрес распознан </returns>
+bool network::endpoint_t::Set(const char* ip, unsigned short port)
+{
+    Clear();
+    // Функция InetPton преобразует сетевой адрес IPv4 или IPv6 в стандартной форме
+    //представления текста в числовую двоичную форму
+    sockaddr_in* addrIN = reinterpret_cast<sockaddr_in*>(&addr);
+    sockaddr_in6* addrIN6 = reinterpret_cast<sockaddr_in6*>(&addr);
+    if (inet_pton(AF_INET, ip, &addrIN->sin_addr) == 1)
+    {
+        addrIN->sin_family = AF_INET;
+        addrIN->sin_port = htons(port); // Функция htons возвращает значение в порядке байтов сети TCP/IP
+    }
+    else if (inet_pton(AF_INET6, ip, &addrIN6->sin6_addr) == 1)
+    {
+        addrIN6->sin6_family = AF_INET6;
+        addrIN6->sin6_port = htons(port);
+    }
+    else
+        return false;
+
+    Fit();
+    return true;
+}
+
+/// <summary>
+/// Метод установки адреса локального сокета AF_UNIX
+/// </summary>
+/// <param name="path"> - путь к файлу сокета </param>
+/// <returns> true - путь помещается в адрес </returns>
+bool network::endpoint_t::SetPath(const char* path)
+{
+    Clear();
+    sockaddr_un* addrUN = reinterpret_cast<sockaddr_un*>(&addr);
+    size_t length = strlen(path);
+    if (length == 0 || length >= sizeof(addrUN->sun_path)) // нужен завершающий ноль
+        return false;
+
+    addrUN->sun_family = AF_UNIX;
+    memcpy(addrUN->sun_path, path, length);
+    Fit();
+    return true;
+}
+
+/// <summary>
+/// Метод установки адреса из системной структуры
 /// </summary>
-/// <returns>      </returns>
+/// <param name="addr"> - структура описывающая сокет </param>
+/// <param name="size"> - размер структуры </param>
+/// <returns> true - адрес установлен </returns>
+bool network::endpoint_t::Set(const sockaddr* addr, socklen_t size)
+{
+    Clear();
+    if (!addr || size <= 0 || size > Capacity())
+        return false;
+
+    memcpy(&this->addr, addr, size);
+    Fit();
+    return true;
+}
+
+/// <summary>
+/// Метод обновления после записи адреса системным вызовом через Addr() (accept, recvfrom, getsockname):
+/// размер выставляется по семейству адресов, кэш текста сбрасывается
+/// </summary>
+void network::endpoint_t::Fit()
+{
+    switch (addr.ss_family)
+    {
+    case AF_INET:
+        size = sizeof(sockaddr_in);
+        break;
+    case AF_INET6:
+        size = sizeof(sockaddr_in6);
+        break;
+    case AF_UNIX: // путь с завершающим нулем; неименованный сокет - пустой путь
+    {
+        const sockaddr_un* addrUN = reinterpret_cast<const sockaddr_un*>(&addr);
+        size_t length = strnlen(addrUN->sun_path, sizeof(addrUN->sun_path) - 1);
+        size = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + length + 1);
+        break;
+    }
+    default:
+        size = 0;
+        break;
+    }
+    b_text = false;
+}
+
+/// <summary>
+/// Метод возврата указателя на системную структуру адреса
+/// </summary>
+/// <returns> указатель на структуру описывающую сокет </returns>
+sockaddr* network::endpoint_t::Addr()
+{
+    return reinterpret_cast<sockaddr*>(&addr);
+}
+
+/// <summary>
+/// Метод возврата константного указателя на системную структуру адреса
+/// </summary>
+/// <returns> константный указатель на структуру описывающую сокет </returns>
+const sockaddr* network::endpoint_t::Addr() const
+{
+    return reinterpret_cast<const sockaddr*>(&addr);
+}
+
+/// <summary>
+/// Метод возврата размера используемой части структуры адреса
+/// </summary>
+/// <returns> размер адреса </returns>
+socklen_t network::endpoint_t::Size() const
+{
+    return size;
+}
+
+/// <summary>
+/// Метод возврата размера буфера адреса, передается системным вызовам, заполняющим адрес
+/// </summary>
+/// <returns> размер sockaddr_storage </returns>
+socklen_t network::endpoint_t::Capacity()
+{
+    return sizeof(sockaddr_storage);
+}
+
+/// <summary>
+/// Метод возврата семейства адресов
+/// </summary>
+/// <returns> AF_INET, AF_INET6, AF_UNIX либо AF_UNSPEC для пустого адреса </returns>
+int network::endpoint_t::Family() const
+{
+    return size ? addr.ss_family : AF_UNSPEC;
+}
+
+/// <summary>
+/// Метод возврата номера порта
+/// </summary>
+/// <returns> номер порта </returns>
+unsigned short network::endpoint_t::Port() const
+{
+    unsigned short result = 0;
+    if (Family() == AF_INET)
+        result = ntohs(reinterpret_cast<const sockaddr_in*>(&addr)->sin_port);
+    else if (Family() == AF_INET6)
+        result = ntohs(reinterpret_cast<const sockaddr_in6*>(&addr)->sin6_port);
+    return result;
+}
+
+/// <summary>
+/// Метод возврата текстового представления адреса (без порта)
+/// </summary>
+/// <returns> IP адресс, пустая строка - адрес не задан </returns>
+const char* network::endpoint_t::Text() const
+{
+    if (!b_text)
+    {   // формируем текст один раз, до следующего изменения адреса
+        text[0] = '\0';
+        if (Family() == AF_INET)
+            inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(&addr)->sin_addr, text, sizeof(text));
+        else if (Family() == AF_INET6)
+            inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(&addr)->sin6_addr, text, sizeof(text));
+        else if (Family() == AF_UNIX) // путь длиннее буфера текста не копируем, он уже строка с нулем
+            return reinterpret_cast<const sockaddr_un*>(&addr)->sun_path;
+        b_text = true;
+    }
+    return text;
+}
+
+/// <summary>
+/// оператор сравнения по значению: семейство, адрес и порт
+/// </summary>
+/// <param name="rValue"> - правостороннее значение </param>
+/// <returns> 1 - адреса равны </returns>
+bool network::endpoint_t::operator == (const endpoint_t& rValue) const
+{
+    if (Family() != rValue.Family())
+        return false;
+
+    bool result = false;
+    switch (Family())
+    {
+    case AF_INET:
+    {
+        const sockaddr_in* left = reinterpret_cast<const sockaddr_in*>(&addr);
+        const sockaddr_in* right = reinterpret_cast<const sockaddr_in*>(&rValue.addr);
+        result = left->sin_port == right->sin_port && left->sin_addr.s_addr == right->sin_addr.s_addr;
+        break;
+    }
+    case AF_INET6:
+    {
+        const sockaddr_in6* left = reinterpret_cast<const sockaddr_in6*>(&addr);
+        const sockaddr_in6* right = reinterpret_cast<const sockaddr_in6*>(&rValue.addr);
+        result = left->sin6_port == right->sin6_port && left->sin6_scope_id == right->sin6_scope_id
+            && !memcmp(&left->sin6_addr, &right->sin6_addr, sizeof(left->sin6_addr));
+        break;
+    }
+    case AF_UNIX:
+    {
+        const sockaddr_un* left = reinterpret_cast<const sockaddr_un*>(&addr);
+        const sockaddr_un* right = reinterpret_cast<const sockaddr_un*>(&rValue.addr);
+        result = !strncmp(left->sun_path, right->sun_path, sizeof(left->sun_path));
+        break;
+    }
+    default: // пустые адреса равны
+        result = true;
+        break;
+    }
+    return result;
+}
+
+/// <summary>
+/// оператор сравнения
+/// </summary>
+/// <param name="rValue"> - правостороннее значение </param>
+/// <returns> 1 - адреса не равны </returns>
+bool network::endpoint_t::operator != (const endpoint_t& rValue) const
+{
+    return !(*this == rValue);
+}
+
+/// <summary>
+/// Метод перезаписи структуры описывающей сокет. После перезаписи необходимо обновить информцию о сокете вызвав UpdateSockInfo()
+/// </summary>
+/// <returns> указатель на структуру описывающую сокет </returns>
 sockaddr* network::sockInfo_t::setSockAddr()
 {
-    return &Addr;
+    endpoint.Clear(); // путь AF_UNIX система пишет без нулей в конце, остаток прежнего адреса не должен к нему прилипнуть
+    return endpoint.Addr();
 }
 
 /// <summary>
-///     ,    Addr  setSockAddr()
+/// Метод обновления иноформации о сокете, вызывается после обновления Addr метоом setSockAddr()
 /// </summary>
 void network::sockInfo_t::UpdateSockInfo()
 {
-    //      
+    endpoint.Fit(); // системный вызов мог записать адрес любого семейства
+    // чистим старую информацию о привязке сокета
     IP_port.first.clear();
     IP_port.second = 0;
 
-    sockaddr_in AddrIN; //        IP
-    memset(&AddrIN, 0, SizeAddr());
-    memmove(&AddrIN, &Addr, SizeAddr()); //Addr ==>> AddrIN
-
-    char bufIP[32];//    IP
-    memset(bufIP, '\0', sizeof(bufIP));
-
-    //  InetNtop  - IPv4  IPv6      
-    if (inet_ntop(AF_INET, &AddrIN, bufIP, sizeof(bufIP)))
+    if (*endpoint.Text())
     {
-        IP_port.first.assign(bufIP);
-        IP_port.second = ntohs(AddrIN.sin_port);
+        IP_port.first.assign(endpoint.Text());
+        IP_port.second = endpoint.Port();
     }
-    else //  
+    else if (endpoint.Family() != AF_UNIX) // логгируем ошибку; у неименованного локального сокета адреса нет, это не ошибка
         logger.doLog("inet_ntop fail", GetError());
 }
 
 /// <summary>
-///     ,    Addr
+/// Метод обновления иноформации о сокете, вызывается после обновления Addr
 /// </summary>
-/// <param name="ip"> IP    "..." </param>
-/// <param name="port">   </param>
+/// <param name="ip"> IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> номер порта </param>
 void network::sockInfo_t::UpdateSockInfo(std::string ip, unsigned short port)
 {
     IP_port.first.swap(ip);
@@ -158,102 +469,94 @@ void network::sockInfo_t::UpdateSockInfo(std::string ip, unsigned short port)
 }
 
 /// <summary>
-///    
+/// Конструктор с одним параметром
 /// </summary>
-/// <param name="logger"> -     </param>
+/// <param name="logger"> - объект для логгирования ошибок </param>
 network::sockInfo_t::sockInfo_t(log_t& logger) : RAII_OSsock(logger), logger(logger)
 {
-    memset(&Addr, 0, sizeof(Addr));
     IP_port.first.clear();
     IP_port.second = 0;
-    sizeAddr = sizeof(Addr);
 }
 
 /// <summary>
-///   2- 
+/// Конструктор с 2-я параметрами
 /// </summary>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -   </param>
-/// <param name="logger"> -     </param>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта </param>
+/// <param name="logger"> - объект для логгирования ошибок </param>
 network::sockInfo_t::sockInfo_t(std::string ip, unsigned short port, log_t& logger) : sockInfo_t(logger)
 {
     setSockInfo(ip, port);
 }
 
 /// <summary>
-/// 
+/// деструктор
 /// </summary>
 network::sockInfo_t::~sockInfo_t()
 {
-    memset(&Addr, 0, sizeof(Addr));
+    endpoint.Clear();
     IP_port.first.clear();
     IP_port.second = 0;
 }
 
 /// <summary>
-///     
+/// Метод установки информации о сокете
 /// </summary>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -  </param>
-/// <returns> true - ; false -  </returns>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта</param>
+/// <returns> true - успех; false - неудача </returns>
 bool network::sockInfo_t::setSockInfo(std::string ip, unsigned short port)
 {
-    bool result = false; // 
-
-    sockaddr_in AddrIN; //        IP
-    AddrIN.sin_family = AF_INET; //  
-    AddrIN.sin_port = htons(port); //    
-    //  htons       TCP/IP
-
-    //AddrIN.sin_addr -  IN_ADDR ,    IPv4.
-    // :
-    // NADDR_ANY    (0.0.0.0);
-    // INADDR_LOOPBAC  loopback (127.0.0.1);
-    // INADDR_BROADCAST  (255.255.255.255)
-    int inet_pton_state = inet_pton(AF_INET, ip.c_str(), &AddrIN.sin_addr);
-    //  InetPton    IPv4  IPv6   
-    //     
-    //  1 - , 0 -  , -1 - 
-
-    //    
-    if (inet_pton_state == 1) //  
+    bool result = endpoint.Set(ip.c_str(), port); // результат
+
+    if (result) // все отлично
     {
-        memset(&Addr, 0, SizeAddr());
-        memmove(&Addr, &AddrIN, SizeAddr()); //AddrIN ==>> Addr
-        result = true;
         UpdateSockInfo(ip, port);
+        DEBUG_TRACE(logger, "setSockAddr: -> OK"); // вывод отладочной информации что присвоение прошло успешно
     }
-    else if (inet_pton_state == 0) //   IP
+    else // неверно задан IP
         logger.doLog(std::string("setSockAddr Fail, invalid IP: ") + ip);
-    else //inet_pton fail
-        logger.doLog("inet_pton Fail,IP: " + ip, GetError());
-
-    if (result)//       
-    {
-        DEBUG_TRACE(logger, "setSockAddr: -> OK")
-    }
 
     return result;
 }
 
 /// <summary>
-///     
+/// Метод установки информации о сокете
 /// </summary>
-/// <param name="sockInfo"> -        IP </param>
+/// <param name="sockInfo"> - структура описывающая сокет для работы с протоколами IP </param>
 void network::sockInfo_t::setSockInfo(const sockInfo_t& sockInfo)
 {
-    memset(&Addr, 0, SizeAddr());
-    memmove(&Addr, &sockInfo.Addr, SizeAddr());
+    endpoint = sockInfo.endpoint;
     IP_port = sockInfo.IP_port;
 }
 
 /// <summary>
-///        
+/// Метод установки информации о сокете
+/// </summary>
+/// <param name="endpoint"> - адрес сокета </param>
+void network::sockInfo_t::setSockInfo(const endpoint_t& endpoint)
+{
+    this->endpoint = endpoint;
+    IP_port.first.assign(endpoint.Text());
+    IP_port.second = endpoint.Port();
+}
+
+/// <summary>
+/// Метод возврата адреса сокета без копирования
 /// </summary>
-/// <returns>       </returns>
+/// <returns> адрес сокета </returns>
+const network::endpoint_t& network::sockInfo_t::GetEndpoint() const
+{
+    return endpoint;
+}
+
+/// <summary>
+/// Метод возвратата константного указателя на структуру описывающую сокет
+/// </summary>
+/// <returns> константный указатель на структуру описывающую сокет </returns>
 const sockaddr* network::sockInfo_t::getSockAddr() const
 {
-    return &Addr;
+    return endpoint.Addr();
 }
 
 network::sockInfo_t network::sockInfo_t::GetSockInfo() const
@@ -262,74 +565,68 @@ network::sockInfo_t network::sockInfo_t::GetSockInfo() const
 }
 
 /// <summary>
-///      
+/// Метод возврата размера структуры описывающей сокет
 /// </summary>
-/// <returns>     </returns>
+/// <returns> размер структуры описывающей сокет </returns>
 size_t network::sockInfo_t::SizeAddr() const
 {
-    return sizeAddr;
+    return endpoint.Size();
 }
 
 /// <summary>
-///   IP
+/// Метод возврата IP
 /// </summary>
-/// <returns> IP    "..." </returns>
+/// <returns> IP адресс в формате "хххх.хххх.хххх.хххх" </returns>
 std::string network::sockInfo_t::GetIP() const
 {
     return IP_port.first;
 }
 
 /// <summary>
-///    
+/// Метод возврата номера порта
 /// </summary>
-/// <returns>   </returns>
+/// <returns> номер порта </returns>
 unsigned short network::sockInfo_t::GetPort() const
 {
     return IP_port.second;
 }
 
 /// <summary>
-///  
+/// оператор сравнения
 /// </summary>
-/// <param name="rValue"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="rValue"> - правостороннее значение </param>
+/// <returns> 1 - объекты равны </returns>
 bool network::sockInfo_t::operator == (const sockInfo_t& rValue) const
-{//    sockaddr ( )
-    return getSockAddr() == rValue.getSockAddr();
+{// сравниваем адреса по значению
+    return endpoint == rValue.endpoint;
 }
 
 /// <summary>
-///  
+/// оператор сравнения
 /// </summary>
-/// <param name="rValue"> -   </param>
-/// <returns> 1 -    </returns>
+/// <param name="rValue"> - правостороннее значение </param>
+/// <returns> 1 - объекты не равны </returns>
 bool network::sockInfo_t::operator != (const sockInfo_t& rValue) const
 {
     return !(*this == rValue);
 }
 
 /// <summary>
-///     (     TCP)
+/// Метод замены дескриптора сокета (для внутреннего пользования серверным сокетом TCP)
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <param name="nonBlock"> -    </param>
-/// <returns> true -   , false -   </returns>
+/// <param name="socket"> - дескриптор сокета </param>
+/// <param name="nonBlock"> - флаг неблокирующего сокета </param>
+/// <returns> true - при удачной замене, false - при неудачной </returns>
 bool network::socket_t::SetSocket(SOCKET socket, bool nonBlock)
 {
     bool result = false;
-    //   
+    // если аргумент валидный
     if (socket != INVALID_SOCKET)
-        if (Close()) //   
+        if (Close()) // закрываем старый сокет
         {
             Socket = socket;
-            this->nonBlock = nonBlock; // accept    
-            //    
-            socklen_t sizeAddr = SizeAddr();
-            if (!getsockname(Socket, setSockAddr(), &sizeAddr))
-                UpdateSockInfo();//   setSockAddr()
-            else
-                logger.doLog("getsockname fail", GetError());
-
+            this->nonBlock = nonBlock; // accept вернет дефолтный блокирующий сокет
+            UpdateLocalInfo(); // обновляем информацию о сокете
             result = true;
         }
 
@@ -337,25 +634,43 @@ bool network::socket_t::SetSocket(SOCKET socket, bool nonBlock)
 }
 
 /// <summary>
-///   
+/// Метод обновления информации о локальном адресе сокета (после bind, connect, accept)
+/// </summary>
+/// <returns> true - информация обновлена </returns>
+bool network::socket_t::UpdateLocalInfo()
+{
+    bool result = false;
+    socklen_t sizeAddr = endpoint_t::Capacity();
+    if (!getsockname(Socket, setSockAddr(), &sizeAddr))
+    {
+        UpdateSockInfo();// обязательно после setSockAddr()
+        result = true;
+    }
+    else
+        logger.doLog("getsockname fail", GetError());
+    return result;
+}
+
+/// <summary>
+/// Метод закрытия сокета
 /// </summary>
-/// <returns> true -   </returns>
+/// <returns> true - сокет закрыт </returns>
 bool network::socket_t::Close()
 {
-    if (CheckValidSocket(false)) //   
-        if (CLOSE_SOCKET(Socket)) // 
+    if (CheckValidSocket(false)) // если сокет валидный
+        if (CLOSE_SOCKET(Socket)) // закрываем
             logger.doLog("closesocket fail", GetError());
         else
         {
-            Socket = INVALID_SOCKET; //  
-            UpdateSockInfo("", 0); //  
+            Socket = INVALID_SOCKET; // обнуляем дескриптор
+            UpdateSockInfo("", 0); // и информацию
         }
 
     return Socket == INVALID_SOCKET;
 }
 
 /// <summary>
-///   
+/// Метод отключения сокета
 /// </summary>
 void network::socket_t::Shutdown()
 {
@@ -364,38 +679,90 @@ void network::socket_t::Shutdown()
 }
 
 /// <summary>
-///   ,        
-///   ,    ,   
-///     -.
-///        .
+/// назначает внешний адрес, по которому его будут находить транспортные протоколы по
+/// заданию подключающихся процессов, а также назначает порт, по которому эти
+/// подключающиеся процессы будут идентифицировать процесс-получатель.
+/// Предпологается что информация о привязке сокета уже записана.
 /// </summary>
-/// <returns> true - , false -  </returns>
+/// <returns> true - удача, false - неудача </returns>
 bool network::socket_t::Bind()
 {
-    bool result = false;//
+    bool result = false;//результат
 
-    if (CheckValidSocket() && !IP_port.first.empty() && IP_port.second != 0) //      
+    bool b_local = endpoint.Family() == AF_UNIX; // локальный сокет привязывается к пути, порта у него нет
+    if (CheckValidSocket() && !IP_port.first.empty() && (IP_port.second != 0 || b_local)) // Если задана информация о привязке сокета
     {
-        result = (bind(Socket, getSockAddr(), SizeAddr()) == 0); //    IP  
-        if (result) //  
-            DEBUG_TRACE(logger, "bind -> ok " + IP_port.first + '.' + std::to_string(IP_port.second));
+        if (b_local && !ReleaseLocalPath()) // файл сокета прошлого запуска занимает путь
+            logger.doLog("bind -> fail, server is running on " + IP_port.first, error_t::ADDRESS_IN_USE);
         else
-            logger.doLog("bind -> fail " + IP_port.first + '.' + std::to_string(IP_port.second), GetError());
+        {
+            result = (bind(Socket, getSockAddr(), SizeAddr()) == 0); // привязываем его к IP и порту
+            if (result) // Логгируем результат
+                DEBUG_TRACE(logger, "bind -> ok " + IP_port.first + '.' + std::to_string(IP_port.second));
+            else
+                logger.doLog("bind -> fail " + IP_port.first + '.' + std::to_string(IP_port.second), GetError());
+        }
     }
-    else //   Bind()      
+    else // Если вызвали Bind() не установив информацию о привязке сокета
         logger.doLog("bind invalid IP_port");
 
     return result;
 }
 
 /// <summary>
-///   ,        
-///   ,    ,   
-///     -.
+/// Метод освобождения пути локального сокета перед привязкой: файл сокета прошлого запуска удаляется,
+/// только если подключение к нему отклонено (никто не слушает). Чужой файл по ошибочному пути не трогается
+/// </summary>
+/// <returns> 1 - путь можно занимать; 0 - на пути работает сервер (ошибка ADDRESS_IN_USE) </returns>
+bool network::socket_t::ReleaseLocalPath()
+{
+#ifdef __WIN32__
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(IP_port.first.c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+        return true;
+    FindClose(find);
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) || data.dwReserved0 != IO_REPARSE_TAG_AF_UNIX)
+        return true; // не файл сокета: bind() сообщит, что путь занят
+#else
+    struct stat info;
+    if (lstat(IP_port.first.c_str(), &info) != 0 || !S_ISSOCK(info.st_mode))
+        return true;
+#endif
+    // файл сокета остается и после закрытия сервера: живой сервер отличает только принятое подключение
+    SOCKET probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe == INVALID_SOCKET)
+        return true; // проверить нельзя, файл не трогаем
+    setSocketOpt(probe, option_t::NON_BLOCK, logger); // сервер с полной очередью подключений не задерживает привязку
+    bool b_live = connect(probe, getSockAddr(), SizeAddr()) == 0;
+    int error = GetError();
+    CLOSE_SOCKET(probe);
+    if (b_live)
+    {
+#ifdef __WIN32__
+        WSASetLastError(error_t::ADDRESS_IN_USE);
+#else
+        errno = error_t::ADDRESS_IN_USE;
+#endif
+        return false;
+    }
+    if (error == error_t::CONNECTION_REFUSED) // никто не слушает, файл остался от прошлого запуска
+#ifdef __WIN32__
+        DeleteFileA(IP_port.first.c_str());
+#else
+        unlink(IP_port.first.c_str());
+#endif
+    return true;
+}
+
+/// <summary>
+/// назначает внешний адрес, по которому его будут находить транспортные протоколы по
+/// заданию подключающихся процессов, а также назначает порт, по которому эти
+/// подключающиеся процессы будут идентифицировать процесс-получатель.
 /// </summary>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -   </param>
-/// <returns> 1 -  </returns>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта </param>
+/// <returns> 1 - выполнено </returns>
 bool network::socket_t::Bind(std::string ip, unsigned short port)
 {
     bool result = (setSockInfo(ip, port));
@@ -404,70 +771,102 @@ bool network::socket_t::Bind(std::string ip, unsigned short port)
 }
 
 /// <summary>
-///    ,       
+/// Контсруктор с одним параметром, для создания пустого объекта без валидного сокета
 /// </summary>
-/// <param name="logger"> -    </param>
+/// <param name="logger"> - объект для логгирования </param>
 network::socket_t::socket_t(log_t& logger) : sockInfo_t(logger), Socket(INVALID_SOCKET), nonBlock(false)
 {}
 
 /// <summary>
-///   4- 
+/// Конструктор с 4-я параметрами
 /// </summary>
-/// <param name="af"> -  :       .     IPv4.
-///    AF_INET </param>
-/// <param name="type"> -  :      TCP (SOCK_STREAM)  UDP (SOCK_DGRAM).
-///       "" ,        .
-///    SOCK_RAW </param>
-/// <param name="protocol"> -  :  ,      TCP  UDP     0.
+/// <param name="af"> - Семейство адресов: сокеты могут работать с большим семейством адресов. Наиболее частое семейство – IPv4.
+///  Указывается как AF_INET </param>
+/// <param name="type"> - ип сокета: обычно задается тип транспортного протокола TCP (SOCK_STREAM) или UDP (SOCK_DGRAM).
+///  Но бывают и так называемые "сырые" сокеты, функционал которых сам программист определяет в процессе использования.
+///  Тип обозначается SOCK_RAW </param>
+/// <param name="protocol"> - Тип протокола: необязательный параметр, если тип сокета указан как TCP или UDP – можно передать значение 0.
 /// </param>
-/// <param name="logger"> -     </param>
+/// <param name="logger"> - объект для логгирования ошибок </param>
 network::socket_t::socket_t(int af, int type, int protocol, log_t& logger) : socket_t(logger)
 {
-    Socket = socket(af, type, protocol); //         
-    CheckValidSocket(); //   
+    Socket = socket(af, type, protocol); // привязывает созданный сокет к заданной параметрами транспортной инфраструктуре сети
+    CheckValidSocket(); // проверяем валидность сокета
 }
 
 /// <summary>
-///    6 
+///  Конструктор с 6 параметрами
 /// </summary>
-/// <param name="af"> -  :       .     IPv4.
-///    AF_INET </param>
-/// <param name="type"> -  :      TCP (SOCK_STREAM)  UDP (SOCK_DGRAM).
-///       "" ,        .
-///    SOCK_RAW </param>
-/// <param name="protocol"> -  :  ,      TCP  UDP     0.
+/// <param name="af"> - Семейство адресов: сокеты могут работать с большим семейством адресов. Наиболее частое семейство – IPv4.
+///  Указывается как AF_INET </param>
+/// <param name="type"> - ип сокета: обычно задается тип транспортного протокола TCP (SOCK_STREAM) или UDP (SOCK_DGRAM).
+///  Но бывают и так называемые "сырые" сокеты, функционал которых сам программист определяет в процессе использования.
+///  Тип обозначается SOCK_RAW </param>
+/// <param name="protocol"> - Тип протокола: необязательный параметр, если тип сокета указан как TCP или UDP – можно передать значение 0.
 /// </param>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -   </param>
-/// <param name="logger"> -     </param>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта </param>
+/// <param name="logger"> - объект для логгирования ошибок </param>
 network::socket_t::socket_t(int af, int type, int protocol, std::string ip, unsigned short port, log_t& logger) : socket_t(af, type, protocol, logger)
 {
     Bind(ip, port);
 }
 
 /// <summary>
-///    5 
+///  Конструктор с 5 параметрами
 /// </summary>
-/// <param name="af"> -  :       .     IPv4.
-///    AF_INET </param>
-/// <param name="type"> -  :      TCP (SOCK_STREAM)  UDP (SOCK_DGRAM).
-///       "" ,        .
-///    SOCK_RAW </param>
-/// <param name="protocol"> -  :  ,      TCP  UDP     0.
+/// <param name="af"> - Семейство адресов: сокеты могут работать с большим семейством адресов. Наиболее частое семейство – IPv4.
+///  Указывается как AF_INET </param>
+/// <param name="type"> - ип сокета: обычно задается тип транспортного протокола TCP (SOCK_STREAM) или UDP (SOCK_DGRAM).
+///  Но бывают и так называемые "сырые" сокеты, функционал которых сам программист определяет в процессе использования.
+///  Тип обозначается SOCK_RAW </param>
+/// <param name="protocol"> - Тип протокола: необязательный параметр, если тип сокета указан как TCP или UDP – можно передать значение 0.
 /// </param>
-/// <param name="sockInfo"> -     
-/// <param name="logger"> -     </param>
-network::socket_t::socket_t(int af, int type, int protocol, sockInfo_t sockInfo, log_t& logger) : socket_t(af, type, protocol, logger)
+/// <param name="sockInfo"> - объект содержащий информацию о сокете
+/// <param name="logger"> - объект для логгирования ошибок </param>
+network::socket_t::socket_t(int af, int type, int protocol, const sockInfo_t& sockInfo, log_t& logger) : socket_t(af, type, protocol, logger)
 {
     setSockInfo(sockInfo);
     Bind();
 }
 
 /// <summary>
-///    
+///  Конструктор с 4 параметрами, семейство адресов берется из адреса привязки
+/// </summary>
+/// <param name="type"> - тип сокета (SOCK_STREAM, SOCK_DGRAM) </param>
+/// <param name="protocol"> - Тип протокола, для TCP и UDP можно передать 0 </param>
+/// <param name="local"> - адрес привязки сокета </param>
+/// <param name="logger"> - объект для логгирования ошибок </param>
+network::socket_t::socket_t(int type, int protocol, const endpoint_t& local, log_t& logger) : socket_t(local.Family(), type, protocol, logger)
+{
+    setSockInfo(local);
+    Bind();
+}
+
+/// <summary>
+/// Метод создания нового дескриптора сокета, старый закрывается
+/// </summary>
+/// <param name="af"> - семейство адресов </param>
+/// <param name="type"> - тип сокета </param>
+/// <param name="protocol"> - тип протокола </param>
+/// <returns> true - сокет создан </returns>
+bool network::socket_t::Open(int af, int type, int protocol)
+{
+    bool result = false;
+    if (Close())
+    {
+        Socket = socket(af, type, protocol);
+        nonBlock = false;
+        result = CheckValidSocket();
+    }
+    return result;
+}
+
+/// <summary>
+/// Метод проверки валидности сокета
 /// </summary>
-/// <param name="logOn"> -       </param>
-/// <returns> true -  , false -    </returns>
+/// <param name="logOn"> - флаг на задание логгирования невалидности сокета </param>
+/// <returns> true - сокет валиден, false - сокет не валиден </returns>
 bool network::socket_t::CheckValidSocket(bool logOn)
 {
     bool result = Socket != INVALID_SOCKET;
@@ -478,7 +877,7 @@ bool network::socket_t::CheckValidSocket(bool logOn)
 }
 
 /// <summary>
-/// 
+/// деструктор
 /// </summary>
 network::socket_t::~socket_t()
 {
@@ -486,41 +885,517 @@ network::socket_t::~socket_t()
 }
 
 /// <summary>
-///    
+/// Метод возврата дескриптора сокета
 /// </summary>
-/// <returns>   </returns>
+/// <returns> дескриптор сокета </returns>
 SOCKET network::socket_t::getSocket() const
 {
     return Socket;
 }
 
 /// <summary>
-///   
+/// установить сокет неблокирующим
+/// </summary>
+/// <param name="NonBlock"></param>
+/// <returns> 1 - сокет не блокирующий </returns>
+bool network::socket_t::setNonBlock()
+{
+    if (!nonBlock && CheckValidSocket(false))
+        nonBlock = RAII_OSsock::setSocketOpt(Socket, RAII_OSsock::option_t::NON_BLOCK, logger);
+    return nonBlock;
+}
+
+/// <summary>
+/// Метод установки опции сокета
+/// </summary>
+/// <param name="option"> - опция (option_t) </param>
+/// <param name="value"> - значение опции (для опций-флагов 1 - включить, 0 - выключить) </param>
+/// <returns> 1 - опция установлена </returns>
+bool network::socket_t::SetOption(int option, int value)
+{
+    return CheckValidSocket(false) && RAII_OSsock::setSocketOpt(Socket, option, logger, value);
+}
+
+/// <summary>
+/// Метод применения профиля производительности к сокету. Опции, которых нет в ОС, пропускаются
+/// </summary>
+/// <param name="profile"> - профиль (profile_t) </param>
+/// <param name="family"> - семейство адресов сокета: у AF_UNIX нет опций уровня TCP </param>
+/// <returns> 1 - все опции профиля установлены </returns>
+bool network::socket_t::ApplyProfile(int profile, int family)
+{
+    bool result = true;
+
+    switch (profile)
+    {
+    case profile_t::LOW_LATENCY:
+        if (family == AF_UNIX) // ни Нейгла, ни отложенных подтверждений у локального сокета нет
+            break;
+        result &= SetOption(option_t::NO_DELAY); // маленькие сообщения уходят сразу
+#ifndef __WIN32__
+        result &= SetOption(option_t::QUICK_ACK); // ядро сбрасывает флаг, Recive() взводит его снова
+#ifdef TCP_NOTSENT_LOWAT
+        result &= SetOption(option_t::NOTSENT_LOWAT, profile_t::lowatBytes); // не копим очередь в ядре
+#endif
+#ifdef SO_BUSY_POLL
+        SetOption(option_t::BUSY_POLL, profile_t::busyPollUs); // без CAP_NET_ADMIN может быть запрещено, не критично
+#endif
+#endif
+        break;
+    case profile_t::THROUGHPUT: // буферы задаются до connect, чтобы учесть их при согласовании окна
+        result &= SetOption(option_t::SEND_BUFFER, profile_t::bufferBytes);
+        result &= SetOption(option_t::RECV_BUFFER, profile_t::bufferBytes);
+        break;
+    default:
+        break;
+    }
+
+    return result;
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="logger"> - объект для логгирования </param>
+network::transport_t::transport_t(log_t& logger) : b_connected(false), frameLogger(logger)
+{}
+
+/// <summary>
+/// деструктор
+/// </summary>
+network::transport_t::~transport_t()
+{}
+
+/// <summary>
+/// Метод приема сообщений с соединенного сокета с поддержкой контроля размера принятого сообщения
+/// </summary>
+/// <param name="str_bufer"> - буфер для приема данных </param>
+/// <param name="str_EndOfMessege"> - строка символов обозначающая конец сообщения (опционально) </param>
+/// <param name="sizeMsg"> - размер ожидаемого сообщения (опционально) </param>
+/// <returns> 0 - сообщение принято поностью;
+///           N>0 - принято N байт;
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто или невалидный сокет;
+///           -3 - данных на входе нет(неблокирующий сокет);
+///           -4 - кадр длиннее наибольшего размера, соединение разорвано</returns>
+int network::transport_t::Recive(std::string& str_bufer, const std::string str_EndOfMessege, const size_t sizeMsg)
+{
+    int result = -1;
+    // если есть соединение
+    if (b_connected && RawValid())
+    {
+        if (!NonBlocking()) // если мы синхронный сокет
+            str_bufer.clear(); // готовим буферный параметр
+
+        if (!str_EndOfMessege.empty() && scanner.Delimiter() != str_EndOfMessege)
+        {   // сменился признак конца сообщения, пересматриваем непрочитанный остаток
+            scanner.SetDelimiter(str_EndOfMessege);
+            v_bounds.clear();
+            scanner.Scan(pending.data(), pending.size(), v_bounds);
+        }
+
+        bool EOM = str_EndOfMessege.empty() && (sizeMsg == 0); // EndOfMessege признак конца сообщения
+        if (!pending.empty())
+        {   // сначала выдаем данные, принятые вместе с предыдущим кадром
+            size_t begin = str_bufer.size();
+            str_bufer += pending;
+            pending.clear();
+            if (SplitFrame(str_bufer, begin)) // в остатке уже был полный кадр, сокет не трогаем
+                return 0;
+        }
+
+        BeforeRecive();
+        arenaString_t tempStr(2048, '\0', tickArena_t::Local().Resource()); // временная строка фиксированного размера для приема данных, на арене такта
+        int reciveSize = 0; // размер принятых данных
+        // цикл приема данных
+        do {
+            size_t begin = str_bufer.size(); // начало новых данных в буфере
+            size_t length = (frameLength && frameHead == 0 && !str_EndOfMessege.empty()) ? frameLength(str_bufer.data(), begin) : 0;
+            if (length > begin)
+            {   // тело кадра с известной длиной принимаем прямо в буфер, без промежуточной строки
+                str_bufer.resize(length);
+                reciveSize = RawRecive(&str_bufer[begin], length - begin);
+                str_bufer.resize(begin + (reciveSize > 0 ? reciveSize : 0));
+            }
+            else
+            {
+                reciveSize = RawRecive(&tempStr[0], tempStr.size());
+                if (reciveSize > 0)
+                    str_bufer.append(tempStr.data(), reciveSize); // добавляем в буфер только принятые байты
+            }
+
+            if (reciveSize > 0)
+            {// если данные есть
+                DEBUG_TRACE(frameLogger, "Recive msg: " + std::string(&str_bufer[begin], reciveSize));
+
+                if (!str_EndOfMessege.empty()) // если задан EOM, отделяем кадр
+                    EOM = SplitFrame(str_bufer, begin, true);
+                if (sizeMsg != 0) // если задан размер сообщения
+                    EOM |= (str_bufer.size() >= sizeMsg); // проверяем, не все ли мы уже получили
+
+                result = EOM ? 0 : reciveSize; // Если приняли все сообщение, то 0, если часть, то кол-во байт
+                if (!EOM && maxFrame != 0 && frameHead + str_bufer.size() > maxFrame)
+                {   // конца кадра нет, а память уже сверх предела - дальше не принимаем
+                    frameLogger.doLog("transport_t::Recive() frame exceeds limit, bytes: ", frameHead + str_bufer.size());
+                    result = -4;
+                    b_connected = false;
+                    ResetFraming();
+                    break;
+                }
+            }
+            else if (-3 == reciveSize)
+            {
+                result = -3; // неблокирующий транспорт, нет данных
+                break;
+            }
+            else if (reciveSize < 0)
+            {   // ошибка уже в логе транспорта
+                result = -1; // системная ошибка
+                b_connected = false; // и разрываем соединение
+                ResetFraming();
+                break;
+            }
+            else
+            {
+                result = -2; // соединение закрыто
+                b_connected = false;
+                ResetFraming();
+                break;
+            }
+
+        } while (!EOM && !NonBlocking()); // выполнять пока не конец данных, либо мы неблокирующий сокет, и запускаем цикл один раз
+    }
+    else
+        result = -2; // соединение закрыто
+
+    return result;
+}
+
+/// <summary>
+/// Метод потокового приема кадров, ограниченных признаком конца сообщения (неблокирующий сокет).
+/// Длинный кадр выдается частями по мере приема, память на соединение не зависит от длины кадра
+/// </summary>
+/// <param name="str_bufer"> - буфер приема, потребитель очищает его после каждой выданной части и кадра </param>
+/// <param name="str_EndOfMessege"> - строка символов обозначающая конец сообщения </param>
+/// <param name="chunkSize"> - наименьший размер выдаваемой части </param>
+/// <returns> 0 - в буфере конец кадра (либо кадр целиком);
+///           1 - в буфере очередная часть кадра, кадр продолжается;
+///           2 - данные приняты, часть кадра еще не набрана;
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто или невалидный сокет;
+///           -3 - данных на входе нет;
+///           -4 - кадр длиннее наибольшего размера, соединение разорвано</returns>
+int network::transport_t::ReciveStream(std::string& str_bufer, const std::string& str_EndOfMessege, const size_t chunkSize)
+{
+    if (!streamTail.empty())
+    {   // удержанный конец прошлой части уже просмотрен сканером, ставим его перед новыми байтами
+        str_bufer.insert(0, streamTail);
+        streamTail.clear();
+    }
+
+    int result = Recive(str_bufer, str_EndOfMessege);
+    if (0 == result)
+        frameHead = 0; // следующий кадр начнется с начала буфера
+    else if (result > 0)
+    {
+        bool b_whole = frameLength && frameHead == 0 && frameLength(str_bufer.data(), str_bufer.size()) != 0; // кадр с длиной ограничен самой функцией длины
+        size_t keep = str_EndOfMessege.size() - 1; // столько байт признака конца может уже лежать в конце буфера
+        if (!b_whole && str_bufer.size() >= chunkSize + keep)
+        {
+            streamTail.assign(str_bufer, str_bufer.size() - keep, keep);
+            str_bufer.resize(str_bufer.size() - keep);
+            frameHead += str_bufer.size();
+            result = 1;
+        }
+        else
+            result = 2;
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Метод задания наибольшего размера кадра
+/// </summary>
+/// <param name="maxFrame"> - наибольший размер кадра в байтах, 0 - без ограничения </param>
+void network::transport_t::SetMaxFrame(size_t maxFrame)
+{
+    this->maxFrame = maxFrame;
+}
+
+/// <summary>
+/// Метод отправки сообщений с соединенного сокета с поддержкой контроля размера отправленного сообщения
+/// </summary>
+/// <param name="str_bufer"> - буфер, содержащий данные для отправки </param>
+/// <param name="offset"> - смещение от начала буфера, с которого начинается отправка </param>
+/// <returns> 0 - сообщение отправлено поностью;
+///           N>0 - отправлено N байт (вместе со смещением);
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто или невалидный сокет;
+///           -3 - сокет не готов к отправке (неблокирующий сокет)</returns>
+int network::transport_t::Send(const std::string& str_bufer, const unsigned offset)
+{
+    int result = -1;
+    // если мы подключены
+    if (b_connected && RawValid())
+    {
+        int totalSendSize = str_bufer.size(); // требуемое количество отправленных байт
+        int sendSize = offset; // текущее количество отправленных байт
+        // цикл отправки
+        do {
+            int tempSize = totalSendSize > sendSize ? RawSend(&str_bufer[sendSize], totalSendSize - sendSize) : 0;
+            if (tempSize > 0)
+            { // Если что то отправили
+                DEBUG_TRACE(frameLogger, std::string(&str_bufer[sendSize], tempSize));
+                sendSize += tempSize;
+                result = (totalSendSize == sendSize) ? 0 : sendSize; // все ли отправили?
+            }
+            else if (-3 == tempSize)
+            {
+                result = -3; // неблокирующий транспорт не готов к отправке
+                break;
+            }
+            else if (tempSize < 0)
+            {   // ошибка уже в логе транспорта, разрываем соединение
+                result = (-2 == tempSize) ? -2 : -1;
+                b_connected = false;
+                break;
+            }
+            else
+            {
+                result = 0; // отправлять нечего
+                break;
+            }
+        } while ((totalSendSize > sendSize) && !NonBlocking());// выполнять пока не все данные, либо мы неблокирующий сокет, и запускаем цикл один раз
+        if (result > 0)
+            ++partialSends;
+    }
+    else
+        result = -2; // соединение закрыто
+
+    return result;
+}
+
+/// <summary>
+/// Метод отправки через буфер исходящих: что сокет не принял сразу, копится в буфере и дописывается методом Flush().
+/// Пока буфер не пуст, новые данные только добавляются в его конец, поэтому порядок байт сохраняется.
+/// Send() и SendFile() в обход непустого буфера перемешают поток
+/// </summary>
+/// <param name="str_bufer"> - буфер, содержащий данные для отправки </param>
+/// <returns> 0 - данные отправлены либо приняты в буфер;
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто или невалидный сокет</returns>
+int network::transport_t::SendBuffered(const std::string& str_bufer)
+{
+    if (!b_connected || !RawValid())
+        return -2; // соединение закрыто
+
+    size_t sent = 0;
+    if (outboxHead == outbox.size()) // буфер пуст - отправляем сразу, без копирования
+    {
+        int code = Send(str_bufer);
+        if (code == 0 || code == -1 || code == -2)
+            return code;
+        if (code > 0)
+            sent = code;
+    }
+    outbox.append(str_bufer, sent, std::string::npos); // остаток ждет готовности сокета
+    return 0;
+}
+
+/// <summary>
+/// Метод дописывания буфера исходящих, вызывается по готовности сокета к отправке
+/// </summary>
+/// <returns> 0 - буфер пуст;
+///           N>0 - в буфере осталось N байт;
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто или невалидный сокет</returns>
+int network::transport_t::Flush()
+{
+    if (outboxHead == outbox.size())
+        return 0;
+
+    int code = Send(outbox, outboxHead);
+    if (code == 0)
+    {   // буфер отправлен целиком, память оставляем для следующего затора
+        outbox.clear();
+        outboxHead = 0;
+        return 0;
+    }
+    if (code == -1 || code == -2)
+        return code;
+    if (code > 0)
+        outboxHead = code;
+    if (outboxHead > outbox.size() / 2) // отправленное начало сдвигаем, пока оно не больше остатка
+    {
+        outbox.erase(0, outboxHead);
+        outboxHead = 0;
+    }
+    return static_cast<int>(outbox.size() - outboxHead);
+}
+
+/// <summary>
+/// Метод возврата количества байт в буфере исходящих
+/// </summary>
+/// <returns> количество неотправленных байт </returns>
+size_t network::transport_t::Backlog() const
+{
+    return outbox.size() - outboxHead;
+}
+
+/// <summary>
+/// Метод возврата количества частичных отправок: транспорт принял меньше, чем у него просили
+/// </summary>
+/// <returns> количество частичных отправок с последнего сброса потока </returns>
+size_t network::transport_t::PartialSends() const
+{
+    return partialSends;
+}
+
+/// <summary>
+/// метод возврата состояния соединения
+/// </summary>
+/// <returns> 1 - соединение есть </returns>
+bool network::transport_t::GetConnected() const
+{
+    return b_connected;
+}
+
+/// <summary>
+/// Метод логического сброса соединения
+/// </summary>
+void network::transport_t::ResetConnected()
+{
+    b_connected = false;
+}
+
+/// <summary>
+/// Метод проверки наличия полного кадра, принятого ранее вместе с предыдущим кадром.
+/// Такой кадр выдается методом Recive() без обращения к сокету
+/// </summary>
+/// <returns> 1 - есть полный кадр </returns>
+bool network::transport_t::PendingFrame() const
+{
+    size_t length = frameLength && !pending.empty() ? frameLength(pending.data(), pending.size()) : 0;
+    return length != 0 ? pending.size() >= length : !v_bounds.empty();
+}
+
+/// <summary>
+/// Метод задания функции определения длины кадра. Кадры с известной длиной Recive() отделяет по длине,
+/// не просматривая их тело в поиске признака конца сообщения. Функция принадлежит объекту и не переносится методом Move()
+/// </summary>
+/// <param name="frameLength"> - функция определения длины кадра, nullptr - все кадры ограничиваются признаком конца </param>
+void network::transport_t::SetFrameLength(frameLength_t frameLength)
+{
+    this->frameLength = frameLength;
+}
+
+/// <summary>
+/// Метод отделения первого полного кадра от буфера, остаток буфера запоминается до следующего приема
+/// </summary>
+/// <param name="str_bufer"> - буфер приема </param>
+/// <param name="begin"> - позиция в буфере, от которой отсчитаны найденные границы кадров </param>
+/// <returns> true - кадр отделен </returns>
+bool network::transport_t::SplitFrame(std::string& str_bufer, size_t begin, bool b_scan)
+{
+    size_t length = frameLength && frameHead == 0 ? frameLength(str_bufer.data(), str_bufer.size()) : 0; // середину кадра по длине не разбираем
+    if (length != 0)
+    {   // кадр с известной длиной: в теле могут быть любые байты, разделитель в нем не ищем
+        v_bounds.clear();
+        if (str_bufer.size() < length)
+            return false;
+        pending.assign(str_bufer, length, std::string::npos);
+        str_bufer.resize(length);
+        scanner.Reset(); // остаток после кадра просматриваем заново
+        scanner.Scan(pending.data(), pending.size(), v_bounds);
+        return true;
+    }
+
+    if (b_scan) // ищем разделитель только в новых байтах (с учетом разделителя, разорванного между приемами)
+        scanner.Scan(&str_bufer[begin], str_bufer.size() - begin, v_bounds);
+    if (v_bounds.empty())
+        return false;
+
+    size_t first = v_bounds.front(); // конец первого кадра относительно begin
+    size_t end = begin + first;
+    pending.assign(str_bufer, end, std::string::npos); // все, что после него, ждет следующего вызова
+    str_bufer.resize(end);
+    // оставшиеся границы пересчитываем относительно начала pending (front() перезаписывается в цикле)
+    for (size_t indx = 1; indx < v_bounds.size(); ++indx)
+        v_bounds[indx - 1] = v_bounds[indx] - first;
+    v_bounds.pop_back();
+
+    return true;
+}
+
+/// <summary>
+/// Метод сброса состояния потока (новое соединение): разбор на кадры и буфер исходящих
+/// </summary>
+void network::transport_t::ResetFraming()
+{
+    scanner.Reset();
+    pending.clear();
+    v_bounds.clear();
+    frameHead = 0;
+    streamTail.clear();
+    outbox.clear();
+    outboxHead = 0;
+    partialSends = 0;
+}
+
+/// <summary>
+/// Метод обозначения пачки отправок, по умолчанию ничего не делает
+/// </summary>
+/// <param name="b_on"> - 1 - начало пачки, 0 - конец пачки </param>
+void network::transport_t::Cork(bool b_on)
+{
+    (void)b_on;
+}
+
+/// <summary>
+/// Метод подготовки к приему, по умолчанию ничего не делает
 /// </summary>
-/// <param name="NonBlock"></param>
-/// <returns> 1 -    </returns>
-bool network::socket_t::setNonBlock()
+void network::transport_t::BeforeRecive()
+{}
+
+/// <summary>
+/// Метод переноса состояния потока от другого транспорта, состояние источника сбрасывается
+/// </summary>
+/// <param name="source"> - транспорт источник </param>
+void network::transport_t::MoveFraming(transport_t& source)
 {
-    if (!nonBlock && CheckValidSocket(false))
-        nonBlock = RAII_OSsock::setSocketOpt(Socket, RAII_OSsock::option_t::NON_BLOCK, logger);
-    return nonBlock;
+    scanner = source.scanner; // непрочитанные данные переходят вместе с соединением
+    pending.swap(source.pending);
+    v_bounds.swap(source.v_bounds);
+    frameHead = source.frameHead;
+    streamTail.swap(source.streamTail);
+    outbox.swap(source.outbox);
+    outboxHead = source.outboxHead;
+    partialSends = source.partialSends;
+    source.ResetFraming();
+    b_connected = source.b_connected;
+    source.b_connected = false;
 }
 
 /// <summary>
-///  ,      ,       acept()
+/// Заменить сокет, данный метод нарушает принцип уникальности ресурса, но необходим для серверного сокета для acсept()
 /// </summary>
-/// <param name="socket"> -    </param>
-/// <param name="sockInfo"> -   </param>
-/// <returns> true -   </returns>
-bool network::TCP_socketClient_t::SetSocket(SOCKET socket, sockInfo_t sockInfo)
+/// <param name="socket"> - новый дескриптор сокета </param>
+/// <param name="sockInfo"> - обновленная информация </param>
+/// <returns> true - успешная замена </returns>
+bool network::TCP_socketClient_t::SetSocket(SOCKET socket, const endpoint_t& sockInfo)
 {
     bool result = (b_connected = socket_t::SetSocket(socket, false));
-    if (result) serverInfo.setSockInfo(sockInfo);
+    if (result)
+    {
+        serverInfo = sockInfo;
+        ResetFraming(); // новое соединение - новый поток
+    }
     return result;
 }
 
 /// <summary>
-/// 
+/// деструктор
 /// </summary>
 network::TCP_socketClient_t::~TCP_socketClient_t()
 {
@@ -528,217 +1403,213 @@ network::TCP_socketClient_t::~TCP_socketClient_t()
 }
 
 /// <summary>
-///     ()  
+/// метод переноса уникального ресурса (дескпритор) между сокетами
 /// </summary>
-/// <param name="source"> -     -        </param>
+/// <param name="source"> - ссылка на сокет источник - после вызова метода не содержит валидный сокет </param>
 void network::TCP_socketClient_t::Move(TCP_socketClient_t& source)
 {
     if (Close() && socket_t::SetSocket(source.getSocket(), source.nonBlock))
     {
-        serverInfo.setSockInfo(source.serverInfo);
-        b_connected = source.b_connected;
-        source.b_connected = false;
+        serverInfo = source.serverInfo;
+        profile = source.profile;
+        deadTimeout = source.deadTimeout;
+        b_corked = source.b_corked;
+        source.b_corked = false;
+        MoveFraming(source); // непрочитанные и неотправленные данные переходят вместе с соединением
         source.Socket = INVALID_SOCKET;
         source.nonBlock = false;
-        source.serverInfo.UpdateSockInfo("", 0);
+        source.serverInfo.Clear();
         source.UpdateSockInfo("", 0);
     }
 }
 
 /// <summary>
-///   1 
+/// Конструткор с 1 параметром
 /// </summary>
-/// <param name="logger"> -    </param>
-network::TCP_socketClient_t::TCP_socketClient_t(log_t& logger) : socket_t(logger), b_connected(false), serverInfo(logger)
+/// <param name="logger"> - объект для логгирования </param>
+network::TCP_socketClient_t::TCP_socketClient_t(log_t& logger) : socket_t(logger), transport_t(logger)
 {}
 
 /// <summary>
-///   3 
+/// Конструктор с 3 параметрами
 /// </summary>
-/// <param name="ip_server"> - IP     "..." </param>
-/// <param name="port_server"> -    </param>
-/// <param name="logger"> -   </param>
-network::TCP_socketClient_t::TCP_socketClient_t(std::string ip_server, unsigned short port_server, log_t& logger) : socket_t(AF_INET, SOCK_STREAM, 0, logger), b_connected(false), serverInfo(logger)
+/// <param name="ip_server"> - IP адрес сервера в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port_server"> - номер порта сервера </param>
+/// <param name="logger"> - объект логгирования </param>
+network::TCP_socketClient_t::TCP_socketClient_t(std::string ip_server, unsigned short port_server, log_t& logger) : socket_t(logger), transport_t(logger)
 {
-    if (serverInfo.setSockInfo(ip_server, port_server)) //      
-        Connected(); //    
+    if (serverInfo.Set(ip_server.c_str(), port_server)) // Если успешно задали информацию о сервере
+    {
+        if (Open(serverInfo.Family(), SOCK_STREAM, 0)) // сокет того же семейства, что и адрес сервера
+            Connected(); // устанавливаем соденение с ним
+    }
+    else
+        logger.doLog("TCP_socketClient_t invalid server IP: " + ip_server);
 }
 
 /// <summary>
-///   2 
+/// Коструктор с 2 параметрами
+/// </summary>
+/// <param name="serverSockInfo"> - информация о сервере </param>
+/// <param name="logger"> - объект логгирования </param>
+network::TCP_socketClient_t::TCP_socketClient_t(const sockInfo_t& serverSockInfo, log_t& logger) : TCP_socketClient_t(serverSockInfo.GetEndpoint(), logger)
+{}
+
+/// <summary>
+/// Коструктор с 2 параметрами, семейство адресов сокета берется из адреса сервера
 /// </summary>
-/// <param name="serverSockInfo"> -    </param>
-/// <param name="logger"> -   </param>
-network::TCP_socketClient_t::TCP_socketClient_t(sockInfo_t serverSockInfo, log_t& logger) : socket_t(AF_INET, SOCK_STREAM, 0, logger), b_connected(false), serverInfo(logger)
+/// <param name="server"> - адрес сервера </param>
+/// <param name="logger"> - объект логгирования </param>
+network::TCP_socketClient_t::TCP_socketClient_t(const endpoint_t& server, log_t& logger) : socket_t(server.Family(), SOCK_STREAM, 0, logger), transport_t(logger), serverInfo(server)
 {
-    serverInfo.setSockInfo(serverSockInfo); //    
-    Connected(); //  
+    Connected(); // устанавливаем соединение
 }
 
 /// <summary>
-///            
+/// Метод подключения сокета к серверному сокету
 /// </summary>
-/// <param name="str_bufer"> -     </param>
-/// <param name="str_EndOfMessege"> -      () </param>
-/// <param name="sizeMsg"> -    () </param>
-/// <returns> 0 -   ;
-///           N>0 -  N ;
-///           -1 -  ;
-///           -2 -     ;
-///           -3 -    ( )</returns>
-int network::TCP_socketClient_t::Recive(std::string& str_bufer, const std::string str_EndOfMessege, const size_t sizeMsg)
+/// <returns> 1 - есть подключение </returns>
+bool network::TCP_socketClient_t::Connected()
 {
-    int result = -1;
-    //   
-    if (b_connected && CheckValidSocket(false))
+    // если сокет валиден
+    if (CheckValidSocket(false) && !b_connected)
     {
-        if (!nonBlock) //    
-            str_bufer.clear(); //   
-        
-        std::string tempStr(2048, '\0'); //       
-        int reciveSize = 0; //   
-        bool EOM = str_EndOfMessege.empty() && (sizeMsg == 0); // EndOfMessege   
-        //   
-        do {
-            reciveSize = recv(Socket, &tempStr[0], tempStr.size(), 0); //       .
+        ApplyProfile(profile, serverInfo.Family());
+        ApplyDeadTimeout();
+        // функция запускает процесс трехстороннего квитирования - она командует TCP - стеку клиента отправить первый пакет SYN
+        if (0 != connect(Socket, serverInfo.Addr(), serverInfo.Size()))
+            logger.doLog("TCP_socketClient_t non connected with server:", GetError());
+        else
+        {   // если мы успешно подключились, обновляем информацию о себе (нас неявно забиндили)
+            b_connected = true;
+            UpdateLocalInfo();
+        }
+    }
 
-            if (reciveSize > 0)
-            {//   
-                DEBUG_TRACE(logger, "Recive msg: " + tempStr)
-                    tempStr.assign(tempStr.c_str()); //    '\0';
-                str_bufer += tempStr; //   
-                tempStr.clear(); //  
-
-                if (!str_EndOfMessege.empty())
-                { //   EOM
-                    int pos = str_bufer.size() - str_EndOfMessege.size(); //     
-                    if (pos >= 0) //   
-                        EOM = (str_bufer.rfind(str_EndOfMessege) == pos); //     
-                }
-                if (sizeMsg != 0) //    
-                    EOM |= (str_bufer.size() >= sizeMsg); // ,      
+    return b_connected;
+}
 
-                result = EOM ? 0 : reciveSize; //    ,  0,  ,  - 
-            }
-            else if (reciveSize < 0)
-            {   //    , ,    
-                if (nonBlock && GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
-                    result = -3; //   ,  
-                else
-                {   //   , 
-                    logger.doLog("TCP_socketClient_t::Recive() fail, errno: ", GetError());
-                    result = -1; //  
-                    b_connected = false; //   
-                }
-                break;
-            }
-            else
-            {
-                result = -2; //  
-                b_connected = false;
-                break;
-            }
+/// <summary>
+/// Метод начала неблокирующего подключения к серверу. Создает новый неблокирующий сокет семейства адреса сервера.
+/// Завершение подключения проверяется методом CheckConnect() после готовности сокета (NonBlockSocket_manager_t::AddClient)
+/// </summary>
+/// <param name="server"> - адрес сервера </param>
+/// <returns> 0 - подключен сразу;
+///           1 - подключение в процессе;
+///          -1 - системная ошибка </returns>
+int network::TCP_socketClient_t::ConnectAsync(const endpoint_t& server)
+{
+    int result = -1;
+    b_connected = false;
+    serverInfo = server;
+    ResetFraming();
 
-        } while (!EOM && !nonBlock); //     ,    ,     
+    if (Open(server.Family(), SOCK_STREAM, 0) && setNonBlock())
+    {
+        ApplyProfile(profile, serverInfo.Family());
+        ApplyDeadTimeout();
+        // неблокирующий connect сразу возвращает управление, трехстороннее квитирование идет в фоне
+        if (0 == connect(Socket, serverInfo.Addr(), serverInfo.Size()))
+        {
+            b_connected = true;
+            UpdateLocalInfo();
+            result = 0;
+        }
+        else if (GetError() == error_t::CONNECT_IN_PROGRESS)
+            result = 1;
+        else
+            logger.doLog("TCP_socketClient_t::ConnectAsync() fail " + std::string(server.Text()), GetError());
     }
-    else
-        result = -2; //  
 
     return result;
 }
 
 /// <summary>
-///            
+/// Метод проверки результата неблокирующего подключения
 /// </summary>
-/// <param name="str_bufer"> - ,     </param>
-/// <param name="offset"> -    ,     </param>
-/// <returns> 0 -   ;
-///           N>0 -  N  (  );
-///           -1 -  ;
-///           -2 -     ;
-///           -3 -      ( )</returns>
-int network::TCP_socketClient_t::Send(const std::string& str_bufer, const unsigned offset)
+/// <returns> 0 - подключен;
+///           1 - подключение в процессе;
+///          -1 - подключение не удалось </returns>
+int network::TCP_socketClient_t::CheckConnect()
 {
     int result = -1;
-    //   
-    if (b_connected && CheckValidSocket(false))
+
+    if (b_connected)
+        result = 0;
+    else if (CheckValidSocket(false))
     {
-        int totalSendSize = str_bufer.size(); //    
-        int sendSize = offset; //    
-        //  
-        do {
-            int tempSize = send(Socket, &str_bufer[sendSize], totalSendSize - sendSize, 0); //       
-            if (tempSize > 0)
-            { //    
-                DEBUG_TRACE(logger, std::string(&str_bufer[sendSize], tempSize));
-                sendSize += tempSize;
-                result = (totalSendSize == sendSize) ? 0 : sendSize; //   ?
-            }
-            else if (tempSize < 0)
-            {//    , ,    
-                if (nonBlock && GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
-                    result = -3; //   ,  
-                else //  ,     ,   
-                {
-                    logger.doLog("TCP_socketClient_t::Send() fail, errno: ", GetError());
-                    result = -1; //  
-                    b_connected = false; //   
-                }
-                break;
-            }
-            else
+        int error = 0;
+        socklen_t size = sizeof(error);
+        // результат подключения хранится в ошибке сокета
+        if (getsockopt(Socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &size))
+            logger.doLog("TCP_socketClient_t::CheckConnect() getsockopt fail", GetError());
+        else if (error == 0)
+        {   // соединение есть, если у сокета есть удаленная сторона
+            endpoint_t peer;
+            socklen_t sizePeer = endpoint_t::Capacity();
+            if (0 == getpeername(Socket, peer.Addr(), &sizePeer))
             {
-                result = str_bufer.empty() ? 0 : -1; //    ?   
-                break;
+                b_connected = true;
+                UpdateLocalInfo(); // обновляем информацию о себе (нас неявно забиндили)
+                result = 0;
             }
-        } while ((totalSendSize > sendSize) && !nonBlock);//     ,    ,     
+            else
+                result = 1;
+        }
+        else if (error == error_t::CONNECT_IN_PROGRESS || error == error_t::NON_BLOCK_SOCKET_NOT_READY)
+            result = 1;
+        else
+            logger.doLog("TCP_socketClient_t non connected with server " + std::string(serverInfo.Text()) + ":", error);
     }
-    else
-        result = -2; //  
 
     return result;
 }
 
 /// <summary>
-///      
+/// Метод задания профиля производительности, применяется при подключении (ConnectAsync, Connected)
 /// </summary>
-/// <returns> 1 -   </returns>
-bool network::TCP_socketClient_t::Connected()
+/// <param name="profile"> - профиль (profile_t) </param>
+void network::TCP_socketClient_t::SetProfile(int profile)
 {
-    //   
-    if (CheckValidSocket(false) && !b_connected)
-    {   //      -   TCP -      SYN
-        if (0 != connect(Socket, serverInfo.getSockAddr(), serverInfo.SizeAddr()))
-            logger.doLog("TCP_socketClient_t non connected with server:", GetError());
-        else
-        {   //    ,     (  )
-            b_connected = true;
-            UpdateSockInfo();
-        }
-    }
+    this->profile = profile;
+}
 
-    return b_connected;
+/// <summary>
+/// Метод задания предела ожидания подтверждения отправленных данных, применяется при подключении:
+/// если собеседник не подтверждает данные дольше предела, ядро разрывает соединение, и прием либо
+/// отправка возвращают ошибку. Включает и SO_KEEPALIVE. У AF_UNIX не действует
+/// </summary>
+/// <param name="timeout"> - предел, мс (0 - по умолчанию ОС) </param>
+void network::TCP_socketClient_t::SetDeadTimeout(unsigned timeout)
+{
+    deadTimeout = timeout;
 }
 
 /// <summary>
-///    
+/// Метод применения предела ожидания подтверждения к открытому сокету
 /// </summary>
-/// <returns> 1 -   </returns>
-bool network::TCP_socketClient_t::GetConnected() const
+void network::TCP_socketClient_t::ApplyDeadTimeout()
 {
-    return b_connected;
+    if (deadTimeout == 0 || serverInfo.Family() == AF_UNIX) // локальный собеседник не пропадает молча
+        return;
+    SetOption(option_t::KEEP_ALIVE);
+    SetOption(option_t::USER_TIMEOUT, static_cast<int>(deadTimeout)); // нет в ОС - остается проверка по затору отправки
 }
 
 /// <summary>
-///    
+/// Метод управления TCP_CORK вокруг пачки отправок: при включении данные копятся в ядре
+/// и уходят полными сегментами после выключения. Действует только в профиле THROUGHPUT
 /// </summary>
-void network::TCP_socketClient_t::ResetConnected()
+/// <param name="b_on"> - 1 - начало пачки, 0 - конец пачки </param>
+void network::TCP_socketClient_t::Cork(bool b_on)
 {
-    b_connected = false;
+    if (profile == profile_t::THROUGHPUT && serverInfo.Family() != AF_UNIX && b_connected && b_corked != b_on)
+        if (SetOption(option_t::CORK, b_on) || !b_on)
+            b_corked = b_on;
 }
 
 /// <summary>
-///   
+/// Метод отключения сокета
 /// </summary>
 void network::TCP_socketClient_t::Shutdown()
 {
@@ -750,24 +1621,169 @@ void network::TCP_socketClient_t::Shutdown()
 }
 
 /// <summary>
-///   3- 
+/// Метод отправки части файла без копирования в пространство пользователя (sendfile)
+/// </summary>
+/// <param name="fd"> - дескриптор открытого на чтение файла </param>
+/// <param name="offset"> - смещение в файле, сдвигается на количество отправленных байт </param>
+/// <param name="count"> - количество байт для отправки </param>
+/// <returns> 0 - отправлено все;
+///           N>0 - отправлено N байт;
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто или невалидный сокет;
+///           -3 - сокет не готов к отправке (неблокирующий сокет);
+///           -4 - файл кончился раньше count (файл укоротили во время отправки)</returns>
+int network::TCP_socketClient_t::SendFile(int fd, long long& offset, size_t count)
+{
+    int result = -2;
+    if (b_connected && CheckValidSocket(false))
+    {
+#ifdef __WIN32__
+        // TransmitFile требует перекрывающегося ввода-вывода, поэтому здесь файл читается через буфер такта
+        arenaString_t tempStr(count < 65536 ? count : 65536, '\0', tickArena_t::Local().Resource());
+        long long sent = -1;
+        if (_lseeki64(fd, offset, SEEK_SET) == offset)
+        {
+            int size = _read(fd, &tempStr[0], static_cast<unsigned>(tempStr.size()));
+            sent = size > 0 ? send(Socket, tempStr.data(), size, 0) : size;
+        }
+#else
+        off_t position = offset;
+        ssize_t sent = sendfile(Socket, fd, &position, count); // данные идут из страничного кэша прямо в сокет
+#endif
+        if (sent > 0)
+        {
+            offset += sent;
+            result = static_cast<size_t>(sent) == count ? 0 : static_cast<int>(sent);
+        }
+        else if (sent == 0) // конец файла: errno не задан, это не ошибка сокета
+            result = -4;
+        else if (nonBlock && GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
+            result = -3; // сокет не блокирующий, буфер отправки полон
+        else
+        {
+            logger.doLog("TCP_socketClient_t::SendFile() fail, errno: ", GetError());
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+/// <summary>
+/// Метод приема байт из сокета
+/// </summary>
+/// <param name="data"> - буфер приема </param>
+/// <param name="size"> - размер буфера </param>
+/// <returns> N>0 - принято N байт; 0 - соединение закрыто; -1 - системная ошибка; -3 - данных нет </returns>
+int network::TCP_socketClient_t::RawRecive(char* data, size_t size)
+{
+    int result = recv(Socket, data, static_cast<int>(size), 0); // Функция служит для чтения данных из сокета.
+    if (result < 0)
+    {   // если сокет не блокирующий, проверяем, может просто нет данных
+        if (nonBlock && GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
+            result = -3;
+        else
+        {
+            logger.doLog("TCP_socketClient_t::Recive() fail, errno: ", GetError());
+            result = -1;
+        }
+    }
+    return result;
+}
+
+/// <summary>
+/// Метод отправки байт в сокет
+/// </summary>
+/// <param name="data"> - данные для отправки </param>
+/// <param name="size"> - количество байт </param>
+/// <returns> N>0 - отправлено N байт; -1 - системная ошибка; -3 - сокет не готов к отправке </returns>
+int network::TCP_socketClient_t::RawSend(const char* data, size_t size)
+{
+    int result = send(Socket, data, static_cast<int>(size), 0); // используются для пересылки сообщений в другой сокет
+    if (result < 0)
+    {
+        if (nonBlock && GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
+            result = -3; // буфер отправки полон
+        else
+        {
+            logger.doLog("TCP_socketClient_t::Send() fail, errno: ", GetError());
+            result = -1;
+        }
+    }
+    else if (result == 0)
+        result = -1; // непустые данные не отправлены
+    return result;
+}
+
+/// <summary>
+/// Метод проверки валидности сокета
 /// </summary>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -   </param>
-/// <param name="logger"> -   </param>
+/// <returns> 1 - сокет валиден </returns>
+bool network::TCP_socketClient_t::RawValid()
+{
+    return CheckValidSocket(false);
+}
+
+/// <summary>
+/// Метод проверки режима сокета
+/// </summary>
+/// <returns> 1 - неблокирующий сокет </returns>
+bool network::TCP_socketClient_t::NonBlocking() const
+{
+    return nonBlock;
+}
+
+/// <summary>
+/// Метод подготовки сокета к приему: в профиле LOW_LATENCY взводит TCP_QUICKACK
+/// </summary>
+void network::TCP_socketClient_t::BeforeRecive()
+{
+#ifndef __WIN32__
+    if (profile == profile_t::LOW_LATENCY && serverInfo.Family() != AF_UNIX) // ядро сбрасывает TCP_QUICKACK, взводим его перед каждым чтением
+        SetOption(option_t::QUICK_ACK);
+#endif
+}
+
+/// <summary>
+/// Метод возврата адреса сервера
+/// </summary>
+/// <returns> адрес сервера </returns>
+const network::endpoint_t& network::TCP_socketClient_t::GetServer() const
+{
+    return serverInfo;
+}
+
+/// <summary>
+/// конструктор с 3-я параметрами
+/// </summary>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта </param>
+/// <param name="logger"> - объект логгирования </param>
 network::TCP_socketServer_t::TCP_socketServer_t(std::string ip, unsigned short port, log_t& logger) : socket_t(AF_INET, SOCK_STREAM, 0, ip, port, logger)
-{ // listen    ,      
+{ //Функция listen помещает сокет в состояние, в котором он прослушивает входящее соединение
+    if (CheckValidSocket(false))
+        if (0 != listen(Socket, SOMAXCONN))
+            this->logger.doLog("TCP_socketServer_t listen fali ", GetError());
+}
+
+/// <summary>
+/// конструктор с 2-я параметрами
+/// </summary>
+/// <param name="sockInfo"> - информация о сокете </param>
+/// <param name="logger"> - объект логгирования </param>
+network::TCP_socketServer_t::TCP_socketServer_t(const sockInfo_t& sockInfo, log_t& logger) : socket_t(AF_INET, SOCK_STREAM, 0, sockInfo, logger)
+{
     if (CheckValidSocket(false))
         if (0 != listen(Socket, SOMAXCONN))
             this->logger.doLog("TCP_socketServer_t listen fali ", GetError());
 }
 
 /// <summary>
-///   2- 
+/// конструктор с 2-я параметрами
 /// </summary>
-/// <param name="sockInfo"> -    </param>
-/// <param name="logger"> -   </param>
-network::TCP_socketServer_t::TCP_socketServer_t(sockInfo_t sockInfo, log_t& logger) : socket_t(AF_INET, SOCK_STREAM, 0, sockInfo, logger)
+/// <param name="local"> - адрес привязки </param>
+/// <param name="logger"> - объект логгирования </param>
+network::TCP_socketServer_t::TCP_socketServer_t(const endpoint_t& local, log_t& logger) : socket_t(SOCK_STREAM, 0, local, logger)
 {
     if (CheckValidSocket(false))
         if (0 != listen(Socket, SOMAXCONN))
@@ -775,40 +1791,40 @@ network::TCP_socketServer_t::TCP_socketServer_t(sockInfo_t sockInfo, log_t& logg
 }
 
 /// <summary>
-///    
+/// метод добавления подключенных клиентов
 /// </summary>
-/// <param name="client"> -         </param>
-/// <returns> 0 -   ,
-///          -1 -  ,
-///          -2 -       ( )</returns>
-///			 -3 -   ( )    
+/// <param name="client"> - ссылка на клиента под замену на подключенного клиента </param>
+/// <returns> 0 - добавлен подключенный клиент,
+///          -1 - системная ошибка,
+///          -2 - нет клиентов в очереди на подключение (неблокирующий сокет)</returns>
+///			 -3 - невалидный аргумент (существующий сокет) или невалидный серверный сокет
 int network::TCP_socketServer_t::AddClient(TCP_socketClient_t& client)
 {
     int result = -1;
 
     if (!client.CheckValidSocket(false) && CheckValidSocket(false))
     {
-        sockInfo_t tempInfo(logger); //    
-        socklen_t sizeAddr = tempInfo.SizeAddr(); //  
-        //       .         .
-        //     ,   accept   -,  
-        //     .
-        SOCKET tempSocket = accept(Socket, tempInfo.setSockAddr(), &sizeAddr);
+        endpoint_t tempInfo; // адрес подключенного сокета
+        socklen_t sizeAddr = endpoint_t::Capacity(); // его размер
+        //функция используется сервером для принятия связи на сокет. Сокет должен быть уже слушающим в момент вызова функции.
+        //Если сервер устанавливает связь с клиентом, то функция accept возвращает новый сокет-дескриптор, через который
+        //и происходит общение клиента с сервером.
+        SOCKET tempSocket = accept(Socket, tempInfo.Addr(), &sizeAddr);
         if (tempSocket != INVALID_SOCKET)
-        { //     ,   
-            tempInfo.UpdateSockInfo(); //    
+        { // если есть какой то сокет, то устанавливаем его
+            tempInfo.Fit(); // предварительнообновив информацию о сокете
             if (client.SetSocket(tempSocket, tempInfo))
-            { //  ?    
-                DEBUG_TRACE(logger, "addClient success" + tempInfo.GetIP() + std::to_string(tempInfo.GetPort()))
+            { // все получилось? вывод отладки и результата
+                DEBUG_TRACE(logger, "addClient success" + std::string(tempInfo.Text()) + std::to_string(tempInfo.Port()))
                     result = 0;
             }
-            else //     
+            else // иначе проблема в установке сокета
                 logger.doLog("fail SetSocket in addClient", GetError());
-        } //                     
+        } // или мы не получили никакой сокет и если мы неблокирующий сокет и ошибка связана с отсутствием клиентов в очереди на подключение
         else if (GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY && nonBlock)
             result = -2;
         else
-            logger.doLog("accept fail", GetError()); //    
+            logger.doLog("accept fail", GetError()); // иначе это системная ошибка
     }
     else
         result = -3;
@@ -817,192 +1833,215 @@ int network::TCP_socketServer_t::AddClient(TCP_socketClient_t& client)
 }
 
 /// <summary>
-///     ()  
+/// метод переноса уникального ресурса (дескпритор) между сокетами
 /// </summary>
-/// <param name="source"> -     -        </param>
+/// <param name="source"> - ссылка на сокет источник - после вызова метода не содержит валидный сокет </param>
 void network::UDP_socket_t::Move(UDP_socket_t& source)
 {
     if (Close() && socket_t::SetSocket(source.Socket, source.nonBlock))
     {
-        lastCommunicationSocket.setSockInfo(source.lastCommunicationSocket);
+        lastCommunicationSocket = source.lastCommunicationSocket;
         source.Socket = INVALID_SOCKET;
         source.nonBlock = false;
-        source.lastCommunicationSocket.UpdateSockInfo("", 0);
+        source.lastCommunicationSocket.Clear();
         source.UpdateSockInfo("", 0);
     }
 }
 
 /// <summary>
-///   MTU
+/// метод установки MTU
 /// </summary>
 void network::UDP_socket_t::setMTU()
 {
 #ifdef __WIN32__
-    int optlen = sizeof(u32_MTU); //  
-    // getsockopt      ,     ,   
+    int optlen = sizeof(u32_MTU); // размер опции
+    //Функция getsockopt извлекает текущее значение для параметра сокета, связанного с сокетом любого типа, в любом состоянии
     if (getsockopt(Socket, SOL_SOCKET, SO_MAX_MSG_SIZE, (char*)(&u32_MTU), &optlen))
         logger.doLog("getsockopt fail ", GetError());
 #else
-    u32_MTU = 512; // TODO    
+    u32_MTU = 512; // TODO реализовать и для линукса
 #endif
 }
 
 /// <summary>
-///   1 
+/// Конструткор с 1 параметром
+/// </summary>
+/// <param name="logger"> - объект для логгирования </param>
+network::UDP_socket_t::UDP_socket_t(log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, logger), lastCommunicationSocket()
+{
+    setMTU();
+}
+
+/// <summary>
+/// конструктор с 3-я параметрами
 /// </summary>
-/// <param name="logger"> -    </param>
-network::UDP_socket_t::UDP_socket_t(log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, logger), lastCommunicationSocket(logger)
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта </param>
+/// <param name="logger"> - объект логгирования </param>
+network::UDP_socket_t::UDP_socket_t(std::string ip, unsigned short port, log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, ip, port, logger), lastCommunicationSocket()
 {
     setMTU();
 }
 
 /// <summary>
-///   3- 
+/// конструктор с 2-я параметрами
 /// </summary>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -   </param>
-/// <param name="logger"> -   </param>
-network::UDP_socket_t::UDP_socket_t(std::string ip, unsigned short port, log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, ip, port, logger), lastCommunicationSocket(logger)
+/// <param name="sockInfo"> - информация о сокете </param>
+/// <param name="logger"> - объект логгирования </param>
+network::UDP_socket_t::UDP_socket_t(const sockInfo_t& sockInfo, log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, sockInfo, logger), lastCommunicationSocket()
 {
     setMTU();
 }
 
 /// <summary>
-///   2- 
+/// конструктор с 2-я параметрами
 /// </summary>
-/// <param name="sockInfo"> -    </param>
-/// <param name="logger"> -   </param>
-network::UDP_socket_t::UDP_socket_t(sockInfo_t& sockInfo, log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, sockInfo, logger), lastCommunicationSocket(logger)
+/// <param name="local"> - адрес привязки </param>
+/// <param name="logger"> - объект логгирования </param>
+network::UDP_socket_t::UDP_socket_t(const endpoint_t& local, log_t& logger) : socket_t(SOCK_DGRAM, 0, local, logger), lastCommunicationSocket()
 {
     setMTU();
 }
 
 /// <summary>
-///        
+/// Метод отправки данных в сеть без предварительного соединения
 /// </summary>
-/// <param name="buffer"> -      </param>
-/// <param name="target"> -     </param>
-/// <returns> 0 -   ;
-///         N>0 -  N ;
-///          -1 -  ;
-///          -2 -    MTU    
-///          -3 -      ( ) </returns>
-int network::UDP_socket_t::SendTo(const std::string& buffer, sockInfo_t target)
+/// <param name="buffer"> - область с данными для отправки </param>
+/// <param name="target"> - информация о сокете приемнике </param>
+/// <returns> 0 - отправлено все сообщение;
+///         N>0 - отправлено N байт;
+///          -1 - системная ошибка;
+///          -2 - размер сообщения больше MTU или сокет не валидный
+///          -3 - сокет не готов к отправке (неблокирующий сокет) </returns>
+int network::UDP_socket_t::SendTo(const std::string& buffer, const endpoint_t& target)
 {
     int result = -1;
-    //   
+    // проверяем размер сообщения
     if (CheckValidSocket(false) && buffer.size() < MTU())
-    { //  sendto      
-        int sendSize = sendto(Socket, buffer.c_str(), buffer.size(), 0, target.getSockAddr(), target.SizeAddr());
-        //  
+    { // Функция sendto отправляет данные в определенное место назначения
+        int sendSize = sendto(Socket, buffer.c_str(), buffer.size(), 0, target.Addr(), target.Size());
+        // проверяем результат
         if (sendSize > 0)
-        { //    
-            result = (sendSize == buffer.size()) ? 0 : sendSize; //    ,  0 -  ,  ,    
+        { // если есть положительный результат
+            result = (sendSize == buffer.size()) ? 0 : sendSize; // если сообщение отправилось полностью, то 0 - все гуд, если нет, то количество переданых байт
             DEBUG_TRACE(logger, "sendto: " + buffer)
         }
         else if (sendSize < 0)
-        { //   , ,        
+        { // если есть ошибка, проверяем, связана ли она с блокировкой при неблокирующем сокете
             if (GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY && nonBlock)
-                result = -3; //    ()
+                result = -3; // сокет не готов (неблокирующий)
             else
-                logger.doLog("sendto fail ", GetError()); //   
+                logger.doLog("sendto fail ", GetError()); // иначе системная ошибка
         }
-        else if (buffer.empty()) //    ?     
+        else if (buffer.empty()) // если пытались отправить ноль? то у нас все получилось
             result = 0;
     }
     else
-        result = -2; //    MTU    
+        result = -2; // размер сообщения больше MTU или сокет не валидный
 
-    //     ,     (   )
-    if (target != lastCommunicationSocket)
-        lastCommunicationSocket.setSockInfo(target);
+    // если отправили данные новому сокету, обновляем информацию об этом (как последний набранный номер)
+    if (target != lastCommunicationSocket) // сравнение по значению, адрес копируется только при смене получателя
+        lastCommunicationSocket = target;
 
     return result;
 }
 
 /// <summary>
-///        ,       
+/// Метод отправки данных в сеть без предварительного соединения
+/// </summary>
+/// <param name="buffer"> - область с данными для отправки </param>
+/// <param name="target"> - информация о сокете приемнике </param>
+/// <returns> коды возврата аналогичны SendTo(buffer, endpoint) </returns>
+int network::UDP_socket_t::SendTo(const std::string& buffer, const sockInfo_t& target)
+{
+    return SendTo(buffer, target.GetEndpoint());
+}
+
+/// <summary>
+/// Метод отправки данных в сеть без предварительного соединения, отправка предыдущему сокету с которым было взаимодействие
 /// </summary>
-/// <param name="buffer"> -      </param>
-/// <returns> 0 -   ;
-///         N>0 -  N ;
-///          -1 -  ;
-///          -2 -    MTU    
-///          -3 -      ( ) </returns>
+/// <param name="buffer"> - область с данными для отправки </param>
+/// <returns> 0 - отправлено все сообщение;
+///         N>0 - отправлено N байт;
+///          -1 - системная ошибка;
+///          -2 - размер сообщения больше MTU или сокет не валидный
+///          -3 - сокет не готов к отправке (неблокирующий сокет) </returns>
 int network::UDP_socket_t::SendTo(const std::string& buffer)
 {
-    return SendTo(buffer, lastCommunicationSocket); //       
+    return SendTo(buffer, lastCommunicationSocket); // отправка предыдущему сокету с которым было взаимодействие
 }
 
 /// <summary>
-///        
+/// Метод отправки данных в сеть без предварительного соединения
 /// </summary>
-/// <param name="buffer"> -      </param>
-/// <param name="ip"> - IP    "..." </param>
-/// <param name="port"> -   </param>
-/// <returns> 0 -   ;
-///         N>0 -  N ;
-///          -1 -  ;
-///          -2 -    MTU    
-///          -3 -      ( ) </returns>
+/// <param name="buffer"> - область с данными для отправки </param>
+/// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+/// <param name="port"> - номер порта </param>
+/// <returns> 0 - отправлено все сообщение;
+///         N>0 - отправлено N байт;
+///          -1 - системная ошибка;
+///          -2 - размер сообщения больше MTU или сокет не валидный
+///          -3 - сокет не готов к отправке (неблокирующий сокет) </returns>
 int network::UDP_socket_t::SendTo(const std::string& buffer, std::string ip, unsigned short port)
 {
-    if (lastCommunicationSocket.setSockInfo(ip, port)) //    ,   
-        return SendTo(buffer); // 
+    if (lastCommunicationSocket.Set(ip.c_str(), port)) // задаем информацию о сокете, если все успешно
+        return SendTo(buffer); // оправляем
     else return -1;
 }
 
 /// <summary>
-///        
+/// Метод приема данных из сети без предварительного соединения
 /// </summary>
-/// <param name="buffer"> -     </param>
-/// <param name="str_EndOfMessege"> -    () </param>
-/// <param name="sizeMsg"> -    () </param>
-/// <returns>   0 -    ;
-///             N>0 -  N-;
-///             -1 -  ;
-///             -2 -      ;
-///             -3 -    ();</returns>
+/// <param name="buffer"> - буфер с принятыми данными </param>
+/// <param name="str_EndOfMessege"> - признак конца сообщения (опционально) </param>
+/// <param name="sizeMsg"> - ожидаемы размер сообщения (опционально) </param>
+/// <returns>   0 - все сообщение принято успешно;
+///             N>0 - принято N-байт;
+///             -1 - системная ошибка;
+///             -2 - соеднинение закрыто или сокет не валидный;
+///             -3 - сокет не готов (неблокирующий);</returns>
 int network::UDP_socket_t::RecvFrom(std::string& buffer, const std::string str_EndOfMessege, const size_t sizeMsg)
 {
     int result = -1;
 
     if (CheckValidSocket(false))
     {
-        buffer.clear(); //  
-        std::string tempStr(2048, '\0'); //       
-        socklen_t SizeAddr = lastCommunicationSocket.SizeAddr(); //   Addr
-        //  recvfrom      
-        int recvSize = recvfrom(Socket, &tempStr[0], tempStr.size(), 0, lastCommunicationSocket.setSockAddr(), &SizeAddr);
+        buffer.clear(); // готовим буфер
+        arenaString_t tempStr(2048, '\0', tickArena_t::Local().Resource()); // временная строка фиксированного размера для приема данных, на арене такта
+        socklen_t SizeAddr = endpoint_t::Capacity(); // размер структуры Addr
+        // Функция recvfrom получает датаграмму и сохраняет исходный адрес
+        int recvSize = recvfrom(Socket, &tempStr[0], tempStr.size(), 0, lastCommunicationSocket.Addr(), &SizeAddr);
 
         if (recvSize > 0)
-        { //   
-            buffer.assign(tempStr.c_str()); //   '\0'   
-            DEBUG_TRACE(logger, "recvfrom: " + tempStr)
+        { // если результат положителен
+            buffer.assign(tempStr.data(), recvSize); // берем только принятые байты
+            DEBUG_TRACE(logger, "recvfrom: " + buffer);
 
-                bool EOM = str_EndOfMessege.empty() && (sizeMsg == 0);// EndOfMessege   
+            bool EOM = str_EndOfMessege.empty() && (sizeMsg == 0);// EndOfMessege признак конца сообщения
             if (!str_EndOfMessege.empty())
-            { //   EOM
-                int pos = buffer.size() - str_EndOfMessege.size(); //     
-                if (pos >= 0) //   
-                    EOM = (buffer.rfind(str_EndOfMessege) == pos); //     
+            { // если задан EOM, ищем его в датаграмме (датаграммы независимы, состояние поиска не переносится)
+                if (scanner.Delimiter() != str_EndOfMessege)
+                    scanner.SetDelimiter(str_EndOfMessege);
+                scanner.Reset();
+                v_bounds.clear();
+                EOM = scanner.Scan(buffer.data(), buffer.size(), v_bounds) > 0;
             }
-            if (sizeMsg != 0) //    
-                EOM |= (buffer.size() >= sizeMsg); // ,      
+            if (sizeMsg != 0) // если задан размер сообщения
+                EOM |= (buffer.size() >= sizeMsg); // проверяем, не все ли мы уже получили
 
-            result = EOM ? 0 : recvSize; //   ,  0,  -  
+            result = EOM ? 0 : recvSize; // если получили все, то 0, иначе кол-во полученных байт
 
-            lastCommunicationSocket.UpdateSockInfo(); //    setSockAddr()
+            lastCommunicationSocket.Fit(); // вызвваем после перезаписи Addr()
         }
         else if (recvSize < 0)
-        { //   ,         
+        { // если появилась ошибка, проверяем не связана ли она с блокировкой неблокирующего сокета
             if (GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY && nonBlock)
                 result = -3;
             else
                 logger.doLog("recfrom fail ", GetError());
         }
         else
-            result = -2; //  
+            result = -2; // соединение закрыто
     }
     else
         result = -2;
@@ -1011,71 +2050,151 @@ int network::UDP_socket_t::RecvFrom(std::string& buffer, const std::string str_E
 }
 
 /// <summary>
-///           (/ )
+/// метод возврата информации о сокете с которым происходило последнее взаимодействие (отправка/прием данных)
 /// </summary>
-/// <returns>       (/ ) </returns>
-network::sockInfo_t network::UDP_socket_t::GetLastCommunication() const
+/// <returns> сокет с которым происходило последнее взаимодействие (отправка/прием данных) </returns>
+const network::endpoint_t& network::UDP_socket_t::GetLastCommunication() const
 {
     return lastCommunicationSocket;
 }
 
 /// <summary>
-///   MTU
+/// Конструктор
+/// </summary>
+/// <param name="logger"> - объект для логгирования </param>
+network::wakeup_t::wakeup_t(log_t& logger) : socket_t(AF_INET, SOCK_DGRAM, 0, logger), b_pending(false)
+{
+    endpoint_t local;
+    local.Set("127.0.0.1", 0); // порт выбирает система
+    if (!CheckValidSocket() || bind(Socket, local.Addr(), local.Size()) != 0 || !UpdateLocalInfo())
+        logger.doLog("wakeup_t: bind fail", GetError());
+    // соединяем сокет с его же адресом: чужие датаграммы не принимаются, send() не требует адреса
+    else if (connect(Socket, getSockAddr(), SizeAddr()) != 0)
+        logger.doLog("wakeup_t: connect fail", GetError());
+    setNonBlock();
+}
+
+/// <summary>
+/// Метод пробуждения потока владельца
+/// </summary>
+void network::wakeup_t::Notify()
+{
+    if (!b_pending.exchange(true)) // владелец еще не проснулся от прошлой датаграммы - новая не нужна
+    {
+        char byte = 0;
+        send(Socket, &byte, 1, 0); // буфер полон - значит, владелец и так проснется
+    }
+}
+
+/// <summary>
+/// Метод сброса пробуждения, вызывается владельцем до проверки очередей
+/// </summary>
+void network::wakeup_t::Drain()
+{
+    b_pending.store(false); // до чтения: Notify() после этой точки отправит новую датаграмму
+    char buf[64];
+    while (recv(Socket, buf, sizeof(buf), 0) > 0)
+        ;
+}
+
+/// <summary>
+/// метод возврата MTU
 /// </summary>
-/// <returns>    </returns>
+/// <returns> максимальный размер сообщения </returns>
 unsigned int network::UDP_socket_t::MTU() const
 {
     return u32_MTU;
 }
 
 /// <summary>
-///       
+/// метод добавления сокета в один из списков
 /// </summary>
-/// <param name="m_sock"> -     </param>
-/// <param name="socket"> -    </param>
-/// <returns> 1 -   </returns>
-bool network::NonBlockSocket_manager_t::addSocket(std::unordered_map<int, std::weak_ptr<socket_t>>& m_sock, const std::weak_ptr<socket_t>& socket)
+/// <param name="m_sock"> - ассоциативный массив для добавления </param>
+/// <param name="socket"> - сокет на добавление </param>
+/// <param name="m_handler"> - обработчики списка (nullptr - список без обработчиков) </param>
+/// <returns> 1 - сокет добавлен </returns>
+bool network::NonBlockSocket_manager_t::addSocket(std::unordered_map<int, std::weak_ptr<socket_t>>& m_sock, const std::weak_ptr<socket_t>& socket, std::unordered_map<int, std::shared_ptr<handler_t>>* m_handler)
 {
     bool result = false;
     if (auto ptr = socket.lock())
-        if (ptr->CheckValidSocket()) //  ?
-            if (ptr->setNonBlock()) //   
-                if (result = m_sock.find(ptr->getSocket()) == m_sock.end()) //      
+        if (ptr->CheckValidSocket()) // сокет валидный?
+            if (ptr->setNonBlock()) // если сокет неблокирующий
+            {
+                auto it = m_sock.find(ptr->getSocket());
+                if (it != m_sock.end() && it->second.expired())
+                {   // прежний сокет с этим дескриптором уничтожен без удаления: его запись и обработчик - не для нового
+                    if (m_handler)
+                        deleteHandler(*m_handler, it->first);
+                    m_sock.erase(it);
+                    it = m_sock.end();
+                }
+                if (result = it == m_sock.end()) // и его еще нет в списках
                 {
-                    m_sock[ptr->getSocket()] = socket; //  
-                    b_change = true; //  ,   pollfd
+                    m_sock[ptr->getSocket()] = socket; // добавляем его
+                    b_change = true; // произошли изменения, нужно менять pollfd
                 }
+            }
 
     return result;
 }
 /// <summary>
-///     
+/// Метод удаления сокета из списков
 /// </summary>
-/// <param name="m_sock"> -     </param>
-/// <param name="socket"> -    </param>
-/// <returns> 1 -   </returns>
+/// <param name="m_sock"> - ассоциативный массив для добавления </param>
+/// <param name="socket"> - сокет на удаление </param>
+/// <returns> 1 - сокет удален </returns>
 bool network::NonBlockSocket_manager_t::deleteSocket(std::unordered_map<int, std::weak_ptr<socket_t>>& m_sock, const std::weak_ptr<socket_t>& socket)
 {
     bool result = false;
-    //       ?   ,    ,      
+    // нужно ли делать сокет блокирующим после удаления? по идее нет, удалили от сюда сокет, можем его добавить в другой менеджер
     if (auto ptr = socket.lock())
-        if (result = m_sock.find(ptr->getSocket()) != m_sock.end()) //      
+        if (result = m_sock.find(ptr->getSocket()) != m_sock.end()) // если такой сокет есть в списке
         {
-            m_sock.erase(ptr->getSocket()); //  
-            b_change = true; //  ,   pollfd
+            m_sock.erase(ptr->getSocket()); // удаляем его
+            b_change = true; // произошли изменения, нужно менять pollfd
         }
 
     return result;
 }
 
+/// <summary>
+/// Метод удаления обработчика сокета. Обработчик очищается, чтобы его копия в v_handler больше не вызывалась
+/// </summary>
+/// <param name="m_handler"> - обработчики списка </param>
+/// <param name="fd"> - дескриптор сокета </param>
+void network::NonBlockSocket_manager_t::deleteHandler(std::unordered_map<int, std::shared_ptr<handler_t>>& m_handler, int fd)
+{
+    auto it = m_handler.find(fd);
+    if (it != m_handler.end())
+    {
+        *it->second = nullptr; // Work() мог уже собрать события этого такта
+        m_handler.erase(it);
+    }
+}
+
+/// <summary>
+/// Метод привязки обработчика к сокету: после уничтожения сокета обработчик не вызывается,
+/// даже если события для него уже собраны в текущем Work()
+/// </summary>
+/// <param name="socket"> - сокет </param>
+/// <param name="handler"> - обработчик готовности </param>
+/// <returns> обработчик для списка </returns>
+std::shared_ptr<network::NonBlockSocket_manager_t::handler_t> network::NonBlockSocket_manager_t::BindHandler(const std::weak_ptr<socket_t>& socket, handler_t handler)
+{
+    return std::make_shared<handler_t>([socket, handler = std::move(handler)]()
+        {
+            if (!socket.expired())
+                handler();
+        });
+}
 
 /// <summary>
-///    pollfd
+/// Метод обновления структуры pollfd
 /// </summary>
 void network::NonBlockSocket_manager_t::UpdatePollfd()
 {
-    //    
-    unsigned countNullptr = 0; //   
+    // считаем количество нулевых указателей
+    unsigned countNullptr = 0; // счетчик нулевых указателей
     for (auto it : m_senderSocket) 
         if (it.second.expired())
             ++countNullptr;
@@ -1090,45 +2209,59 @@ void network::NonBlockSocket_manager_t::UpdatePollfd()
             ++countNullptr;
 
     if (b_change || countNullptr > 0)
-    { //            
+    { // если были изменения в списках сокетов или какие то указатели стали нулевыми
         b_change = false;
-        size_t size = m_senderSocket.size() + m_readerSocket.size() + m_serverSocket.size() + m_clientSocket.size() - countNullptr; //    pollfd
-        v_fds.clear(); //    pollfd
+        size_t size = m_senderSocket.size() + m_readerSocket.size() + m_serverSocket.size() + m_clientSocket.size() - countNullptr; // размер массива структур pollfd
+        v_fds.clear(); // готовим массив структур pollfd
         v_fds.resize(size);
+        v_handler.clear(); // обработчики - в том же порядке
+        v_handler.resize(size);
 
-        size_t indx = 0; //      pollfd
+        size_t indx = 0; // индекс для обхода массива структур pollfd
         std::unordered_map<int, std::weak_ptr<socket_t>>::iterator iter_sender = m_senderSocket.begin(); 
         std::unordered_map<int, std::weak_ptr<socket_t>>::iterator iter_reader = m_readerSocket.begin(); 
         std::unordered_map<int, std::weak_ptr<socket_t>>::iterator iter_server = m_serverSocket.begin();
         std::unordered_map<int, std::weak_ptr<socket_t>>::iterator iter_client = m_clientSocket.begin();
-        //      pollfd
+        // цикл для обхода массива структур pollfd
         while (indx < size)
         {
-            if (iter_sender != m_senderSocket.end()) //  
+            if (iter_sender != m_senderSocket.end()) // заносим отправителей
             {
-                if (auto ptr = iter_sender->second.lock()) //   
+                if (auto ptr = iter_sender->second.lock()) // если указатель валидный
                 {
-                    v_fds[indx].fd = ptr->getSocket(); //  
-                    v_fds[indx].events = POLLOUT; //  
-                    v_fds[indx++].revents = 0; //  
+                    auto handler = m_senderHandler.find(iter_sender->first);
+                    if (handler != m_senderHandler.end())
+                        v_handler[indx] = handler->second;
+                    v_fds[indx].fd = ptr->getSocket(); // дескриптор сокета
+                    v_fds[indx].events = POLLOUT; // ожидаемое событие
+                    v_fds[indx++].revents = 0; // произошедшее событие
                     ++iter_sender;
                 }
                 else
-                    iter_sender = m_senderSocket.erase(iter_sender); //    - 
+                {
+                    deleteHandler(m_senderHandler, iter_sender->first);
+                    iter_sender = m_senderSocket.erase(iter_sender); // если указатель нулевой - удаляем
+                }
             }
-            else if (iter_reader != m_readerSocket.end()) //  
+            else if (iter_reader != m_readerSocket.end()) // заносим читателей
             {
                 if (auto ptr = iter_reader->second.lock())
                 {
+                    auto handler = m_readerHandler.find(iter_reader->first);
+                    if (handler != m_readerHandler.end())
+                        v_handler[indx] = handler->second;
                     v_fds[indx].fd = ptr->getSocket();
                     v_fds[indx].events = POLLIN;
                     v_fds[indx++].revents = 0;
                     ++iter_reader;
                 }
                 else
+                {
+                    deleteHandler(m_readerHandler, iter_reader->first);
                     iter_reader = m_readerSocket.erase(iter_reader);
+                }
             }
-            else if (iter_server != m_serverSocket.end()) //  
+            else if (iter_server != m_serverSocket.end()) // заносим сервера
             {
                 if (auto ptr = iter_server->second.lock())
                 {
@@ -1140,7 +2273,7 @@ void network::NonBlockSocket_manager_t::UpdatePollfd()
                 else
                     iter_server = m_serverSocket.erase(iter_server);
             }
-            else if (iter_client != m_clientSocket.end()) //  
+            else if (iter_client != m_clientSocket.end()) // заносим клиентов
             {
                 if (auto ptr = iter_client->second.lock())
                 {
@@ -1161,123 +2294,155 @@ void network::NonBlockSocket_manager_t::UpdatePollfd()
             }
         }
 
-    } //    ,    
+    } // если изменений не было, просто обнуляем произошедшие события
     else
         for (size_t indx = 0; indx < v_fds.size(); ++indx)
             v_fds[indx].revents = 0;
 
 }
 /// <summary>
-///    
+/// функция мультиплексированя неблокирующих сокетов
 /// </summary>
-/// <param name="timeOut"> -  timeout    </param>
-/// <returns> -1 -  ; 0 -      ; N>0 - -  </returns>
+/// <param name="timeOut"> - время timeout для функции мультиплексирования </param>
+/// <returns> -1 - системная ошибка; 0 - вышел таймаут и событий не произошло; N>0 - кол-во событий </returns>
 int network::NonBlockSocket_manager_t::Poll(int timeOut)
 {
 #ifdef __WIN32__
-    return WSAPoll(&v_fds[0], v_fds.size(), timeOut);// WSAPoll      revents  WSAPOLLFD
+    return WSAPoll(&v_fds[0], v_fds.size(), timeOut);//Функция WSAPoll возвращает состояние сокета в элементе revents структуры WSAPOLLFD
 #else
     return poll(&v_fds[0], v_fds.size(), timeOut);
 #endif
 }
 
 /// <summary>
-///    
+/// Конструктор с одним параметром
 /// </summary>
-/// <param name="logger"> -    </param>
+/// <param name="logger"> - объект для логиирования </param>
 network::NonBlockSocket_manager_t::NonBlockSocket_manager_t(log_t& logger) : RAII_OSsock(logger), b_change(false), logger(logger)
 {}
 /// <summary>
-///    
+/// Конструктор с двумя параметрами
 /// </summary>
-/// <param name="size"> -     </param>
-/// <param name="logger"> -    </param>
+/// <param name="size"> - предварительное количество наблюдаемых сокетов </param>
+/// <param name="logger"> - объект для логирования </param>
 network::NonBlockSocket_manager_t::NonBlockSocket_manager_t(int size, log_t& logger) : RAII_OSsock(logger), b_change(false), logger(logger)
 {
     v_fds.reserve(size);
 }
 /// <summary>
-///   
+/// метод добавления отправителя
+/// </summary>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет добавлен </returns>
+bool network::NonBlockSocket_manager_t::AddSender(const std::weak_ptr<socket_t>& socket) // добавляем сокет
+{
+    return addSocket(m_senderSocket, socket, &m_senderHandler);
+}
+/// <summary>
+/// метод добавления отправителя с обработчиком готовности. Готовность такого сокета не попадает в GetReadySender()
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
-bool network::NonBlockSocket_manager_t::AddSender(const std::weak_ptr<socket_t>& socket) //  
+/// <param name="socket"> - целевой сокет </param>
+/// <param name="handler"> - обработчик готовности к отправке </param>
+/// <returns> 1 - сокет добавлен </returns>
+bool network::NonBlockSocket_manager_t::AddSender(const std::weak_ptr<socket_t>& socket, handler_t handler)
 {
-    return addSocket(m_senderSocket, socket);
+    bool result = addSocket(m_senderSocket, socket, &m_senderHandler);
+    if (result)
+        if (auto ptr = socket.lock())
+            m_senderHandler[ptr->getSocket()] = BindHandler(socket, std::move(handler));
+    return result;
 }
 /// <summary>
-///   
+/// метод удаления отправителя
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет удален </returns>
 bool network::NonBlockSocket_manager_t::deleteSender(const std::weak_ptr<socket_t>& socket)
 {
+    if (auto ptr = socket.lock())
+        deleteHandler(m_senderHandler, ptr->getSocket());
     return deleteSocket(m_senderSocket, socket);
 }
 /// <summary>
-///   
+/// метод добавления читателя
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет добавлен </returns>
 bool network::NonBlockSocket_manager_t::AddReader(const std::weak_ptr<socket_t>& socket)
 {
-    return addSocket(m_readerSocket, socket);
+    return addSocket(m_readerSocket, socket, &m_readerHandler);
+}
+/// <summary>
+/// метод добавления читателя с обработчиком готовности. Готовность такого сокета не попадает в GetReadyReader()
+/// </summary>
+/// <param name="socket"> - целевой сокет </param>
+/// <param name="handler"> - обработчик готовности к приему </param>
+/// <returns> 1 - сокет добавлен </returns>
+bool network::NonBlockSocket_manager_t::AddReader(const std::weak_ptr<socket_t>& socket, handler_t handler)
+{
+    bool result = addSocket(m_readerSocket, socket, &m_readerHandler);
+    if (result)
+        if (auto ptr = socket.lock())
+            m_readerHandler[ptr->getSocket()] = BindHandler(socket, std::move(handler));
+    return result;
 }
 /// <summary>
-///   
+/// метод удаления читателя
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет удален </returns>
 bool network::NonBlockSocket_manager_t::deleteReader(const std::weak_ptr<socket_t>& socket)
 {
+    if (auto ptr = socket.lock())
+        deleteHandler(m_readerHandler, ptr->getSocket());
     return deleteSocket(m_readerSocket, socket);
 }
 
 /// <summary>
-///   
+/// метод добавления сервера
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет добавлен </returns>
 bool network::NonBlockSocket_manager_t::AddServer(const std::weak_ptr<socket_t>& socket)
 {
     return addSocket(m_serverSocket, socket);
 }
 
 /// <summary>
-///   
+/// метод удаления сервера
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет удален </returns>
 bool network::NonBlockSocket_manager_t::deleteServer(const std::weak_ptr<socket_t>& socket)
 {
     return deleteSocket(m_serverSocket, socket);
 }
 
 /// <summary>
-///   
+/// метод добавления клиента
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет добавлен </returns>
 bool network::NonBlockSocket_manager_t::AddClient(const std::weak_ptr<socket_t>& socket)
 {
     return addSocket(m_clientSocket, socket);
 }
 
 /// <summary>
-///   
+/// метод удаления клиента
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет удален </returns>
 bool network::NonBlockSocket_manager_t::deleteClient(const std::weak_ptr<socket_t>& socket)
 {
     return deleteSocket(m_clientSocket, socket);
 }
 
 /// <summary>
-///      
+/// метод проверки готовности отправителя к отправке
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет готов </returns>
 bool network::NonBlockSocket_manager_t::GetReadySender(const std::weak_ptr<socket_t>& socket) const
 {
     bool result = false;
@@ -1287,10 +2452,10 @@ bool network::NonBlockSocket_manager_t::GetReadySender(const std::weak_ptr<socke
 }
 
 /// <summary>
-///      
+/// метод проверки готовности читателя к приему
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - сокет готов </returns>
 bool network::NonBlockSocket_manager_t::GetReadyReader(const std::weak_ptr<socket_t>& socket) const
 {
     bool result = false;
@@ -1300,10 +2465,10 @@ bool network::NonBlockSocket_manager_t::GetReadyReader(const std::weak_ptr<socke
 }
 
 /// <summary>
-///        
+/// метод проверки наличия запроса на подключения у сервера
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - есть подключение </returns>
 bool network::NonBlockSocket_manager_t::GetReadyServer(const std::weak_ptr<socket_t>& socket) const
 {
     bool result = false;
@@ -1313,10 +2478,10 @@ bool network::NonBlockSocket_manager_t::GetReadyServer(const std::weak_ptr<socke
 }
 
 /// <summary>
-///        
+/// метод проверки подтверждения подключения к серверу у клиента
 /// </summary>
-/// <param name="socket"> -   </param>
-/// <returns> 1 -   </returns>
+/// <param name="socket"> - целевой сокет </param>
+/// <returns> 1 - есть подключение </returns>
 bool network::NonBlockSocket_manager_t::GetReadyClient(const std::weak_ptr<socket_t>& socket) const
 {
     bool result = false;
@@ -1327,36 +2492,139 @@ bool network::NonBlockSocket_manager_t::GetReadyClient(const std::weak_ptr<socke
 
 
 /// <summary>
-///    
+/// основной метод работы мультиплесора
 /// </summary>
-/// <param name="timeOut"> -    </param>
-/// <returns> 1 -     </returns>
+/// <param name="timeOut"> - время ожидания мультиплесора </param>
+/// <returns> 1 - принято хотябы одно событие </returns>
 bool network::NonBlockSocket_manager_t::Work(const int timeOut)
-{//    
+{// очистка мапов готовых сокетов
     m_readySender.clear();
     m_readyReader.clear();
     m_readyServer.clear();
     m_readyClient.clear();
-    //   pollfd
+    // обновление структуры pollfd
     UpdatePollfd();
     size_t size = v_fds.size();
-    //   
-    int resPoll = Poll(timeOut);
-    if (resPoll > 0) //   
-    {  //    pollfd
-        for (size_t indx = 0; indx < size; ++indx)
-            if (v_fds[indx].revents & POLLIN && m_readerSocket.find(v_fds[indx].fd) != m_readerSocket.end()) //    
+    if (cpu >= 0 && !b_pinned) // привязываем поток, в котором крутится цикл событий
+        b_pinned = PinThread();
+    // вызываем фукцию мультеплексирования
+    int resPoll = 0;
+    clock_t::time_point start = clock_t::now();
+    if (spinBudget.count() > 0 && timeOut != 0)
+    {   // активный опрос без переключения контекста
+        clock_t::time_point deadline = start + spinBudget;
+        clock_t::time_point now;
+        do {
+            resPoll = Poll(0);
+            now = clock_t::now();
+        } while (resPoll == 0 && now < deadline);
+        waitStat.spin += std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+
+        if (resPoll != 0)
+        {
+            ++waitStat.spinHits;
+            spinBudget = spinLimit; // события идут часто, опрос окупается
+        }
+        else
+        {   // холостой опрос: уменьшаем бюджет и засыпаем на остаток таймаута
+            // нижний предел не меньше 1 мкс: при малом --spin бюджет не должен обнулиться и выключить опрос навсегда
+            spinBudget = (std::max)(spinBudget / 2, (std::max)(spinLimit / 16, std::chrono::microseconds(1)));
+            int rest = timeOut;
+            if (timeOut > 0)
+                rest = (std::max)(0, timeOut - static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count()));
+            start = now;
+            resPoll = Poll(rest);
+            ++waitStat.sleeps;
+            waitStat.sleep += std::chrono::duration_cast<std::chrono::microseconds>(clock_t::now() - start);
+        }
+    }
+    else
+    {
+        resPoll = Poll(timeOut);
+        ++waitStat.sleeps;
+        waitStat.sleep += std::chrono::duration_cast<std::chrono::microseconds>(clock_t::now() - start);
+    }
+    bool b_handled = false; // вызван хотя бы один обработчик
+    if (resPoll > 0) // если результат положителен
+    {  // по структурам pollfd, пока не разобраны все события
+        int events = 0;
+        for (size_t indx = 0; indx < size && events < resPoll; ++indx)
+            if (v_fds[indx].revents == 0)
+                continue;
+            else if (++events, v_handler[indx]) // сокет с обработчиком: вызываем сразу, без мапов готовых сокетов
+            {
+                std::shared_ptr<handler_t> handler = v_handler[indx]; // обработчик может перестроить v_handler
+                if (*handler)
+                {
+                    (*handler)();
+                    b_handled = true;
+                }
+            }
+            else if (v_fds[indx].revents & POLLIN && m_readerSocket.find(v_fds[indx].fd) != m_readerSocket.end()) // нашли событие на читателя
                 m_readyReader[v_fds[indx].fd] = m_readerSocket[v_fds[indx].fd];
-            else if (v_fds[indx].revents & POLLOUT && m_senderSocket.find(v_fds[indx].fd) != m_senderSocket.end()) //    
+            else if (v_fds[indx].revents & POLLOUT && m_senderSocket.find(v_fds[indx].fd) != m_senderSocket.end()) // нашли событие на отправителя
                 m_readySender[v_fds[indx].fd] = m_senderSocket[v_fds[indx].fd];
-            else if (v_fds[indx].revents & POLLIN && m_serverSocket.find(v_fds[indx].fd) != m_serverSocket.end()) //    
+            else if (v_fds[indx].revents & POLLIN && m_serverSocket.find(v_fds[indx].fd) != m_serverSocket.end()) // нашли событие на сервер
                 m_readyServer[v_fds[indx].fd] = m_serverSocket[v_fds[indx].fd];
-            else if (v_fds[indx].revents & POLLOUT && m_clientSocket.find(v_fds[indx].fd) != m_clientSocket.end()) //    
+            else if (v_fds[indx].revents & (POLLOUT | POLLERR | POLLHUP) && m_clientSocket.find(v_fds[indx].fd) != m_clientSocket.end()) // нашли событие на клиента (неудачное подключение тоже событие)
                 m_readyClient[v_fds[indx].fd] = m_clientSocket[v_fds[indx].fd];
     }
-    else if (resPoll < 0) //  
+    else if (resPoll < 0) // системная ошибка
         logger.doLog("poll error", GetError());
 
-    return !m_readySender.empty() || !m_readyReader.empty() || !m_readyServer.empty() || !m_readyClient.empty(); //      ?
+    return b_handled || !m_readySender.empty() || !m_readyReader.empty() || !m_readyServer.empty() || !m_readyClient.empty(); // хоть что то добавили в списки?
+}
+
+/// <summary>
+/// Метод включения режима "опрос, затем ожидание": Work() сначала опрашивает сокеты с нулевым таймаутом
+/// в течение бюджета, и только потом блокируется в poll. Бюджет адаптивный: после холостых опросов
+/// уменьшается (до 1/16 заданного), после попадания восстанавливается
+/// </summary>
+/// <param name="spin"> - бюджет активного опроса, 0 - режим выключен </param>
+/// <param name="cpu"> - ядро процессора для потока, вызывающего Work(); -1 - без привязки </param>
+void network::NonBlockSocket_manager_t::SetSpin(std::chrono::microseconds spin, int cpu)
+{
+    spinLimit = spinBudget = spin;
+    this->cpu = cpu;
+    b_pinned = false;
+}
+
+/// <summary>
+/// Метод возврата статистики ожидания событий
+/// </summary>
+/// <returns> статистика ожидания </returns>
+const network::NonBlockSocket_manager_t::waitStat_t& network::NonBlockSocket_manager_t::GetWaitStat() const
+{
+    return waitStat;
 }
 
+/// <summary>
+/// Метод привязки текущего потока к ядру процессора
+/// </summary>
+/// <returns> 1 - поток привязан </returns>
+bool network::NonBlockSocket_manager_t::PinThread()
+{
+    bool result = false;
+#ifdef __WIN32__
+    if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8) && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu))
+        result = true;
+    else
+        logger.doLog("NonBlockSocket_manager_t - SetThreadAffinityMask ", GetLastError());
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int error = EINVAL; // CPU_SET() за пределами набора пишет мимо него
+    if (cpu < CPU_SETSIZE)
+    {
+        CPU_SET(cpu, &set);
+        error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (error == 0)
+        result = true;
+    else
+        logger.doLog("NonBlockSocket_manager_t - pthread_setaffinity_np ", error);
+#endif
+    if (!result)
+        cpu = -1; // не повторяем попытку на каждом такте
+    return result;
+}
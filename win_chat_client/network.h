@@ -8,8 +8,14 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <type_traits>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 
 #include "log.h"
+#include "scanner.h"
 
 #ifdef __WIN32__
 
@@ -20,10 +26,12 @@
 #endif // !WIN32_LEAN_AND_MEAN
 
 #include <Windows.h>
-#include <WinSock2.h> //  ,        
-#include <WS2tcpip.h> //  ,     ,     TCP/IP (    ,    ..)
+#include <WinSock2.h> // заголовочный файл, содержащий актуальные реализации функций для работы с сокетами
+#include <WS2tcpip.h> // заголовочный файл, который содержит различные программные интерфейсы, связанные с работой протокола TCP/IP (переводы различных данных в формат, понимаемый протоколом и т.д.)
 #include <iphlpapi.h>
-#pragma comment(lib, "Ws2_32.lib") //       : ws2_32.dll.     
+#include <io.h> // _read, _lseeki64 для SendFile
+#include <afunix.h> // sockaddr_un для локальных сокетов AF_UNIX
+#pragma comment(lib, "Ws2_32.lib") // прилинковать к приложению динамическую библиотеку ядра ОС: ws2_32.dll. Делаем это через директиву компилятору
 #define CLOSE_SOCKET(socket) closesocket(socket)
 #define SHUT SD_BOTH
 
@@ -33,9 +41,14 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/in.h>//
+#include <netinet/tcp.h> // опции TCP (TCP_NODELAY, TCP_QUICKACK, TCP_CORK...)
 #include <poll.h>
 #include <unistd.h>//
 #include <fcntl.h>
+#include <pthread.h> // привязка потока к ядру процессора
+#include <sched.h>
+#include <sys/sendfile.h> // передача файла в сокет без копирования
+#include <sys/un.h> // sockaddr_un для локальных сокетов AF_UNIX
 #include <errno.h>
 #include <string.h>
 #define SOCKET int
@@ -46,692 +59,1315 @@
 #endif
 
 /// <summary>
-///       
+/// простанство имен классов для работы с сетью
 /// </summary>
 namespace network
 {
     /// <summary>
-    ///     
-    ///   RAII
+    /// Структура адреса сокета (IPv4, IPv6 либо путь локального сокета AF_UNIX) на основе sockaddr_storage.
+    /// Тривиально копируемая, не выделяет память, сравнивается по значению.
+    /// Текстовое представление адреса формируется при первом запросе и запоминается
+    /// </summary>
+    struct endpoint_t
+    {
+        /// <summary>
+        /// Метод очистки адреса
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Метод установки адреса из текстового представления
+        /// </summary>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" либо IPv6 </param>
+        /// <param name="port"> - номер порта </param>
+        /// <returns> true - адрес распознан </returns>
+        bool Set(const char* ip, unsigned short port);
+
+        /// <summary>
+        /// Метод установки адреса локального сокета AF_UNIX: клиент и сервер на одном узле обходятся без стека TCP
+        /// </summary>
+        /// <param name="path"> - путь к файлу сокета </param>
+        /// <returns> true - путь помещается в адрес </returns>
+        bool SetPath(const char* path);
+
+        /// <summary>
+        /// Метод установки адреса из системной структуры
+        /// </summary>
+        /// <param name="addr"> - структура описывающая сокет </param>
+        /// <param name="size"> - размер структуры </param>
+        /// <returns> true - адрес установлен </returns>
+        bool Set(const sockaddr* addr, socklen_t size);
+
+        /// <summary>
+        /// Метод обновления после записи адреса системным вызовом через Addr() (accept, recvfrom, getsockname):
+        /// размер выставляется по семейству адресов, кэш текста сбрасывается
+        /// </summary>
+        void Fit();
+
+        /// <summary>
+        /// Метод возврата указателя на системную структуру адреса
+        /// </summary>
+        /// <returns> указатель на структуру описывающую сокет </returns>
+        sockaddr* Addr();
+
+        /// <summary>
+        /// Метод возврата константного указателя на системную структуру адреса
+        /// </summary>
+        /// <returns> константный указатель на структуру описывающую сокет </returns>
+        const sockaddr* Addr() const;
+
+        /// <summary>
+        /// Метод возврата размера используемой части структуры адреса
+        /// </summary>
+        /// <returns> размер адреса </returns>
+        socklen_t Size() const;
+
+        /// <summary>
+        /// Метод возврата размера буфера адреса, передается системным вызовам, заполняющим адрес
+        /// </summary>
+        /// <returns> размер sockaddr_storage </returns>
+        static socklen_t Capacity();
+
+        /// <summary>
+        /// Метод возврата семейства адресов
+        /// </summary>
+        /// <returns> AF_INET, AF_INET6, AF_UNIX либо AF_UNSPEC для пустого адреса </returns>
+        int Family() const;
+
+        /// <summary>
+        /// Метод возврата номера порта
+        /// </summary>
+        /// <returns> номер порта, 0 - у адреса AF_UNIX порта нет </returns>
+        unsigned short Port() const;
+
+        /// <summary>
+        /// Метод возврата текстового представления адреса (без порта)
+        /// </summary>
+        /// <returns> IP адресс либо путь сокета AF_UNIX, пустая строка - адрес не задан </returns>
+        const char* Text() const;
+
+        /// <summary>
+        /// оператор сравнения по значению: семейство, адрес и порт
+        /// </summary>
+        /// <param name="rValue"> - правостороннее значение </param>
+        /// <returns> 1 - адреса равны </returns>
+        bool operator == (const endpoint_t& rValue) const;
+
+        /// <summary>
+        /// оператор сравнения
+        /// </summary>
+        /// <param name="rValue"> - правостороннее значение </param>
+        /// <returns> 1 - адреса не равны </returns>
+        bool operator != (const endpoint_t& rValue) const;
+
+        sockaddr_storage addr = {}; // адрес любого семейства
+        socklen_t size = 0; // размер используемой части addr
+        mutable bool b_text = false; // признак заполненного кэша текста
+        mutable char text[64] = {}; // кэш текстового представления адреса
+    };
+    static_assert(std::is_trivially_copyable<endpoint_t>::value, "endpoint_t must stay trivially copyable");
+
+    /// <summary>
+    /// Профили производительности сокета
+    /// </summary>
+    struct profile_t
+    {
+        static const int NONE = 0; // настройки ОС по умолчанию
+        static const int LOW_LATENCY = 1; // минимальная задержка: NODELAY, QUICKACK, малый NOTSENT_LOWAT, busy-poll
+        static const int THROUGHPUT = 2; // пропускная способность: большие буферы ядра, TCP_CORK на время пачки отправок
+
+        static const int lowatBytes = 16 * 1024; // предел неотправленных данных для LOW_LATENCY
+        static const int busyPollUs = 50; // время активного ожидания для LOW_LATENCY
+        static const int bufferBytes = 4 * 1024 * 1024; // размер буферов ядра для THROUGHPUT
+
+        /// <summary>
+        /// Метод получения профиля по имени
+        /// </summary>
+        /// <param name="name"> - имя профиля: "default", "low-latency", "throughput" </param>
+        /// <returns> профиль, -1 - имя не распознано </returns>
+        static int Parse(const std::string& name);
+    };
+
+    /// <summary>
+    /// Класс абстракции от операционной системы
+    /// Использует принцип RAII
     /// </summary>
     class RAII_OSsock
     {
     private :
 #ifdef __WIN32__
-        static WSADATA wsdata; //  WSADATA      Windows.
-        static int countWSAusers; //   
-        unsigned objectID; // ID  
+        static WSADATA wsdata; // Структура WSADATA содержит сведения о реализации сокетов Windows.
+        static int countWSAusers; // количество пользователей интерфейса
+        unsigned objectID; // ID этого объекта
 #endif
         void registration();
-    protected :
-        struct option_t //   
+    public :
+        struct option_t // опции для сокета
         {
-            static const int NON_BLOCK = 1; //  
+            static const int NON_BLOCK = 1; // неблокирующий сокет
+            static const int NO_DELAY = 2; // отключение алгоритма Нейгла (значение 1/0)
+            static const int QUICK_ACK = 3; // немедленное подтверждение принятых данных, Linux (значение 1/0)
+            static const int NOTSENT_LOWAT = 4; // предел неотправленных данных в буфере ядра, байт, Linux
+            static const int BUSY_POLL = 5; // активное ожидание данных драйвера при приеме, мкс, Linux
+            static const int SEND_BUFFER = 6; // размер буфера отправки ядра, байт
+            static const int RECV_BUFFER = 7; // размер буфера приема ядра, байт
+            static const int CORK = 8; // накопление отправляемых данных в полные сегменты, Linux (значение 1/0)
+            static const int KEEP_ALIVE = 9; // проверка простаивающего соединения ядром (значение 1/0)
+            static const int USER_TIMEOUT = 10; // предел ожидания подтверждения отправленных данных, мс (Windows - с точностью до секунды)
         };
-        struct error_t //  
+    protected :
+        struct error_t // ошибки сокета
         {
 #ifdef __WIN32__
-            static constexpr int NON_BLOCK_SOCKET_NOT_READY = WSAEWOULDBLOCK; //   ,      
+            static constexpr int NON_BLOCK_SOCKET_NOT_READY = WSAEWOULDBLOCK; // сокет не блокирующий, не готов к отправке либо приему
             static const int SOCKET_NON_CONNECTED = WSAENOTCONN;
+            static const int CONNECT_IN_PROGRESS = WSAEWOULDBLOCK; // неблокирующее подключение начато
+            static const int CONNECTION_REFUSED = WSAECONNREFUSED; // по адресу никто не слушает
+            static const int ADDRESS_IN_USE = WSAEADDRINUSE; // адрес занят другим сокетом
 #else
-            static const int NON_BLOCK_SOCKET_NOT_READY = EWOULDBLOCK; //   ,      
+            static const int NON_BLOCK_SOCKET_NOT_READY = EWOULDBLOCK; // сокет не блокирующий, не готов к отправке либо приему
             static const int SOCKET_NON_CONNECTED = ENOTCONN;
+            static const int CONNECT_IN_PROGRESS = EINPROGRESS; // неблокирующее подключение начато
+            static const int CONNECTION_REFUSED = ECONNREFUSED; // по адресу никто не слушает
+            static const int ADDRESS_IN_USE = EADDRINUSE; // адрес занят другим сокетом
 #endif
         };
         /// <summary>
-        /// 
+        /// Конструктор
         /// </summary>
-        /// <param name="logger"> --      </param>
+        /// <param name="logger"> -- ссылка на объект для логгирования </param>
         RAII_OSsock(log_t& logger);
 
         /// <summary>
-        ///  
+        /// конструктор копирования
         /// </summary>
-        /// <param name="rvalue"> --  </param>
+        /// <param name="rvalue"> -- копируемый объект</param>
         RAII_OSsock(const RAII_OSsock& rvalue);
 
         /// <summary>
-        ///  
+        /// конструктор перемещения
         /// </summary>
-        /// <param name="rvalue"> --  </param>
+        /// <param name="rvalue"> -- перемещаемый объект</param>
         /// <returns></returns>
         RAII_OSsock(RAII_OSsock&& rvalue) noexcept;
 
         /// <summary>
-        /// 
+        /// деструктор
         /// </summary>
         virtual ~RAII_OSsock();
 
         /// <summary>
-        ///     
+        /// Метод вывода номера последней ошибки
         /// </summary>
-        /// <returns>    </returns>
+        /// <returns> номер последней ошибки </returns>
         int GetError();
 
         /// <summary>
-        ///     
+        /// Метод установки опций для сокета
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <param name="option"> - </param>
-        /// <param name="logger"> -    </param>
-        /// <returns> 1 -  </returns>
-        bool setSocketOpt(SOCKET socket, int option, log_t& logger);
+        /// <param name="socket"> - дескриптор сокета </param>
+        /// <param name="option"> - опция</param>
+        /// <param name="logger"> - объект для логгированя </param>
+        /// <param name="value"> - значение опции (для опций-флагов 1 - включить, 0 - выключить) </param>
+        /// <returns> 1 - успех, 0 - ошибка либо опция не поддерживается ОС </returns>
+        bool setSocketOpt(SOCKET socket, int option, log_t& logger, int value = 1);
     protected :
         log_t& logger;
     };
 
     /// <summary>
-    ///      
+    /// класс реализует хранение информации о сокете
     /// </summary>
     class sockInfo_t : public RAII_OSsock
     {
-        friend class UDP_socket_t; //   RecvFrom
-        friend class TCP_socketServer_t; //   AddClient
-        friend class TCP_socketClient_t; //   Move
+        friend class UDP_socket_t; // для метода RecvFrom
+        friend class TCP_socketServer_t; // для метода AddClient
+        friend class TCP_socketClient_t; // для метода Move
     protected:
         /// <summary>
-        ///     .         UpdateSockInfo()
+        /// Метод перезаписи структуры описывающей сокет. После перезаписи необходимо обновить информцию о сокете вызвав UpdateSockInfo()
         /// </summary>
-        /// <returns>      </returns>
+        /// <returns> указатель на структуру описывающую сокет </returns>
         sockaddr* setSockAddr();
 
         /// <summary>
-        ///     ,    Addr  setSockAddr()
+        /// Метод обновления иноформации о сокете, вызывается после обновления Addr метоом setSockAddr()
         /// </summary>
         void UpdateSockInfo();
 
         /// <summary>
-        ///     ,    Addr
+        /// Метод обновления иноформации о сокете, вызывается после обновления Addr
         /// </summary>
-        /// <param name="ip"> IP    "..." </param>
-        /// <param name="port">   </param>
+        /// <param name="ip"> IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> номер порта </param>
         void UpdateSockInfo(std::string ip, unsigned short port);
 
     public:
         /// <summary>
-        ///    
+        /// Конструктор с одним параметром
         /// </summary>
-        /// <param name="logger"> -     </param>
+        /// <param name="logger"> - объект для логгирования ошибок </param>
         sockInfo_t(log_t& logger);
 
         /// <summary>
-        ///   2- 
+        /// Конструктор с 2-я параметрами
         /// </summary>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -   </param>
-        /// <param name="logger"> -     </param>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта </param>
+        /// <param name="logger"> - объект для логгирования ошибок </param>
         sockInfo_t(std::string ip, unsigned short port, log_t& logger);
 
         virtual ~sockInfo_t();
 
         /// <summary>
-        ///     
+        /// Метод установки информации о сокете
         /// </summary>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -  </param>
-        /// <returns> true - ; false -  </returns>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта</param>
+        /// <returns> true - успех; false - неудача </returns>
         bool setSockInfo(std::string ip, unsigned short port);
 
         /// <summary>
-        ///     
+        /// Метод установки информации о сокете
         /// </summary>
-        /// <param name="sockInfo"> -        IP </param>
+        /// <param name="sockInfo"> - структура описывающая сокет для работы с протоколами IP </param>
         /// <returns></returns>
         void setSockInfo(const sockInfo_t& sockInfo);
 
         /// <summary>
-        ///        
+        /// Метод установки информации о сокете
+        /// </summary>
+        /// <param name="endpoint"> - адрес сокета </param>
+        void setSockInfo(const endpoint_t& endpoint);
+
+        /// <summary>
+        /// Метод возврата адреса сокета без копирования
         /// </summary>
-        /// <returns>       </returns>
+        /// <returns> адрес сокета </returns>
+        const endpoint_t& GetEndpoint() const;
+
+        /// <summary>
+        /// Метод возвратата константного указателя на структуру описывающую сокет
+        /// </summary>
+        /// <returns> константный указатель на структуру описывающую сокет </returns>
         const sockaddr* getSockAddr() const;
 
         sockInfo_t GetSockInfo() const;
 
         /// <summary>
-        ///      
+        /// Метод возврата размера структуры описывающей сокет
         /// </summary>
-        /// <returns>     </returns>
+        /// <returns> размер структуры описывающей сокет </returns>
         size_t SizeAddr() const;
 
         /// <summary>
-        ///   IP
+        /// Метод возврата IP
         /// </summary>
-        /// <returns> IP    "..." </returns>
+        /// <returns> IP адресс в формате "хххх.хххх.хххх.хххх" </returns>
         std::string GetIP() const;
 
         /// <summary>
-        ///    
+        /// Метод возврата номера порта
         /// </summary>
-        /// <returns>   </returns>
+        /// <returns> номер порта </returns>
         unsigned short GetPort() const;
 
         /// <summary>
-        ///  
+        /// оператор сравнения
         /// </summary>
-        /// <param name="rValue"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="rValue"> - правостороннее значение </param>
+        /// <returns> 1 - объекты равны </returns>
         bool operator == (const sockInfo_t& rValue) const;
 
         /// <summary>
-        ///  
+        /// оператор сравнения
         /// </summary>
-        /// <param name="rValue"> -   </param>
-        /// <returns> 1 -    </returns>
+        /// <param name="rValue"> - правостороннее значение </param>
+        /// <returns> 1 - объекты не равны </returns>
         bool operator != (const sockInfo_t& rValue) const;
     protected:
-        std::pair<std::string, unsigned short> IP_port; // IP    
-        sockaddr Addr; //       
-        size_t sizeAddr; //   sockaddr
-        log_t& logger; //    
+        std::pair<std::string, unsigned short> IP_port; // IP адрес и номер порта
+        endpoint_t endpoint; // адрес сокета
+        log_t& logger; // объект для логгирования ошибок
     };
 
     /// <summary>
-    ///      
+    /// Класс реализует хранение и работу сокета
     /// </summary>
     class socket_t : public sockInfo_t
-    {// TODO   DNS    getaddrinfo(char const* node, char const* service, struct addrinfo const* hints, struct addrinfo** res)
-        friend class NonBlockSocket_manager_t; //   ,  setNonBlock
+    {
+        friend class NonBlockSocket_manager_t; // менеджер неблокирующмх сокетов, использует setNonBlock
+        friend class shmTransport_t; // передает дескрипторы общей памяти через локальный сокет
     protected:
         /// <summary>
-        ///     (     TCP)
+        /// Метод замены дескриптора сокета (для внутреннего пользования серверным сокетом TCP)
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <param name="nonBlock"> -    </param>
-        /// <returns> true -   , false -   </returns>
+        /// <param name="socket"> - дескриптор сокета </param>
+        /// <param name="nonBlock"> - флаг неблокирующего сокета </param>
+        /// <returns> true - при удачной замене, false - при неудачной </returns>
         bool SetSocket(SOCKET socket, bool nonBlock);
 
         /// <summary>
-        ///   
+        /// Метод обновления информации о локальном адресе сокета (после bind, connect, accept)
         /// </summary>
-        /// <returns> true -   </returns>
+        /// <returns> true - информация обновлена </returns>
+        bool UpdateLocalInfo();
+
+        /// <summary>
+        /// Метод закрытия сокета
+        /// </summary>
+        /// <returns> true - сокет закрыт </returns>
         bool Close();
 
         /// <summary>
-        ///   
+        /// Метод отключения сокета
         /// </summary>
         void Shutdown();
 
         /// <summary>
-        ///   ,        
-        ///   ,    ,   
-        ///     -.
-        ///        .
+        /// назначает внешний адрес, по которому его будут находить транспортные протоколы по
+        /// заданию подключающихся процессов, а также назначает порт, по которому эти
+        /// подключающиеся процессы будут идентифицировать процесс-получатель.
+        /// Предпологается что информация о привязке сокета уже записана.
         /// </summary>
-        /// <returns> true - , false -  </returns>
+        /// <returns> true - удача, false - неудача </returns>
         bool Bind();
 
         /// <summary>
-        ///   ,        
-        ///   ,    ,   
-        ///     -.
+        /// назначает внешний адрес, по которому его будут находить транспортные протоколы по
+        /// заданию подключающихся процессов, а также назначает порт, по которому эти
+        /// подключающиеся процессы будут идентифицировать процесс-получатель.
         /// </summary>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -   </param>
-        /// <returns> 1 -  </returns>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта </param>
+        /// <returns> 1 - выполнено </returns>
         bool Bind(std::string ip, unsigned short port);
 
         /// <summary>
-        ///    ,       
+        /// Метод создания нового дескриптора сокета, старый закрывается
+        /// </summary>
+        /// <param name="af"> - семейство адресов </param>
+        /// <param name="type"> - тип сокета </param>
+        /// <param name="protocol"> - тип протокола </param>
+        /// <returns> true - сокет создан </returns>
+        bool Open(int af, int type, int protocol);
+
+        /// <summary>
+        /// Контсруктор с одним параметром, для создания пустого объекта без валидного сокета
         /// </summary>
-        /// <param name="logger"> -    </param>
+        /// <param name="logger"> - объект для логгирования </param>
         socket_t(log_t& logger);
 
         /// <summary>
-        ///   4- 
+        /// Конструктор с 4-я параметрами
         /// </summary>
-        /// <param name="af"> -  :       .     IPv4.
-        ///    AF_INET </param>
-        /// <param name="type"> -  :      TCP (SOCK_STREAM)  UDP (SOCK_DGRAM).
-        ///       "" ,        .
-        ///    SOCK_RAW </param>
-        /// <param name="protocol"> -  :  ,      TCP  UDP     0.
+        /// <param name="af"> - Семейство адресов: сокеты могут работать с большим семейством адресов. Наиболее частое семейство – IPv4.
+        ///  Указывается как AF_INET </param>
+        /// <param name="type"> - ип сокета: обычно задается тип транспортного протокола TCP (SOCK_STREAM) или UDP (SOCK_DGRAM).
+        ///  Но бывают и так называемые "сырые" сокеты, функционал которых сам программист определяет в процессе использования.
+        ///  Тип обозначается SOCK_RAW </param>
+        /// <param name="protocol"> - Тип протокола: необязательный параметр, если тип сокета указан как TCP или UDP – можно передать значение 0.
         /// </param>
-        /// <param name="logger"> -     </param>
+        /// <param name="logger"> - объект для логгирования ошибок </param>
         socket_t(int af, int type, int protocol, log_t& logger);
 
         /// <summary>
-        ///    6 
+        ///  Конструктор с 6 параметрами
         /// </summary>
-        /// <param name="af"> -  :       .     IPv4.
-        ///    AF_INET </param>
-        /// <param name="type"> -  :      TCP (SOCK_STREAM)  UDP (SOCK_DGRAM).
-        ///       "" ,        .
-        ///    SOCK_RAW </param>
-        /// <param name="protocol"> -  :  ,      TCP  UDP     0.
+        /// <param name="af"> - Семейство адресов: сокеты могут работать с большим семейством адресов. Наиболее частое семейство – IPv4.
+        ///  Указывается как AF_INET </param>
+        /// <param name="type"> - тип сокета: обычно задается тип транспортного протокола TCP (SOCK_STREAM) или UDP (SOCK_DGRAM).
+        ///  Но бывают и так называемые "сырые" сокеты, функционал которых сам программист определяет в процессе использования.
+        ///  Тип обозначается SOCK_RAW </param>
+        /// <param name="protocol"> - Тип протокола: необязательный параметр, если тип сокета указан как TCP или UDP – можно передать значение 0.
         /// </param>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -   </param>
-        /// <param name="logger"> -     </param>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта </param>
+        /// <param name="logger"> - объект для логгирования ошибок </param>
         socket_t(int af, int type, int protocol, std::string ip, unsigned short port, log_t& logger);
 
         /// <summary>
-        ///    5 
+        ///  Конструктор с 5 параметрами
         /// </summary>
-        /// <param name="af"> -  :       .     IPv4.
-        ///    AF_INET </param>
-        /// <param name="type"> -  :      TCP (SOCK_STREAM)  UDP (SOCK_DGRAM).
-        ///       "" ,        .
-        ///    SOCK_RAW </param>
-        /// <param name="protocol"> -  :  ,      TCP  UDP     0.
+        /// <param name="af"> - Семейство адресов: сокеты могут работать с большим семейством адресов. Наиболее частое семейство – IPv4.
+        ///  Указывается как AF_INET </param>
+        /// <param name="type"> - ип сокета: обычно задается тип транспортного протокола TCP (SOCK_STREAM) или UDP (SOCK_DGRAM).
+        ///  Но бывают и так называемые "сырые" сокеты, функционал которых сам программист определяет в процессе использования.
+        ///  Тип обозначается SOCK_RAW </param>
+        /// <param name="protocol"> - Тип протокола: необязательный параметр, если тип сокета указан как TCP или UDP – можно передать значение 0.
         /// </param>
-        /// <param name="sockInfo"> -     
-        /// <param name="logger"> -     </param>
-        socket_t(int af, int type, int protocol, sockInfo_t sockInfo, log_t& logger);
+        /// <param name="sockInfo"> - объект содержащий информацию о сокете
+        /// <param name="logger"> - объект для логгирования ошибок </param>
+        socket_t(int af, int type, int protocol, const sockInfo_t& sockInfo, log_t& logger);
+
+        /// <summary>
+        ///  Конструктор с 4 параметрами, семейство адресов берется из адреса привязки
+        /// </summary>
+        /// <param name="type"> - тип сокета (SOCK_STREAM, SOCK_DGRAM) </param>
+        /// <param name="protocol"> - Тип протокола, для TCP и UDP можно передать 0 </param>
+        /// <param name="local"> - адрес привязки сокета </param>
+        /// <param name="logger"> - объект для логгирования ошибок </param>
+        socket_t(int type, int protocol, const endpoint_t& local, log_t& logger);
 
-        //  -  ,   
+        // сокеты - уникальный ресурс, удаляем копирование объектов
         socket_t(const socket_t& sock) = delete;
         socket_t& operator = (const socket_t& sock) = delete;
 
         /// <summary>
-        ///    
+        /// Метод проверки валидности сокета
         /// </summary>
-        /// <param name="logOn"> -       </param>
-        /// <returns> true -  , false -    </returns>
+        /// <param name="logOn"> - флаг на задание логгирования невалидности сокета </param>
+        /// <returns> true - сокет валиден, false - сокет не валиден </returns>
         bool CheckValidSocket(bool logOn = true);
 
         virtual ~socket_t();
 
         /// <summary>
-        ///    
+        /// Метод возврата дескриптора сокета
         /// </summary>
-        /// <returns>   </returns>
+        /// <returns> дескриптор сокета </returns>
         SOCKET getSocket() const;
 
         /// <summary>
-        ///   
+        /// установить сокет неблокирующим
         /// </summary>
-        /// <returns> 1 -    </returns>
+        /// <returns> 1 - сокет не блокирующий </returns>
         bool setNonBlock();
+
+        /// <summary>
+        /// Метод установки опции сокета
+        /// </summary>
+        /// <param name="option"> - опция (option_t) </param>
+        /// <param name="value"> - значение опции (для опций-флагов 1 - включить, 0 - выключить) </param>
+        /// <returns> 1 - опция установлена </returns>
+        bool SetOption(int option, int value = 1);
+
+        /// <summary>
+        /// Метод применения профиля производительности к сокету. Опции, которых нет в ОС, пропускаются
+        /// </summary>
+        /// <param name="profile"> - профиль (profile_t) </param>
+        /// <param name="family"> - семейство адресов сокета: у AF_UNIX нет опций уровня TCP </param>
+        /// <returns> 1 - все опции профиля установлены </returns>
+        bool ApplyProfile(int profile, int family);
+    protected:
+        /// <summary>
+        /// Метод освобождения пути локального сокета перед привязкой: файл сокета прошлого запуска удаляется,
+        /// только если подключение к нему отклонено (никто не слушает). Чужой файл по ошибочному пути не трогается
+        /// </summary>
+        /// <returns> 1 - путь можно занимать; 0 - на пути работает сервер (ошибка ADDRESS_IN_USE) </returns>
+        bool ReleaseLocalPath();
+
+        SOCKET Socket; // дескриптор сокета
+        bool nonBlock; // признак неблокирующего сокета
+    };
+
+    /// <summary>
+    /// Класс потокового транспорта: отделение кадров в принятом потоке, потоковый прием длинных кадров, буфер исходящих.
+    /// Байты передает наследник (TCP сокет, канал в памяти) методами RawRecive() и RawSend(),
+    /// поэтому разбор кадров и дописывание частичных отправок одни и те же на любом транспорте
+    /// </summary>
+    class transport_t
+    {
+    public:
+        /// <summary>
+        /// тип функции определения длины кадра по его началу (кадры, в теле которых может встретиться признак конца сообщения)
+        /// </summary>
+        /// <param name="data"> - начало кадра </param>
+        /// <param name="size"> - количество принятых байт кадра </param>
+        /// <returns> полная длина кадра; 0 - кадр ограничивается признаком конца сообщения (либо заголовок еще не принят) </returns>
+        typedef size_t(*frameLength_t)(const char* data, size_t size);
+
+        transport_t(const transport_t&) = delete;
+        transport_t& operator = (const transport_t&) = delete;
+
+        /// <summary>
+        /// деструктор
+        /// </summary>
+        virtual ~transport_t();
+
+        /// <summary>
+        /// Метод приема сообщений из соединения с поддержкой контроля размера принятого сообщения
+        /// </summary>
+        /// <param name="str_bufer"> - буфер для приема данных </param>
+        /// <param name="str_EndOfMessege"> - строка символов обозначающая конец сообщения (опционально) </param>
+        /// <param name="sizeMsg"> - размер ожидаемого сообщения (опционально) </param>
+        /// <returns> 0 - сообщение принято поностью;
+        ///           N>0 - принято N байт;
+        ///           -1 - системная ошибка;
+        ///           -2 - соединение закрыто или невалидный сокет;
+        ///           -3 - данных на входе нет(неблокирующий сокет);
+        ///           -4 - кадр длиннее наибольшего размера (SetMaxFrame), соединение разорвано</returns>
+        int Recive(std::string& str_bufer, const std::string str_EndOfMessege = "", const size_t sizeMsg = 0);
+
+        /// <summary>
+        /// Метод потокового приема кадров, ограниченных признаком конца сообщения (неблокирующий сокет).
+        /// Длинный кадр выдается частями по мере приема: как только в буфере набирается chunkSize байт,
+        /// потребитель забирает часть и очищает буфер, поэтому память на соединение не зависит от длины кадра.
+        /// Первая часть начинается с начала кадра, последняя заканчивается признаком конца; признак конца
+        /// никогда не разрывается между частями. Кадры с известной длиной (SetFrameLength) выдаются целиком
+        /// </summary>
+        /// <param name="str_bufer"> - буфер приема, потребитель очищает его после каждой выданной части и кадра </param>
+        /// <param name="str_EndOfMessege"> - строка символов обозначающая конец сообщения </param>
+        /// <param name="chunkSize"> - наименьший размер выдаваемой части </param>
+        /// <returns> 0 - в буфере конец кадра (либо кадр целиком);
+        ///           1 - в буфере очередная часть кадра, кадр продолжается;
+        ///           2 - данные приняты, часть кадра еще не набрана;
+        ///           -1 - системная ошибка;
+        ///           -2 - соединение закрыто или невалидный сокет;
+        ///           -3 - данных на входе нет;
+        ///           -4 - кадр длиннее наибольшего размера (SetMaxFrame), соединение разорвано</returns>
+        int ReciveStream(std::string& str_bufer, const std::string& str_EndOfMessege, const size_t chunkSize);
+
+        /// <summary>
+        /// Метод задания наибольшего размера кадра. Принимаемый кадр длиннее него - ошибка протокола:
+        /// Recive() и ReciveStream() возвращают -4 и разрывают соединение, не дожидаясь конца кадра
+        /// </summary>
+        /// <param name="maxFrame"> - наибольший размер кадра в байтах, 0 - без ограничения </param>
+        void SetMaxFrame(size_t maxFrame);
+
+        /// <summary>
+        /// Метод отправки сообщений в соединение с поддержкой контроля размера отправленного сообщения
+        /// </summary>
+        /// <param name="str_bufer"> - буфер, содержащий данные для отправки </param>
+        /// <param name="offset"> - смещение от начала буфера, с которого начинается отправка </param>
+        /// <returns> 0 - сообщение отправлено поностью;
+        ///           N>0 - отправлено N байт (вместе со смещением);
+        ///           -1 - системная ошибка;
+        ///           -2 - соединение закрыто или невалидный сокет;
+        ///           -3 - транспорт не готов к отправке</returns>
+        int Send(const std::string& str_bufer, const unsigned offset = 0);
+
+        /// <summary>
+        /// Метод отправки через буфер исходящих: что транспорт не принял сразу, копится в буфере и дописывается методом Flush().
+        /// Пока буфер не пуст, новые данные только добавляются в его конец, поэтому порядок байт сохраняется.
+        /// Send() и TCP_socketClient_t::SendFile() в обход непустого буфера перемешают поток
+        /// </summary>
+        /// <param name="str_bufer"> - буфер, содержащий данные для отправки </param>
+        /// <returns> 0 - данные отправлены либо приняты в буфер;
+        ///           -1 - системная ошибка;
+        ///           -2 - соединение закрыто или невалидный сокет</returns>
+        int SendBuffered(const std::string& str_bufer);
+
+        /// <summary>
+        /// Метод дописывания буфера исходящих, вызывается по готовности транспорта к отправке
+        /// </summary>
+        /// <returns> 0 - буфер пуст;
+        ///           N>0 - в буфере осталось N байт;
+        ///           -1 - системная ошибка;
+        ///           -2 - соединение закрыто или невалидный сокет</returns>
+        int Flush();
+
+        /// <summary>
+        /// Метод возврата количества байт в буфере исходящих
+        /// </summary>
+        /// <returns> количество неотправленных байт </returns>
+        size_t Backlog() const;
+
+        /// <summary>
+        /// Метод возврата количества частичных отправок: транспорт принял меньше, чем у него просили
+        /// </summary>
+        /// <returns> количество частичных отправок с последнего сброса потока </returns>
+        size_t PartialSends() const;
+
+        /// <summary>
+        /// метод возврата состояния соединения
+        /// </summary>
+        /// <returns> 1 - соединение есть </returns>
+        bool GetConnected() const;
+
+        /// <summary>
+        /// Метод логического сброса соединения
+        /// </summary>
+        void ResetConnected();
+
+        /// <summary>
+        /// Метод отключения транспорта
+        /// </summary>
+        virtual void Shutdown() = 0;
+
+        /// <summary>
+        /// Метод обозначения пачки отправок: транспорт может копить данные до конца пачки. По умолчанию ничего не делает
+        /// </summary>
+        /// <param name="b_on"> - 1 - начало пачки, 0 - конец пачки </param>
+        virtual void Cork(bool b_on);
+
+        /// <summary>
+        /// Метод проверки наличия полного кадра, принятого ранее вместе с предыдущим кадром.
+        /// Такой кадр выдается методом Recive() без обращения к сокету
+        /// </summary>
+        /// <returns> 1 - есть полный кадр </returns>
+        bool PendingFrame() const;
+
+        /// <summary>
+        /// Метод задания функции определения длины кадра. Кадры с известной длиной Recive() отделяет по длине,
+        /// не просматривая их тело в поиске признака конца сообщения. Функция принадлежит объекту и не переносится методом Move()
+        /// </summary>
+        /// <param name="frameLength"> - функция определения длины кадра, nullptr - все кадры ограничиваются признаком конца </param>
+        void SetFrameLength(frameLength_t frameLength);
     protected:
-        SOCKET Socket; //  
-        bool nonBlock; //   
+        /// <summary>
+        /// конструктор
+        /// </summary>
+        /// <param name="logger"> - объект для логгирования </param>
+        transport_t(log_t& logger);
+
+        /// <summary>
+        /// Метод приема байт, не больше size
+        /// </summary>
+        /// <param name="data"> - буфер приема </param>
+        /// <param name="size"> - размер буфера </param>
+        /// <returns> N>0 - принято N байт; 0 - соединение закрыто; -1 - ошибка (уже в логе); -3 - данных нет </returns>
+        virtual int RawRecive(char* data, size_t size) = 0;
+
+        /// <summary>
+        /// Метод отправки байт; транспорт может принять меньше size
+        /// </summary>
+        /// <param name="data"> - данные для отправки </param>
+        /// <param name="size"> - количество байт, больше 0 </param>
+        /// <returns> N>0 - отправлено N байт; -1 - ошибка (уже в логе); -2 - соединение закрыто; -3 - транспорт не готов к отправке </returns>
+        virtual int RawSend(const char* data, size_t size) = 0;
+
+        /// <summary>
+        /// Метод проверки готовности транспорта к обмену
+        /// </summary>
+        /// <returns> 1 - транспорт валиден </returns>
+        virtual bool RawValid() = 0;
+
+        /// <summary>
+        /// Метод проверки режима транспорта
+        /// </summary>
+        /// <returns> 1 - неблокирующий: прием и отправка выполняют одну попытку </returns>
+        virtual bool NonBlocking() const = 0;
+
+        /// <summary>
+        /// Метод подготовки к приему, вызывается перед чтением транспорта. По умолчанию ничего не делает
+        /// </summary>
+        virtual void BeforeRecive();
+
+        /// <summary>
+        /// Метод отделения первого полного кадра от буфера, остаток буфера запоминается до следующего приема
+        /// </summary>
+        /// <param name="str_bufer"> - буфер приема </param>
+        /// <param name="begin"> - позиция в буфере, от которой отсчитаны найденные границы кадров </param>
+        /// <param name="b_scan"> - байты от begin до конца буфера новые, их нужно просмотреть </param>
+        /// <returns> true - кадр отделен </returns>
+        bool SplitFrame(std::string& str_bufer, size_t begin, bool b_scan = false);
+
+        /// <summary>
+        /// Метод сброса состояния потока (новое соединение): разбор на кадры и буфер исходящих
+        /// </summary>
+        void ResetFraming();
+
+        /// <summary>
+        /// Метод переноса состояния потока от другого транспорта, состояние источника сбрасывается
+        /// </summary>
+        /// <param name="source"> - транспорт источник </param>
+        void MoveFraming(transport_t& source);
+
+        frameLength_t frameLength = nullptr; // функция определения длины кадра
+        bool b_connected; // признак соединения
+        delimiterScanner_t scanner; // поиск конца сообщения в принятых байтах
+        std::string pending; // принятые байты, следующие за последним выданным кадром
+        std::vector<size_t> v_bounds; // границы полных кадров в pending
+        size_t maxFrame = 0; // наибольший размер кадра (0 - без ограничения)
+        size_t frameHead = 0; // байт текущего кадра, уже выданных частями (ReciveStream)
+        std::string streamTail; // конец выданной части, в котором может начинаться признак конца сообщения
+        std::string outbox; // буфер исходящих: байты, не принятые транспортом
+        size_t outboxHead = 0; // отправленные байты в начале outbox
+        size_t partialSends = 0; // частичных отправок
+        log_t& frameLogger; // объект логгирования
     };
 
     /// <summary>
-    /// TCP  
+    /// TCP клиентский сокет; с адресом сервера AF_UNIX - локальный потоковый сокет с тем же разбором кадров
     /// </summary>
-    class TCP_socketClient_t : public socket_t
+    class TCP_socketClient_t : public socket_t, public transport_t
     {
-        friend class TCP_socketServer_t; //      (  acept())
+        friend class TCP_socketServer_t; // даем полную свободу серверному сокету (необходимо для acсept())
     private:
         /// <summary>
-        ///  ,      ,       acept()
+        /// Заменить сокет, данный метод нарушает принцип уникальности ресурса, но необходим для серверного сокета для acсept()
         /// </summary>
-        /// <param name="socket"> -    </param>
-        /// <param name="sockInfo"> -   </param>
-        /// <returns> true -   </returns>
-        bool SetSocket(SOCKET socket, sockInfo_t sockInfo);
+        /// <param name="socket"> - новый дескриптор сокета </param>
+        /// <param name="sockInfo"> - обновленная информация </param>
+        /// <returns> true - успешная замена </returns>
+        bool SetSocket(SOCKET socket, const endpoint_t& sockInfo);
 
     public:
-
         /// <summary>
-        /// 
+        /// деструктор
         /// </summary>
         virtual ~TCP_socketClient_t();
 
         /// <summary>
-        ///     ()  
+        /// метод переноса уникального ресурса (дескпритор) между сокетами
         /// </summary>
-        /// <param name="source"> -     -        </param>
+        /// <param name="source"> - ссылка на сокет источник - после вызова метода не содержит валидный сокет </param>
         void Move(TCP_socketClient_t& source);
 
         /// <summary>
-        ///   1 
+        /// Конструткор с 1 параметром
         /// </summary>
-        /// <param name="logger"> -    </param>
+        /// <param name="logger"> - объект для логгирования </param>
         TCP_socketClient_t(log_t& logger);
 
         /// <summary>
-        ///   3 
+        /// Конструктор с 3 параметрами
         /// </summary>
-        /// <param name="ip_server"> - IP     "..." </param>
-        /// <param name="port_server"> -    </param>
-        /// <param name="logger"> -   </param>
+        /// <param name="ip_server"> - IP адрес сервера в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port_server"> - номер порта сервера </param>
+        /// <param name="logger"> - объект логгирования </param>
         TCP_socketClient_t(std::string ip_server, unsigned short port_server, log_t& logger);
 
         /// <summary>
-        ///   2 
+        /// Коструктор с 2 параметрами
         /// </summary>
-        /// <param name="serverSockInfo"> -    </param>
-        /// <param name="logger"> -   </param>
-        TCP_socketClient_t(sockInfo_t serverSockInfo, log_t& logger);
+        /// <param name="serverSockInfo"> - информация о сервере </param>
+        /// <param name="logger"> - объект логгирования </param>
+        TCP_socketClient_t(const sockInfo_t& serverSockInfo, log_t& logger);
 
         /// <summary>
-        ///            
+        /// Коструктор с 2 параметрами, семейство адресов сокета берется из адреса сервера
         /// </summary>
-        /// <param name="str_bufer"> -     </param>
-        /// <param name="str_EndOfMessege"> -      () </param>
-        /// <param name="sizeMsg"> -    () </param>
-        /// <returns> 0 -   ;
-        ///           N>0 -  N ;
-        ///           -1 -  ;
-        ///           -2 -     ;
-        ///           -3 -    ( )</returns>
-        int Recive(std::string& str_bufer, const std::string str_EndOfMessege = "", const size_t sizeMsg = 0);
+        /// <param name="server"> - адрес сервера </param>
+        /// <param name="logger"> - объект логгирования </param>
+        TCP_socketClient_t(const endpoint_t& server, log_t& logger);
 
         /// <summary>
-        ///            
+        /// Метод подключения сокета к серверному сокету
         /// </summary>
-        /// <param name="str_bufer"> - ,     </param>
-        /// <param name="offset"> -    ,     </param>
-        /// <returns> 0 -   ;
-        ///           N>0 -  N  (  );
-        ///           -1 -  ;
-        ///           -2 -     ;
-        ///           -3 -      ( )</returns>
-        int Send(const std::string& str_bufer, const unsigned offset = 0);
+        /// <returns> 1 - сокет подключен </returns>
+        bool Connected();
 
         /// <summary>
-        ///      
+        /// Метод начала неблокирующего подключения к серверу. Создает новый неблокирующий сокет семейства адреса сервера.
+        /// Завершение подключения проверяется методом CheckConnect() после готовности сокета (NonBlockSocket_manager_t::AddClient)
         /// </summary>
-        /// <returns> 1 -   </returns>
-        bool Connected();
+        /// <param name="server"> - адрес сервера </param>
+        /// <returns> 0 - подключен сразу;
+        ///           1 - подключение в процессе;
+        ///          -1 - системная ошибка </returns>
+        int ConnectAsync(const endpoint_t& server);
 
         /// <summary>
-        ///    
+        /// Метод проверки результата неблокирующего подключения
         /// </summary>
-        /// <returns> 1 -   </returns>
-        bool GetConnected() const;
+        /// <returns> 0 - подключен;
+        ///           1 - подключение в процессе;
+        ///          -1 - подключение не удалось </returns>
+        int CheckConnect();
 
         /// <summary>
-        ///    
+        /// Метод отключения сокета
         /// </summary>
-        void ResetConnected();
+        void Shutdown() override;
 
         /// <summary>
-        ///   
+        /// Метод отправки части файла без копирования в пространство пользователя (sendfile)
         /// </summary>
-        void Shutdown();
+        /// <param name="fd"> - дескриптор открытого на чтение файла </param>
+        /// <param name="offset"> - смещение в файле, сдвигается на количество отправленных байт </param>
+        /// <param name="count"> - количество байт для отправки </param>
+        /// <returns> 0 - отправлено все;
+        ///           N>0 - отправлено N байт;
+        ///           -1 - системная ошибка;
+        ///           -2 - соединение закрыто или невалидный сокет;
+        ///           -3 - сокет не готов к отправке (неблокирующий сокет);
+        ///           -4 - файл кончился раньше count (файл укоротили во время отправки)</returns>
+        int SendFile(int fd, long long& offset, size_t count);
+
+        /// <summary>
+        /// Метод возврата адреса сервера
+        /// </summary>
+        /// <returns> адрес сервера </returns>
+        const endpoint_t& GetServer() const;
+
+        /// <summary>
+        /// Метод задания профиля производительности, применяется при подключении (ConnectAsync, Connected)
+        /// </summary>
+        /// <param name="profile"> - профиль (profile_t) </param>
+        void SetProfile(int profile);
+
+        /// <summary>
+        /// Метод задания предела ожидания подтверждения отправленных данных, применяется при подключении:
+        /// если собеседник не подтверждает данные дольше предела, ядро разрывает соединение, и прием либо
+        /// отправка возвращают ошибку. Включает и SO_KEEPALIVE. У AF_UNIX не действует
+        /// </summary>
+        /// <param name="timeout"> - предел, мс (0 - по умолчанию ОС) </param>
+        void SetDeadTimeout(unsigned timeout);
+
+        /// <summary>
+        /// Метод управления TCP_CORK вокруг пачки отправок: при включении данные копятся в ядре
+        /// и уходят полными сегментами после выключения. Действует только в профиле THROUGHPUT
+        /// </summary>
+        /// <param name="b_on"> - 1 - начало пачки, 0 - конец пачки </param>
+        void Cork(bool b_on) override;
     protected:
-        bool b_connected; //     
-        sockInfo_t serverInfo; //   
+        /// <summary>
+        /// Метод приема байт из сокета
+        /// </summary>
+        /// <param name="data"> - буфер приема </param>
+        /// <param name="size"> - размер буфера </param>
+        /// <returns> N>0 - принято N байт; 0 - соединение закрыто; -1 - системная ошибка; -3 - данных нет </returns>
+        int RawRecive(char* data, size_t size) override;
+
+        /// <summary>
+        /// Метод отправки байт в сокет
+        /// </summary>
+        /// <param name="data"> - данные для отправки </param>
+        /// <param name="size"> - количество байт </param>
+        /// <returns> N>0 - отправлено N байт; -1 - системная ошибка; -3 - сокет не готов к отправке </returns>
+        int RawSend(const char* data, size_t size) override;
+
+        /// <summary>
+        /// Метод проверки валидности сокета
+        /// </summary>
+        /// <returns> 1 - сокет валиден </returns>
+        bool RawValid() override;
+
+        /// <summary>
+        /// Метод проверки режима сокета
+        /// </summary>
+        /// <returns> 1 - неблокирующий сокет </returns>
+        bool NonBlocking() const override;
+
+        /// <summary>
+        /// Метод подготовки сокета к приему: в профиле LOW_LATENCY взводит TCP_QUICKACK
+        /// </summary>
+        void BeforeRecive() override;
+
+        /// <summary>
+        /// Метод применения предела ожидания подтверждения к открытому сокету
+        /// </summary>
+        void ApplyDeadTimeout();
+
+        int profile = profile_t::NONE; // профиль производительности
+        unsigned deadTimeout = 0; // предел ожидания подтверждения, мс (0 - по умолчанию ОС)
+        bool b_corked = false; // признак включенного TCP_CORK
+        endpoint_t serverInfo; // адрес сервера
     };
 
     /// <summary>
-    /// TCP  
+    /// TCP серверный сокет
     /// </summary>
     class TCP_socketServer_t : public socket_t
     {
     public:
         /// <summary>
-        ///   3- 
+        /// конструктор с 3-я параметрами
         /// </summary>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -   </param>
-        /// <param name="logger"> -   </param>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта </param>
+        /// <param name="logger"> - объект логгирования </param>
         TCP_socketServer_t(std::string ip, unsigned short port, log_t& logger);
 
         /// <summary>
-        ///   2- 
+        /// конструктор с 2-я параметрами
+        /// </summary>
+        /// <param name="sockInfo"> - информация о сокете </param>
+        /// <param name="logger"> - объект логгирования </param>
+        TCP_socketServer_t(const sockInfo_t& sockInfo, log_t& logger);
+
+        /// <summary>
+        /// конструктор с 2-я параметрами
         /// </summary>
-        /// <param name="sockInfo"> -    </param>
-        /// <param name="logger"> -   </param>
-        TCP_socketServer_t(sockInfo_t sockInfo, log_t& logger);
+        /// <param name="local"> - адрес привязки </param>
+        /// <param name="logger"> - объект логгирования </param>
+        TCP_socketServer_t(const endpoint_t& local, log_t& logger);
 
         /// <summary>
-        ///    
+        /// метод добавления подключенных клиентов
         /// </summary>
-        /// <param name="client"> -         </param>
-        /// <returns> 0 -   ,
-        ///          -1 -  ,
-        ///          -2 -       ( )</returns>
+        /// <param name="client"> - ссылка на клиента под замену на подключенного клиента </param>
+        /// <returns> 0 - добавлен подключенный клиент,
+        ///          -1 - системная ошибка,
+        ///          -2 - нет клиентов в очереди на подключение (неблокирующий сокет)</returns>
         int AddClient(TCP_socketClient_t& client);
     };
 
     /// <summary>
-    /// UDP 
+    /// UDP сокет
     /// </summary>
     class UDP_socket_t : public socket_t
     {
     private:
         /// <summary>
-        ///   MTU
+        /// метод установки MTU
         /// </summary>
         void setMTU();
     public:
 
         /// <summary>
-        ///     ()  
+        /// метод переноса уникального ресурса (дескпритор) между сокетами
         /// </summary>
-        /// <param name="source"> -     -        </param>
+        /// <param name="source"> - ссылка на сокет источник - после вызова метода не содержит валидный сокет </param>
         void Move(UDP_socket_t& source);
 
         /// <summary>
-        ///   1 
+        /// Конструткор с 1 параметром
         /// </summary>
-        /// <param name="logger"> -    </param>
+        /// <param name="logger"> - объект для логгирования </param>
         UDP_socket_t(log_t& logger);
 
         /// <summary>
-        ///   3- 
+        /// конструктор с 3-я параметрами
         /// </summary>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -   </param>
-        /// <param name="logger"> -   </param>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта </param>
+        /// <param name="logger"> - объект логгирования </param>
         UDP_socket_t(std::string ip, unsigned short port, log_t& logger);
 
         /// <summary>
-        ///   2- 
+        /// конструктор с 2-я параметрами
         /// </summary>
-        /// <param name="sockInfo"> -    </param>
-        /// <param name="logger"> -   </param>
-        UDP_socket_t(sockInfo_t& sockInfo, log_t& logger);
+        /// <param name="sockInfo"> - информация о сокете </param>
+        /// <param name="logger"> - объект логгирования </param>
+        UDP_socket_t(const sockInfo_t& sockInfo, log_t& logger);
 
         /// <summary>
-        ///        
+        /// конструктор с 2-я параметрами
         /// </summary>
-        /// <param name="buffer"> -      </param>
-        /// <param name="target"> -     </param>
-        /// <returns> 0 -   ;
-        ///         N>0 -  N ;
-        ///          -1 -  ;
-        ///          -2 -    MTU    ;
-        ///          -3 -      ( ) </returns>
-        int SendTo(const std::string& buffer, sockInfo_t target);
+        /// <param name="local"> - адрес привязки </param>
+        /// <param name="logger"> - объект логгирования </param>
+        UDP_socket_t(const endpoint_t& local, log_t& logger);
 
         /// <summary>
-        ///        ,       
+        /// Метод отправки данных в сеть без предварительного соединения
         /// </summary>
-        /// <param name="buffer"> -      </param>
-        /// <returns> 0 -   ;
-        ///         N>0 -  N ;
-        ///          -1 -  ;
-        ///          -2 -    MTU    ;
-        ///          -3 -      ( ) </returns>
+        /// <param name="buffer"> - область с данными для отправки </param>
+        /// <param name="target"> - информация о сокете приемнике </param>
+        /// <returns> 0 - отправлено все сообщение;
+        ///         N>0 - отправлено N байт;
+        ///          -1 - системная ошибка;
+        ///          -2 - размер сообщения больше MTU или сокет не валидный;
+        ///          -3 - сокет не готов к отправке (неблокирующий сокет) </returns>
+        int SendTo(const std::string& buffer, const endpoint_t& target);
+
+        /// <summary>
+        /// Метод отправки данных в сеть без предварительного соединения
+        /// </summary>
+        /// <param name="buffer"> - область с данными для отправки </param>
+        /// <param name="target"> - информация о сокете приемнике </param>
+        /// <returns> коды возврата аналогичны SendTo(buffer, endpoint) </returns>
+        int SendTo(const std::string& buffer, const sockInfo_t& target);
+
+        /// <summary>
+        /// Метод отправки данных в сеть без предварительного соединения, отправка предыдущему сокету с которым было взаимодействие
+        /// </summary>
+        /// <param name="buffer"> - область с данными для отправки </param>
+        /// <returns> 0 - отправлено все сообщение;
+        ///         N>0 - отправлено N байт;
+        ///          -1 - системная ошибка;
+        ///          -2 - размер сообщения больше MTU или сокет не валидный;
+        ///          -3 - сокет не готов к отправке (неблокирующий сокет) </returns>
         int SendTo(const std::string& buffer);
 
         /// <summary>
-        ///        
+        /// Метод отправки данных в сеть без предварительного соединения
         /// </summary>
-        /// <param name="buffer"> -      </param>
-        /// <param name="ip"> - IP    "..." </param>
-        /// <param name="port"> -   </param>
-        /// <returns> 0 -   ;
-        ///         N>0 -  N ;
-        ///          -1 -  ;
-        ///          -2 -    MTU    ;
-        ///          -3 -      ( ) </returns>
+        /// <param name="buffer"> - область с данными для отправки </param>
+        /// <param name="ip"> - IP адресс в формате "хххх.хххх.хххх.хххх" </param>
+        /// <param name="port"> - номер порта </param>
+        /// <returns> 0 - отправлено все сообщение;
+        ///         N>0 - отправлено N байт;
+        ///          -1 - системная ошибка;
+        ///          -2 - размер сообщения больше MTU или сокет не валидный;
+        ///          -3 - сокет не готов к отправке (неблокирующий сокет) </returns>
         int SendTo(const std::string& buffer, std::string ip, unsigned short port);
 
         /// <summary>
-        ///        
+        /// Метод приема данных из сети без предварительного соединения
         /// </summary>
-        /// <param name="buffer"> -     </param>
-        /// <param name="str_EndOfMessege"> -    () </param>
-        /// <param name="sizeMsg"> -    () </param>
-        /// <returns>   0 -    ;
-        ///             N>0 -  N-;
-        ///             -1 -  ;
-        ///             -2 -      ;
-        ///             -3 -    ();</returns>
+        /// <param name="buffer"> - буфер с принятыми данными </param>
+        /// <param name="str_EndOfMessege"> - признак конца сообщения (опционально) </param>
+        /// <param name="sizeMsg"> - ожидаемы размер сообщения (опционально) </param>
+        /// <returns>   0 - все сообщение принято успешно;
+        ///             N>0 - принято N-байт;
+        ///             -1 - системная ошибка;
+        ///             -2 - соеднинение закрыто или сокет не валидный;
+        ///             -3 - сокет не готов (неблокирующий);</returns>
         int RecvFrom(std::string& buffer, const std::string str_EndOfMessege = "", const size_t sizeMsg = 0);
 
         /// <summary>
-        ///           (/ )
+        /// метод возврата информации о сокете с которым происходило последнее взаимодействие (отправка/прием данных)
         /// </summary>
-        /// <returns>       (/ ) </returns>
-        sockInfo_t GetLastCommunication() const;
+        /// <returns> сокет с которым происходило последнее взаимодействие (отправка/прием данных) </returns>
+        const endpoint_t& GetLastCommunication() const;
 
         /// <summary>
-        ///   MTU
+        /// метод возврата MTU
         /// </summary>
-        /// <returns>    </returns>
+        /// <returns> максимальный размер сообщения </returns>
         unsigned int MTU() const;
     private:
-        sockInfo_t lastCommunicationSocket; //  ,    
-        unsigned int u32_MTU; //    
+        endpoint_t lastCommunicationSocket; // Последний сокет, с кем происходило взаимодействие
+        unsigned int u32_MTU; // максимальный размер отправляемых данных
+        delimiterScanner_t scanner; // поиск конца сообщения в датаграмме
+        std::vector<size_t> v_bounds; // границы кадров в последней датаграмме
+    };
+
+    /// <summary>
+    /// Сокет пробуждения: UDP сокет на петлевом адресе, соединенный сам с собой.
+    /// Добавляется читателем в мультиплексор потока; другой поток вызывает Notify(), и ожидание
+    /// в NonBlockSocket_manager_t::Work() завершается. Повторные Notify() до Drain() не отправляют
+    /// новых датаграмм. Notify() можно вызывать из любого потока, Drain() - только из потока владельца
+    /// </summary>
+    class wakeup_t : public socket_t
+    {
+    public:
+        /// <summary>
+        /// Конструктор
+        /// </summary>
+        /// <param name="logger"> - объект для логгирования </param>
+        wakeup_t(log_t& logger);
+
+        /// <summary>
+        /// Метод пробуждения потока владельца
+        /// </summary>
+        void Notify();
+
+        /// <summary>
+        /// Метод сброса пробуждения, вызывается владельцем до проверки очередей
+        /// </summary>
+        void Drain();
+    protected:
+        std::atomic<bool> b_pending; // датаграмма пробуждения отправлена и еще не вычитана
     };
 
     /// <summary>
-    ///    . 
-    ///     ,      
+    /// Класс мультиплексирования неблокирующих сокетов. 
+    /// При удалении сокета раньше менеджера, необходимо удалить сокет из списков менеджера.
+    /// Готовность сокета узнается либо опросом GetReady...() после Work(), либо обработчиком,
+    /// переданным в AddReader()/AddSender(): Work() вызывает его прямо по результатам poll
     /// </summary>
     class NonBlockSocket_manager_t : private RAII_OSsock
     {
+    public:
+        /// <summary>
+        /// тип обработчика готовности сокета. Вызывается из Work() на событие сокета, включая ошибку и закрытие соединения.
+        /// Обработчик может добавлять и удалять сокеты; удаленный обработчик в текущем Work() больше не вызывается.
+        /// Обработчик сокета, уничтоженного без удаления из списков, не вызывается и снимается при обновлении pollfd
+        /// </summary>
+        typedef std::function<void()> handler_t;
     protected:
         /// <summary>
-        ///       
+        /// метод добавления сокета в один из списков
         /// </summary>
-        /// <param name="m_sock"> -     </param>
-        /// <param name="socket"> -    </param>
-        /// <returns> 1 -   </returns>
-        bool addSocket(std::unordered_map<int, std::weak_ptr<socket_t>>& m_sock, const std::weak_ptr<socket_t>& socket);
+        /// <param name="m_sock"> - ассоциативный массив для добавления </param>
+        /// <param name="socket"> - сокет на добавление </param>
+        /// <param name="m_handler"> - обработчики списка (nullptr - список без обработчиков) </param>
+        /// <returns> 1 - сокет добавлен </returns>
+        bool addSocket(std::unordered_map<int, std::weak_ptr<socket_t>>& m_sock, const std::weak_ptr<socket_t>& socket, std::unordered_map<int, std::shared_ptr<handler_t>>* m_handler = nullptr);
 
         /// <summary>
-        ///     
+        /// Метод удаления сокета из списков
         /// </summary>
-        /// <param name="m_sock"> -     </param>
-        /// <param name="socket"> -    </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="m_sock"> - ассоциативный массив для добавления </param>
+        /// <param name="socket"> - сокет на удаление </param>
+        /// <returns> 1 - сокет удален </returns>
         bool deleteSocket(std::unordered_map<int, std::weak_ptr<socket_t>>& m_sock, const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///    pollfd
+        /// Метод удаления обработчика сокета. Обработчик очищается, чтобы его копия в v_handler больше не вызывалась
+        /// </summary>
+        /// <param name="m_handler"> - обработчики списка </param>
+        /// <param name="fd"> - дескриптор сокета </param>
+        void deleteHandler(std::unordered_map<int, std::shared_ptr<handler_t>>& m_handler, int fd);
+
+        /// <summary>
+        /// Метод привязки обработчика к сокету: после уничтожения сокета обработчик не вызывается,
+        /// даже если события для него уже собраны в текущем Work()
+        /// </summary>
+        /// <param name="socket"> - сокет </param>
+        /// <param name="handler"> - обработчик готовности </param>
+        /// <returns> обработчик для списка </returns>
+        static std::shared_ptr<handler_t> BindHandler(const std::weak_ptr<socket_t>& socket, handler_t handler);
+
+        /// <summary>
+        /// Метод обновления структуры pollfd
         /// </summary>
         void UpdatePollfd();
 
         /// <summary>
-        ///    
+        /// функция мультиплексированя неблокирующих сокетов
         /// </summary>
-        /// <param name="timeOut"> -  timeout    </param>
-        /// <returns> -1 -  ; 0 -      ; N>0 - -  </returns>
+        /// <param name="timeOut"> - время timeout для функции мультиплексирования </param>
+        /// <returns> -1 - системная ошибка; 0 - вышел таймаут и событий не произошло; N>0 - кол-во событий </returns>
         int Poll(int timeOut);
     public:
         /// <summary>
-        ///    
+        /// Конструктор с одним параметром
         /// </summary>
-        /// <param name="logger"> -    </param>
+        /// <param name="logger"> - объект для логиирования </param>
         NonBlockSocket_manager_t(log_t& logger);
 
         /// <summary>
-        ///    
+        /// Конструктор с двумя параметрами
         /// </summary>
-        /// <param name="size"> -     </param>
-        /// <param name="logger"> -    </param>
+        /// <param name="size"> - предварительное количество наблюдаемых сокетов </param>
+        /// <param name="logger"> - объект для логирования </param>
         NonBlockSocket_manager_t(int size, log_t& logger);
 
         /// <summary>
-        ///   
+        /// метод добавления отправителя
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет добавлен </returns>
         bool AddSender(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод добавления отправителя с обработчиком готовности. Готовность такого сокета не попадает в GetReadySender()
+        /// </summary>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <param name="handler"> - обработчик готовности к отправке </param>
+        /// <returns> 1 - сокет добавлен </returns>
+        bool AddSender(const std::weak_ptr<socket_t>& socket, handler_t handler);
+
+        /// <summary>
+        /// метод удаления отправителя
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет удален </returns>
         bool deleteSender(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод добавления читателя
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет добавлен </returns>
         bool AddReader(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод добавления читателя с обработчиком готовности. Готовность такого сокета не попадает в GetReadyReader()
+        /// </summary>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <param name="handler"> - обработчик готовности к приему </param>
+        /// <returns> 1 - сокет добавлен </returns>
+        bool AddReader(const std::weak_ptr<socket_t>& socket, handler_t handler);
+
+        /// <summary>
+        /// метод удаления читателя
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет удален </returns>
         bool deleteReader(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод добавления сервера
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет добавлен </returns>
         bool AddServer(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод удаления сервера
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет удален </returns>
         bool deleteServer(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод добавления клиента
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет добавлен </returns>
         bool AddClient(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///   
+        /// метод удаления клиента
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет удален </returns>
         bool deleteClient(const std::weak_ptr<socket_t>& socket);
 
         /// <summary>
-        ///      
+        /// метод проверки готовности отправителя к отправке
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет готов </returns>
         bool GetReadySender(const std::weak_ptr<socket_t>& socket) const;
 
         /// <summary>
-        ///      
+        /// метод проверки готовности читателя к приему
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - сокет готов </returns>
         bool GetReadyReader(const std::weak_ptr<socket_t>& socket) const;
 
         /// <summary>
-        ///        
+        /// метод проверки наличия запроса на подключения у сервера
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - есть подключение </returns>
         bool GetReadyServer(const std::weak_ptr<socket_t>& socket) const;
 
         /// <summary>
-        ///        
+        /// метод проверки подтверждения подключения к серверу у клиента
         /// </summary>
-        /// <param name="socket"> -   </param>
-        /// <returns> 1 -   </returns>
+        /// <param name="socket"> - целевой сокет </param>
+        /// <returns> 1 - есть подключение </returns>
         bool GetReadyClient(const std::weak_ptr<socket_t>& socket) const;
 
         /// <summary>
-        ///    
+        /// основной метод работы мультиплесора
         /// </summary>
-        /// <param name="timeOut"> -    </param>
-        /// <returns> 1 -      </returns>
+        /// <param name="timeOut"> - время ожидания мультиплесора </param>
+        /// <returns> 1 - принято хотя бы одно событие </returns>
         bool Work(const int timeOut);
+
+        /// <summary>
+        /// Статистика ожидания событий
+        /// </summary>
+        struct waitStat_t
+        {
+            std::chrono::microseconds spin{ 0 }; // время активного опроса
+            std::chrono::microseconds sleep{ 0 }; // время блокирующего ожидания
+            unsigned long long spinHits = 0; // событие пришло во время активного опроса
+            unsigned long long sleeps = 0; // количество блокирующих ожиданий
+        };
+
+        /// <summary>
+        /// Метод включения режима "опрос, затем ожидание": Work() сначала опрашивает сокеты с нулевым таймаутом
+        /// в течение бюджета, и только потом блокируется в poll. Бюджет адаптивный: после холостых опросов
+        /// уменьшается (до 1/16 заданного), после попадания восстанавливается
+        /// </summary>
+        /// <param name="spin"> - бюджет активного опроса, 0 - режим выключен </param>
+        /// <param name="cpu"> - ядро процессора для потока, вызывающего Work(); -1 - без привязки </param>
+        void SetSpin(std::chrono::microseconds spin, int cpu = -1);
+
+        /// <summary>
+        /// Метод возврата статистики ожидания событий
+        /// </summary>
+        /// <returns> статистика ожидания </returns>
+        const waitStat_t& GetWaitStat() const;
     protected:
-        std::vector <struct pollfd> v_fds; //    pollfd
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_senderSocket; //    
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_readerSocket; //    
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_serverSocket; //     
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_clientSocket; //     
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_readySender; //   
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_readyReader; //   
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_readyServer; //   
-        std::unordered_map<int, std::weak_ptr<socket_t>> m_readyClient; //   
-        bool b_change; //    pollfd
-        log_t& logger; //  
+        /// <summary>
+        /// Метод привязки текущего потока к ядру процессора
+        /// </summary>
+        /// <returns> 1 - поток привязан </returns>
+        bool PinThread();
+
+        typedef std::chrono::steady_clock clock_t;
+
+        std::chrono::microseconds spinLimit{ 0 }; // заданный бюджет активного опроса
+        std::chrono::microseconds spinBudget{ 0 }; // текущий бюджет активного опроса
+        int cpu = -1; // ядро процессора для потока цикла событий
+        bool b_pinned = false; // поток уже привязан
+        waitStat_t waitStat; // статистика ожидания
+        std::vector <struct pollfd> v_fds; // динамический массив структур pollfd
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_senderSocket; // мап сокетов ожидающих отправку
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_readerSocket; // мап сокетов ожидающих прием
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_serverSocket; // мап сокетов ожидающих входящее подключение
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_clientSocket; // мап сокетов ожидающих изходящее подключение
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_readySender; // мап готовых отправителей
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_readyReader; // мап готовых читателей
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_readyServer; // мап готовых серверов
+        std::unordered_map<int, std::weak_ptr<socket_t>> m_readyClient; // мап готовых клиентов
+        std::unordered_map<int, std::shared_ptr<handler_t>> m_senderHandler; // обработчики готовности отправителей
+        std::unordered_map<int, std::shared_ptr<handler_t>> m_readerHandler; // обработчики готовности читателей
+        std::vector<std::shared_ptr<handler_t>> v_handler; // обработчики в порядке v_fds (пусто - сокет без обработчика)
+        bool b_change; // флаг изменения структур pollfd
+        log_t& logger; // объект логгирования
     };
 };
 
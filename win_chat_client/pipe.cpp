@@ -0,0 +1,186 @@
+﻿#include "pipe.h"
+
+#include <algorithm>
+#include <cstring>
+
+/// <summary>
+/// конструктор, транспорт не соединен
+/// </summary>
+/// <param name="logger"> - объект для логгирования </param>
+network::pipeTransport_t::pipeTransport_t(log_t& logger) : transport_t(logger)
+{}
+
+/// <summary>
+/// деструктор, закрывает канал
+/// </summary>
+network::pipeTransport_t::~pipeTransport_t()
+{
+    Shutdown();
+}
+
+/// <summary>
+/// Метод соединения пары транспортов новым каналом; прежние каналы закрываются
+/// </summary>
+/// <param name="first"> - первый транспорт </param>
+/// <param name="second"> - второй транспорт </param>
+/// <param name="profile"> - параметры канала (общие для обоих направлений) </param>
+void network::pipeTransport_t::Connect(pipeTransport_t& first, pipeTransport_t& second, const pipeProfile_t& profile)
+{
+    first.Shutdown();
+    second.Shutdown();
+
+    std::shared_ptr<channel_t> forward = std::make_shared<channel_t>();
+    std::shared_ptr<channel_t> backward = std::make_shared<channel_t>();
+    first.tx = second.rx = forward;
+    first.rx = second.tx = backward;
+    for (pipeTransport_t* side : { &first, &second })
+    {
+        side->profile = profile;
+        side->ResetFraming();
+        side->b_connected = true;
+    }
+}
+
+/// <summary>
+/// Метод закрытия канала: собеседник дочитывает доставленное (либо теряет его при b_dropOnClose)
+/// и получает закрытие соединения, его запись возвращает -2
+/// </summary>
+void network::pipeTransport_t::Shutdown()
+{
+    if (tx)
+    {
+        tx->b_writerClosed = true;
+        if (profile.b_dropOnClose)
+            Drop(*tx);
+        tx.reset();
+    }
+    if (rx)
+    {
+        rx->b_readerClosed = true;
+        Drop(*rx); // читать их больше некому
+        rx.reset();
+    }
+    b_connected = false;
+}
+
+/// <summary>
+/// Метод проверки готовности к приему: есть доставленные байты либо канал закрыт собеседником
+/// </summary>
+/// <returns> 1 - прием не вернет -3 </returns>
+bool network::pipeTransport_t::Readable()
+{
+    if (PendingFrame())
+        return true;
+    if (!rx)
+        return false;
+
+    Deliver(*rx);
+    return rx->delivered > rx->read || (rx->b_writerClosed && rx->d_segment.empty());
+}
+
+/// <summary>
+/// Метод приема доставленных байт
+/// </summary>
+/// <param name="data"> - буфер приема </param>
+/// <param name="size"> - размер буфера </param>
+/// <returns> N>0 - принято N байт; 0 - соединение закрыто; -3 - данных нет </returns>
+int network::pipeTransport_t::RawRecive(char* data, size_t size)
+{
+    channel_t& channel = *rx;
+    Deliver(channel);
+
+    size_t count = std::min(size, channel.delivered - channel.read);
+    if (count == 0) // закрытие видно, когда доставлено все записанное
+        return channel.b_writerClosed && channel.d_segment.empty() ? 0 : -3;
+
+    std::memcpy(data, &channel.bytes[channel.read - channel.dropped], count);
+    channel.read += count;
+    if (channel.read - channel.dropped > channel.bytes.size() / 2) // прочитанное начало сдвигаем, пока оно не больше остатка
+    {
+        channel.bytes.erase(0, channel.read - channel.dropped);
+        channel.dropped = channel.read;
+    }
+    return static_cast<int>(count);
+}
+
+/// <summary>
+/// Метод записи байт в канал, не больше maxWrite и свободной емкости
+/// </summary>
+/// <param name="data"> - данные для отправки </param>
+/// <param name="size"> - количество байт </param>
+/// <returns> N>0 - записано N байт; -2 - собеседник закрыл канал; -3 - канал полон </returns>
+int network::pipeTransport_t::RawSend(const char* data, size_t size)
+{
+    channel_t& channel = *tx;
+    if (channel.b_readerClosed)
+        return -2;
+
+    size_t used = channel.written - channel.read;
+    if (used >= profile.capacity)
+        return -3;
+
+    size_t count = std::min(size, profile.capacity - used);
+    if (profile.maxWrite != 0)
+        count = std::min(count, profile.maxWrite);
+
+    channel.bytes.append(data, count);
+    channel.written += count;
+    // запись уходит в канал после предыдущих, передача занимает count / bandwidth, доставка - еще latency
+    clock_t::time_point now = clock_t::now();
+    clock_t::time_point start = std::max(now, channel.linkFree);
+    channel.linkFree = start;
+    if (profile.bandwidth != 0)
+        channel.linkFree += std::chrono::nanoseconds(count * 1000000000ull / profile.bandwidth);
+    clock_t::time_point ready = channel.linkFree + std::chrono::microseconds(profile.latency);
+    if (ready <= now)
+        channel.delivered = channel.written; // без задержки запись сразу доступна, очередь не растет
+    else
+        channel.d_segment.push_back({ ready, channel.written });
+    return static_cast<int>(count);
+}
+
+/// <summary>
+/// Метод проверки наличия канала
+/// </summary>
+/// <returns> 1 - канал есть </returns>
+bool network::pipeTransport_t::RawValid()
+{
+    return rx && tx;
+}
+
+/// <summary>
+/// Метод проверки режима: канал всегда неблокирующий
+/// </summary>
+/// <returns> 1 </returns>
+bool network::pipeTransport_t::NonBlocking() const
+{
+    return true;
+}
+
+/// <summary>
+/// Метод продвижения доставки: записи, время которых пришло, становятся доступны для чтения
+/// </summary>
+/// <param name="channel"> - направление канала </param>
+void network::pipeTransport_t::Deliver(channel_t& channel)
+{
+    if (channel.d_segment.empty())
+        return;
+
+    clock_t::time_point now = clock_t::now();
+    while (!channel.d_segment.empty() && channel.d_segment.front().ready <= now)
+    {
+        channel.delivered = channel.d_segment.front().end;
+        channel.d_segment.pop_front();
+    }
+}
+
+/// <summary>
+/// Метод отбрасывания байт в пути и непрочитанных байт направления
+/// </summary>
+/// <param name="channel"> - направление канала </param>
+void network::pipeTransport_t::Drop(channel_t& channel)
+{
+    channel.bytes.clear();
+    channel.d_segment.clear();
+    channel.dropped = channel.delivered = channel.read = channel.written;
+}
@@ -0,0 +1,142 @@
+﻿#pragma once
+#ifndef PIPE_H_
+#define PIPE_H_
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "network.h"
+
+/// <summary>
+/// простанство имен классов для работы с сетью
+/// </summary>
+namespace network
+{
+    /// <summary>
+    /// Параметры канала в памяти
+    /// </summary>
+    struct pipeProfile_t
+    {
+        unsigned latency = 0; // задержка доставки, мкс
+        size_t bandwidth = 0; // пропускная способность, байт/с (0 - без ограничения)
+        size_t maxWrite = 0; // наибольшая порция одной записи, байт (0 - без ограничения); меньше кадра - частичные отправки
+        size_t capacity = 256 * 1024; // емкость направления (байты в пути и непрочитанные), сверх нее запись не принимается
+        bool b_dropOnClose = false; // закрытие отбрасывает недоставленные байты обоих направлений, как разрыв с RST
+    };
+
+    /// <summary>
+    /// Класс транспорта через канал в памяти процесса: пара объектов соединяется методом Connect(), байты одного
+    /// доходят до другого без ядра и сокетов. Канал моделирует задержку, пропускную способность, частичные записи
+    /// и закрытие с потерей данных в пути, поэтому разбор кадров, буфер исходящих и дописывание частичных отправок
+    /// проверяются и измеряются в изоляции от сети. Объекты пары используются из одного потока
+    /// </summary>
+    class pipeTransport_t : public transport_t
+    {
+    public:
+        /// <summary>
+        /// конструктор, транспорт не соединен
+        /// </summary>
+        /// <param name="logger"> - объект для логгирования </param>
+        pipeTransport_t(log_t& logger);
+
+        /// <summary>
+        /// деструктор, закрывает канал
+        /// </summary>
+        virtual ~pipeTransport_t();
+
+        /// <summary>
+        /// Метод соединения пары транспортов новым каналом; прежние каналы закрываются
+        /// </summary>
+        /// <param name="first"> - первый транспорт </param>
+        /// <param name="second"> - второй транспорт </param>
+        /// <param name="profile"> - параметры канала (общие для обоих направлений) </param>
+        static void Connect(pipeTransport_t& first, pipeTransport_t& second, const pipeProfile_t& profile);
+
+        /// <summary>
+        /// Метод закрытия канала: собеседник дочитывает доставленное (либо теряет его при b_dropOnClose)
+        /// и получает закрытие соединения, его запись возвращает -2
+        /// </summary>
+        void Shutdown() override;
+
+        /// <summary>
+        /// Метод проверки готовности к приему: есть доставленные байты либо канал закрыт собеседником
+        /// </summary>
+        /// <returns> 1 - прием не вернет -3 </returns>
+        bool Readable();
+    protected:
+        typedef std::chrono::steady_clock clock_t;
+
+        /// <summary>
+        /// запись в пути: время доставки и конец записи в потоке направления
+        /// </summary>
+        struct segment_t
+        {
+            clock_t::time_point ready; // время доставки
+            size_t end; // позиция конца записи от начала потока
+        };
+
+        /// <summary>
+        /// одно направление канала
+        /// </summary>
+        struct channel_t
+        {
+            std::string bytes; // байты потока с позиции dropped
+            std::deque<segment_t> d_segment; // записи в пути
+            size_t dropped = 0; // позиция потока, с которой начинается bytes
+            size_t written = 0; // записано байт
+            size_t delivered = 0; // доставлено байт
+            size_t read = 0; // прочитано байт
+            clock_t::time_point linkFree; // время, когда канал закончит передачу записанного
+            bool b_writerClosed = false; // пишущая сторона закрыла канал
+            bool b_readerClosed = false; // читающая сторона закрыла канал
+        };
+
+        /// <summary>
+        /// Метод приема доставленных байт
+        /// </summary>
+        /// <param name="data"> - буфер приема </param>
+        /// <param name="size"> - размер буфера </param>
+        /// <returns> N>0 - принято N байт; 0 - соединение закрыто; -3 - данных нет </returns>
+        int RawRecive(char* data, size_t size) override;
+
+        /// <summary>
+        /// Метод записи байт в канал, не больше maxWrite и свободной емкости
+        /// </summary>
+        /// <param name="data"> - данные для отправки </param>
+        /// <param name="size"> - количество байт </param>
+        /// <returns> N>0 - записано N байт; -2 - собеседник закрыл канал; -3 - канал полон </returns>
+        int RawSend(const char* data, size_t size) override;
+
+        /// <summary>
+        /// Метод проверки наличия канала
+        /// </summary>
+        /// <returns> 1 - канал есть </returns>
+        bool RawValid() override;
+
+        /// <summary>
+        /// Метод проверки режима: канал всегда неблокирующий
+        /// </summary>
+        /// <returns> 1 </returns>
+        bool NonBlocking() const override;
+
+        /// <summary>
+        /// Метод продвижения доставки: записи, время которых пришло, становятся доступны для чтения
+        /// </summary>
+        /// <param name="channel"> - направление канала </param>
+        static void Deliver(channel_t& channel);
+
+        /// <summary>
+        /// Метод отбрасывания байт в пути и непрочитанных байт направления
+        /// </summary>
+        /// <param name="channel"> - направление канала </param>
+        static void Drop(channel_t& channel);
+
+        pipeProfile_t profile; // параметры канала
+        std::shared_ptr<channel_t> rx; // входящее направление
+        std::shared_ptr<channel_t> tx; // исходящее направление
+    };
+}
+
+#endif /* PIPE_H_ */
@@ -0,0 +1,118 @@
+﻿#pragma once
+#ifndef QUEUE_H_
+#define QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Ограниченная очередь без блокировок для одного писателя и одного читателя (SPSC).
+/// Емкость округляется вверх до степени двойки. Индексы писателя и читателя лежат в разных
+/// строках кэша, каждая сторона держит копию чужого индекса и перечитывает его только когда
+/// очередь кажется полной (пустой), поэтому в установившемся режиме стороны не делят строки кэша.
+/// Ячейки создаются один раз и переиспользуются: элементы перемещаются в ячейку и из нее
+/// </summary>
+/// <typeparam name="T"> -- тип элемента, должен перемещаться </typeparam>
+template <typename T>
+class spscQueue_t
+{
+public:
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="capacity"> -- наименьшая емкость очереди </param>
+    explicit spscQueue_t(size_t capacity) : v_slot(RoundUp(capacity)), mask(v_slot.size() - 1)
+    {}
+
+    spscQueue_t(const spscQueue_t&) = delete;
+    spscQueue_t& operator = (const spscQueue_t&) = delete;
+
+    /// <summary>
+    /// метод добавления элемента, вызывает только писатель
+    /// </summary>
+    /// <param name="value"> -- элемент, перемещается в очередь при успехе </param>
+    /// <returns> 1 -- элемент добавлен; 0 -- очередь полна </returns>
+    bool Push(T&& value)
+    {
+        size_t tail = writer.index.load(std::memory_order_relaxed);
+        if (tail - writer.cache == v_slot.size())
+        {   // по копии очередь полна - смотрим, сколько забрал читатель
+            writer.cache = reader.index.load(std::memory_order_acquire);
+            if (tail - writer.cache == v_slot.size())
+                return false;
+        }
+        v_slot[tail & mask] = std::move(value);
+        writer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// метод извлечения элемента, вызывает только читатель
+    /// </summary>
+    /// <param name="value"> -- извлеченный элемент </param>
+    /// <returns> 1 -- элемент извлечен; 0 -- очередь пуста </returns>
+    bool Pop(T& value)
+    {
+        size_t head = reader.index.load(std::memory_order_relaxed);
+        if (head == reader.cache)
+        {   // по копии очередь пуста - смотрим, сколько добавил писатель
+            reader.cache = writer.index.load(std::memory_order_acquire);
+            if (head == reader.cache)
+                return false;
+        }
+        value = std::move(v_slot[head & mask]);
+        reader.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// метод проверки пустой очереди (приблизительно, если другая сторона работает)
+    /// </summary>
+    /// <returns> 1 -- очередь пуста </returns>
+    bool Empty() const
+    {
+        return writer.index.load(std::memory_order_acquire) == reader.index.load(std::memory_order_acquire);
+    }
+
+    /// <summary>
+    /// метод возврата емкости очереди
+    /// </summary>
+    /// <returns> емкость </returns>
+    size_t Capacity() const
+    {
+        return v_slot.size();
+    }
+protected:
+    static const size_t cacheLine = 64; // размер строки кэша
+
+    /// <summary>
+    /// индекс одной стороны и ее копия индекса другой стороны, в отдельной строке кэша
+    /// </summary>
+    struct alignas(cacheLine) side_t
+    {
+        std::atomic<size_t> index{ 0 }; // свой индекс
+        size_t cache = 0; // последний прочитанный индекс другой стороны
+    };
+
+    /// <summary>
+    /// метод округления емкости до степени двойки
+    /// </summary>
+    /// <param name="capacity"> -- емкость </param>
+    /// <returns> степень двойки не меньше capacity </returns>
+    static size_t RoundUp(size_t capacity)
+    {
+        size_t result = 2;
+        while (result < capacity)
+            result <<= 1;
+        return result;
+    }
+
+    std::vector<T> v_slot; // ячейки очереди
+    const size_t mask; // маска индекса ячейки
+    side_t writer; // сторона писателя
+    side_t reader; // сторона читателя
+};
+
+#endif /* QUEUE_H_ */
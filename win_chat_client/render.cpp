@@ -0,0 +1,136 @@
+﻿#include "render.h"
+
+#include <cstdio>
+#include <iostream>
+
+#ifndef __WIN32__
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="ringSize"> -- количество строк в кольце прокрутки </param>
+/// <param name="period"> -- наименьший период вывода на терминал </param>
+/// <param name="maxPending"> -- наибольший объем вывода за период, байт </param>
+render_t::render_t(size_t ringSize, std::chrono::milliseconds period, size_t maxPending) : v_ring(ringSize ? ringSize : 1), head(0), count(0), skipped(0), period(period), maxPending(maxPending)
+{
+    out.reserve(maxPending);
+}
+
+/// <summary>
+/// метод вывода строки чата: строка попадает в кольцо прокрутки и в буфер вывода
+/// </summary>
+/// <param name="text"> -- строка без перевода строки </param>
+void render_t::Line(std::string_view text)
+{
+    v_ring[head].assign(text.data(), text.size()); // память ячейки остается от прошлой строки
+    head = (head + 1) % v_ring.size();
+    if (count < v_ring.size())
+        ++count;
+
+    if (out.size() + text.size() + 1 <= maxPending)
+        out.append(text.data(), text.size()).push_back('\n');
+    else
+        ++skipped; // терминал не успевает, строка остается только в кольце
+}
+
+/// <summary>
+/// метод вывода служебного текста (справка, диагностика, страница прокрутки), в кольцо не попадает
+/// </summary>
+/// <param name="text"> -- текст, включая переводы строк </param>
+void render_t::Text(std::string_view text)
+{
+    out.append(text.data(), text.size());
+}
+
+/// <summary>
+/// метод вывода страницы кольца прокрутки
+/// </summary>
+/// <param name="page"> -- номер страницы от последней строки назад, с 1 </param>
+void render_t::Page(size_t page)
+{
+    if (page == 0)
+        page = 1;
+    size_t pages = (count + pageSize - 1) / pageSize;
+    if (page > pages)
+    {
+        out.append("SYSTEM MSG: scrollback has ").append(std::to_string(pages)).append(" page(s)\n");
+        return;
+    }
+
+    // строки страницы: от (count - page * pageSize) до (count - (page - 1) * pageSize), отсчет от самой старой
+    size_t last = count - (page - 1) * pageSize;
+    size_t first = last > pageSize ? last - pageSize : 0;
+    size_t oldest = (head + v_ring.size() - count) % v_ring.size();
+    out.append("---- page ").append(std::to_string(page)).append('/' + std::to_string(pages)).append(" ----\n");
+    for (size_t indx = first; indx < last; ++indx)
+        out.append(v_ring[(oldest + indx) % v_ring.size()]).push_back('\n');
+    out.append("----\n");
+}
+
+/// <summary>
+/// метод вывода накопленного текста на терминал одним вызовом write()
+/// </summary>
+/// <param name="b_force"> -- вывести, не дожидаясь окончания периода </param>
+/// <returns> 1 -- текст выведен </returns>
+bool render_t::Flush(bool b_force)
+{
+    if (out.empty() && skipped == 0)
+        return false;
+
+    clock_t::time_point now = clock_t::now();
+    if (!b_force && now - lastFlush < period)
+        return false;
+
+    if (skipped)
+    {
+        out.append("SYSTEM MSG: ").append(std::to_string(skipped)).append(" line(s) not shown, use PAGE <n> to scroll back\n");
+        skipped = 0;
+    }
+    Write(out.data(), out.size());
+    out.clear();
+    lastFlush = now;
+
+    return true;
+}
+
+/// <summary>
+/// метод расчета времени до следующего вывода (для таймаута ожидания событий)
+/// </summary>
+/// <returns> миллисекунды до вывода; -1 -- выводить нечего </returns>
+int render_t::Due() const
+{
+    if (out.empty() && skipped == 0)
+        return -1;
+
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(lastFlush + period - clock_t::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+/// <summary>
+/// метод записи в стандартный вывод
+/// </summary>
+/// <param name="data"> -- данные </param>
+/// <param name="size"> -- размер данных </param>
+void render_t::Write(const char* data, size_t size)
+{
+    std::cout.flush(); // лог и printf пишут через буферы потоков, сохраняем порядок вывода
+    fflush(stdout);
+#ifdef __WIN32__
+    fwrite(data, 1, size, stdout);
+    fflush(stdout);
+#else // мимо буфера stdio, одним системным вызовом
+    while (size > 0)
+    {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) // терминал закрыт, выводить некуда
+            break;
+        data += written;
+        size -= written;
+    }
+#endif
+}
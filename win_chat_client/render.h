@@ -0,0 +1,79 @@
+﻿#pragma once
+#ifndef RENDER_H_
+#define RENDER_H_
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>
+/// Класс вывода на терминал. Все строки такта копятся в одном буфере и выводятся одним вызовом write()
+/// не чаще заданного периода. Если терминал не успевает за входящим потоком, лишние строки на экран
+/// не выводятся (прием не ждет терминал), но все строки сохраняются в кольце прокрутки
+/// фиксированного размера, по которому можно листать назад методом Page()
+/// </summary>
+class render_t
+{
+public:
+    typedef std::chrono::steady_clock clock_t;
+
+    static const size_t pageSize = 20; // строк на странице прокрутки
+
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="ringSize"> -- количество строк в кольце прокрутки </param>
+    /// <param name="period"> -- наименьший период вывода на терминал </param>
+    /// <param name="maxPending"> -- наибольший объем вывода за период, байт </param>
+    render_t(size_t ringSize = 1000, std::chrono::milliseconds period = std::chrono::milliseconds(16), size_t maxPending = 64 * 1024);
+
+    /// <summary>
+    /// метод вывода строки чата: строка попадает в кольцо прокрутки и в буфер вывода
+    /// </summary>
+    /// <param name="text"> -- строка без перевода строки </param>
+    void Line(std::string_view text);
+
+    /// <summary>
+    /// метод вывода служебного текста (справка, диагностика, страница прокрутки), в кольцо не попадает
+    /// </summary>
+    /// <param name="text"> -- текст, включая переводы строк </param>
+    void Text(std::string_view text);
+
+    /// <summary>
+    /// метод вывода страницы кольца прокрутки
+    /// </summary>
+    /// <param name="page"> -- номер страницы от последней строки назад, с 1 </param>
+    void Page(size_t page);
+
+    /// <summary>
+    /// метод вывода накопленного текста на терминал одним вызовом write()
+    /// </summary>
+    /// <param name="b_force"> -- вывести, не дожидаясь окончания периода </param>
+    /// <returns> 1 -- текст выведен </returns>
+    bool Flush(bool b_force = false);
+
+    /// <summary>
+    /// метод расчета времени до следующего вывода (для таймаута ожидания событий)
+    /// </summary>
+    /// <returns> миллисекунды до вывода; -1 -- выводить нечего </returns>
+    int Due() const;
+protected:
+    /// <summary>
+    /// метод записи в стандартный вывод
+    /// </summary>
+    /// <param name="data"> -- данные </param>
+    /// <param name="size"> -- размер данных </param>
+    void Write(const char* data, size_t size);
+
+    std::vector<std::string> v_ring; // кольцо прокрутки, строки переиспользуют свою память
+    size_t head; // ячейка кольца для следующей строки
+    size_t count; // количество строк в кольце
+    std::string out; // буфер вывода до следующего Flush()
+    size_t skipped; // строк не выведено на экран с прошлого вывода
+    clock_t::time_point lastFlush; // время последнего вывода
+    std::chrono::milliseconds period; // наименьший период вывода
+    size_t maxPending; // наибольший объем вывода за период
+};
+
+#endif /* RENDER_H_ */
@@ -0,0 +1,317 @@
+﻿#include "scanner.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    /// <summary>
+    /// функция возврата номера младшего установленного бита
+    /// </summary>
+    /// <param name="mask"> - ненулевая маска </param>
+    /// <returns> номер младшего установленного бита </returns>
+    inline unsigned FirstBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+#ifdef SCANNER_X86
+    /// <summary>
+    /// функция проверки поддержки AVX2 процессором и операционной системой
+    /// </summary>
+    /// <returns> 1 - AVX2 доступен </returns>
+    bool SupportAVX2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0; // ОС сохраняет расширенные регистры
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) // регистры YMM сохраняются при переключении контекста?
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init(); // вызов может произойти до main(), при статической инициализации
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    /// <summary>
+    /// функция проверки поддержки SSE2 процессором
+    /// </summary>
+    /// <returns> 1 - SSE2 доступен </returns>
+    bool SupportSSE2()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        return true; // входит в базовый набор x86-64
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+#endif
+    }
+#endif
+}
+
+const network::delimiterScanner_t::search_t network::delimiterScanner_t::search = network::delimiterScanner_t::SelectSearch();
+
+/// <summary>
+/// скалярный поиск разделителя
+/// </summary>
+size_t network::delimiterScanner_t::SearchScalar(const char* data, size_t size, const char* delimiter, size_t len)
+{
+    size_t pos = 0;
+    while (pos + len <= size)
+    {   // ищем первый символ разделителя, затем сверяем остальные
+        const char* first = static_cast<const char*>(memchr(data + pos, delimiter[0], size - pos - len + 1));
+        if (!first)
+            break;
+        pos = first - data;
+        if (!memcmp(first + 1, delimiter + 1, len - 1))
+            return pos;
+        ++pos;
+    }
+    return size;
+}
+
+#ifdef SCANNER_X86
+/// <summary>
+/// поиск разделителя по 16 байт (SSE2): за одно сравнение отбираются позиции,
+/// где совпадают и первый, и последний символ разделителя, затем кандидаты сверяются полностью
+/// </summary>
+TARGET_SSE2 size_t network::delimiterScanner_t::SearchSSE2(const char* data, size_t size, const char* delimiter, size_t len)
+{
+    const __m128i first = _mm_set1_epi8(delimiter[0]);
+    const __m128i last = _mm_set1_epi8(delimiter[len - 1]);
+    size_t pos = 0;
+    // пока последний символ разделителя для всех 16 кандидатов внутри буфера
+    for (; pos + 15 + len <= size; pos += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + len - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+        while (mask)
+        {   // кандидаты проверяем слева направо
+            unsigned bit = FirstBit(mask);
+            if (len <= 2 || !memcmp(data + pos + bit + 1, delimiter + 1, len - 2))
+                return pos + bit;
+            mask &= mask - 1;
+        }
+    }
+    // остаток буфера
+    size_t found = SearchScalar(data + pos, size - pos, delimiter, len);
+    return found == size - pos ? size : pos + found;
+}
+
+/// <summary>
+/// поиск разделителя по 32 байта (AVX2), алгоритм аналогичен SSE2
+/// </summary>
+TARGET_AVX2 size_t network::delimiterScanner_t::SearchAVX2(const char* data, size_t size, const char* delimiter, size_t len)
+{
+    const __m256i first = _mm256_set1_epi8(delimiter[0]);
+    const __m256i last = _mm256_set1_epi8(delimiter[len - 1]);
+    size_t pos = 0;
+    for (; pos + 31 + len <= size; pos += 32)
+    {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + len - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast)));
+        while (mask)
+        {
+            unsigned bit = FirstBit(mask);
+            if (len <= 2 || !memcmp(data + pos + bit + 1, delimiter + 1, len - 2))
+                return pos + bit;
+            mask &= mask - 1;
+        }
+    }
+    size_t found = SearchScalar(data + pos, size - pos, delimiter, len);
+    return found == size - pos ? size : pos + found;
+}
+#else
+size_t network::delimiterScanner_t::SearchSSE2(const char* data, size_t size, const char* delimiter, size_t len)
+{
+    return SearchScalar(data, size, delimiter, len);
+}
+
+size_t network::delimiterScanner_t::SearchAVX2(const char* data, size_t size, const char* delimiter, size_t len)
+{
+    return SearchScalar(data, size, delimiter, len);
+}
+#endif
+
+/// <summary>
+/// метод выбора реализации поиска по возможностям процессора
+/// </summary>
+/// <returns> указатель на функцию поиска </returns>
+network::delimiterScanner_t::search_t network::delimiterScanner_t::SelectSearch()
+{
+#ifdef SCANNER_X86
+    if (SupportAVX2())
+        return &SearchAVX2;
+    if (SupportSSE2())
+        return &SearchSSE2;
+#endif
+    return &SearchScalar;
+}
+
+/// <summary>
+/// метод отката частичного совпадения: находит более короткое начало разделителя,
+/// которым заканчивается уже совпавшая часть
+/// </summary>
+/// <param name="matched"> - количество совпавших байт </param>
+/// <returns> новое количество совпавших байт </returns>
+size_t network::delimiterScanner_t::Fallback(size_t matched) const
+{   // совпавшая часть равна началу разделителя, поэтому сравниваем разделитель сам с собой
+    for (size_t k = matched - 1; k > 0; --k)
+        if (!memcmp(delimiter.data() + matched - k, delimiter.data(), k))
+            return k;
+    return 0;
+}
+
+/// <summary>
+/// конструктор по умолчанию, разделитель не задан
+/// </summary>
+network::delimiterScanner_t::delimiterScanner_t() : matched(0)
+{}
+
+/// <summary>
+/// конструктор с одним параметром
+/// </summary>
+/// <param name="delimiter"> - разделитель </param>
+network::delimiterScanner_t::delimiterScanner_t(const std::string& delimiter) : delimiter(delimiter), matched(0)
+{}
+
+/// <summary>
+/// метод задания разделителя, сбрасывает состояние поиска
+/// </summary>
+/// <param name="delimiter"> - разделитель </param>
+void network::delimiterScanner_t::SetDelimiter(const std::string& delimiter)
+{
+    this->delimiter = delimiter;
+    matched = 0;
+}
+
+/// <summary>
+/// метод возврата разделителя
+/// </summary>
+/// <returns> разделитель </returns>
+const std::string& network::delimiterScanner_t::Delimiter() const
+{
+    return delimiter;
+}
+
+/// <summary>
+/// метод сброса состояния поиска (начало нового потока)
+/// </summary>
+void network::delimiterScanner_t::Reset()
+{
+    matched = 0;
+}
+
+/// <summary>
+/// метод возврата количества байт разделителя, совпавших в конце последнего куска
+/// </summary>
+/// <returns> количество байт незавершенного разделителя </returns>
+size_t network::delimiterScanner_t::Matched() const
+{
+    return matched;
+}
+
+/// <summary>
+/// метод поиска всех разделителей в очередном куске потока
+/// </summary>
+/// <param name="data"> - новые байты потока </param>
+/// <param name="size"> - количество новых байт </param>
+/// <param name="v_bounds"> - массив, в конец которого добавляются границы кадров:
+///  смещения от начала data байта, следующего за разделителем </param>
+/// <returns> количество найденных границ </returns>
+size_t network::delimiterScanner_t::Scan(const char* data, size_t size, std::vector<size_t>& v_bounds)
+{
+    size_t count = 0; // количество найденных границ
+    size_t len = delimiter.size(); // размер разделителя
+    size_t pos = 0; // начало еще не просмотренной части куска
+
+    if (len == 0 || size == 0)
+        return count;
+
+    // 1. дописываем разделитель, начатый в предыдущем куске
+    while (matched > 0)
+    {
+        size_t need = len - matched; // сколько байт разделителя не хватает
+        size_t avail = need < size ? need : size;
+        if (!memcmp(data, delimiter.data() + matched, avail))
+        {
+            if (avail < need)
+            {   // кусок целиком ушел на продолжение разделителя
+                matched += avail;
+                return count;
+            }
+            matched = 0;
+            pos = need;
+            v_bounds.push_back(pos);
+            ++count;
+        }
+        else
+            matched = Fallback(matched); // пробуем более короткое начало
+    }
+
+    // 2. полные разделители внутри куска
+    while (pos < size)
+    {
+        size_t found = search(data + pos, size - pos, delimiter.data(), len);
+        if (found == size - pos)
+            break;
+        pos += found + len;
+        v_bounds.push_back(pos);
+        ++count;
+    }
+
+    // 3. запоминаем начало разделителя в хвосте куска
+    size_t tail = size - pos; // длина непросмотренного хвоста
+    for (size_t k = (len - 1 < tail ? len - 1 : tail); k > 0; --k)
+        if (!memcmp(data + size - k, delimiter.data(), k))
+        {
+            matched = k;
+            break;
+        }
+
+    return count;
+}
+
+/// <summary>
+/// метод возврата названия выбранной реализации поиска
+/// </summary>
+/// <returns> "avx2", "sse2" или "scalar" </returns>
+const char* network::delimiterScanner_t::Implementation()
+{
+    if (search == &SearchAVX2)
+        return "avx2";
+    if (search == &SearchSSE2)
+        return "sse2";
+    return "scalar";
+}
@@ -0,0 +1,116 @@
+﻿#pragma once
+#ifndef SCANNER_H_
+#define SCANNER_H_
+
+#include <string>
+#include <vector>
+
+/// <summary>
+/// простанство имен классов для работы с сетью
+/// </summary>
+namespace network
+{
+    /// <summary>
+    /// Класс поиска многобайтного разделителя (конца сообщения) в потоке данных.
+    /// Просматривает только новые байты, помнит начало разделителя, разорванного между кусками потока.
+    /// Реализация поиска (AVX2, SSE2 или скалярная) выбирается один раз при запуске программы
+    /// </summary>
+    class delimiterScanner_t
+    {
+    protected:
+        /// <summary>
+        /// тип функции поиска первого полного вхождения разделителя в буфере
+        /// </summary>
+        /// <param name="data"> - буфер </param>
+        /// <param name="size"> - размер буфера </param>
+        /// <param name="delimiter"> - разделитель </param>
+        /// <param name="len"> - размер разделителя (не меньше 1) </param>
+        /// <returns> позиция начала разделителя; size - разделитель не найден </returns>
+        typedef size_t(*search_t)(const char* data, size_t size, const char* delimiter, size_t len);
+
+        /// <summary>
+        /// скалярный поиск разделителя
+        /// </summary>
+        static size_t SearchScalar(const char* data, size_t size, const char* delimiter, size_t len);
+
+        /// <summary>
+        /// поиск разделителя по 16 байт (SSE2)
+        /// </summary>
+        static size_t SearchSSE2(const char* data, size_t size, const char* delimiter, size_t len);
+
+        /// <summary>
+        /// поиск разделителя по 32 байта (AVX2)
+        /// </summary>
+        static size_t SearchAVX2(const char* data, size_t size, const char* delimiter, size_t len);
+
+        /// <summary>
+        /// метод выбора реализации поиска по возможностям процессора
+        /// </summary>
+        /// <returns> указатель на функцию поиска </returns>
+        static search_t SelectSearch();
+
+        /// <summary>
+        /// метод отката частичного совпадения: находит более короткое начало разделителя,
+        /// которым заканчивается уже совпавшая часть
+        /// </summary>
+        /// <param name="matched"> - количество совпавших байт </param>
+        /// <returns> новое количество совпавших байт </returns>
+        size_t Fallback(size_t matched) const;
+    public:
+        /// <summary>
+        /// конструктор по умолчанию, разделитель не задан
+        /// </summary>
+        delimiterScanner_t();
+
+        /// <summary>
+        /// конструктор с одним параметром
+        /// </summary>
+        /// <param name="delimiter"> - разделитель </param>
+        delimiterScanner_t(const std::string& delimiter);
+
+        /// <summary>
+        /// метод задания разделителя, сбрасывает состояние поиска
+        /// </summary>
+        /// <param name="delimiter"> - разделитель </param>
+        void SetDelimiter(const std::string& delimiter);
+
+        /// <summary>
+        /// метод возврата разделителя
+        /// </summary>
+        /// <returns> разделитель </returns>
+        const std::string& Delimiter() const;
+
+        /// <summary>
+        /// метод сброса состояния поиска (начало нового потока)
+        /// </summary>
+        void Reset();
+
+        /// <summary>
+        /// метод возврата количества байт разделителя, совпавших в конце последнего куска
+        /// </summary>
+        /// <returns> количество байт незавершенного разделителя </returns>
+        size_t Matched() const;
+
+        /// <summary>
+        /// метод поиска всех разделителей в очередном куске потока
+        /// </summary>
+        /// <param name="data"> - новые байты потока </param>
+        /// <param name="size"> - количество новых байт </param>
+        /// <param name="v_bounds"> - массив, в конец которого добавляются границы кадров:
+        ///  смещения от начала data байта, следующего за разделителем </param>
+        /// <returns> количество найденных границ </returns>
+        size_t Scan(const char* data, size_t size, std::vector<size_t>& v_bounds);
+
+        /// <summary>
+        /// метод возврата названия выбранной реализации поиска
+        /// </summary>
+        /// <returns> "avx2", "sse2" или "scalar" </returns>
+        static const char* Implementation();
+    protected:
+        std::string delimiter; // разделитель
+        size_t matched; // количество байт разделителя, совпавших в конце предыдущего куска
+        static const search_t search; // выбранная реализация поиска
+    };
+};
+
+#endif /* SCANNER_H_ */
@@ -0,0 +1,451 @@
+﻿#include "search.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+static const char indexMagic[8] = { 'C', 'H', 'A', 'T', 'F', 'T', 'S', '2' }; // сигнатура файла индекса
+
+/// <summary>
+/// функция записи числа в формате varint (по 7 бит в байте, старший бит - продолжение)
+/// </summary>
+/// <param name="out"> -- строка, в конец которой пишется число </param>
+/// <param name="value"> -- число </param>
+static void PutVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/// <summary>
+/// функция чтения числа в формате varint
+/// </summary>
+/// <param name="data"> -- данные </param>
+/// <param name="pos"> -- позиция числа, сдвигается за число </param>
+/// <param name="value"> -- число </param>
+/// <returns> 1 -- число прочитано </returns>
+static bool GetVarint(std::string_view data, size_t& pos, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; pos < data.size() && shift < 64; shift += 7)
+    {
+        unsigned char byte = static_cast<unsigned char>(data[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+/// <summary>
+/// конструктор, курсор встает на первую запись
+/// </summary>
+/// <param name="posting"> -- список записей </param>
+searchIndex_t::cursor_t::cursor_t(const posting_t& posting) : posting(&posting), pos(0), doc(0), b_end(false)
+{
+    Next();
+}
+
+/// <summary>
+/// метод перехода к следующей записи
+/// </summary>
+/// <returns> 1 -- запись есть </returns>
+bool searchIndex_t::cursor_t::Next()
+{
+    uint64_t delta = 0;
+    if (b_end || !GetVarint(posting->data, pos, delta))
+    {
+        b_end = true;
+        return false;
+    }
+    doc += delta;
+    return true;
+}
+
+/// <summary>
+/// метод перехода к первой записи не меньше заданной
+/// </summary>
+/// <param name="target"> -- смещение записи </param>
+/// <returns> 1 -- запись есть </returns>
+bool searchIndex_t::cursor_t::SkipTo(uint64_t target)
+{
+    if (b_end)
+        return false;
+    if (doc >= target)
+        return true;
+
+    // последняя точка пропуска перед target; назад не возвращаемся
+    const std::vector<skip_t>& v_skip = posting->v_skip;
+    auto iter = std::lower_bound(v_skip.begin(), v_skip.end(), target, [](const skip_t& skip, uint64_t value) { return skip.prev < value; });
+    if (iter != v_skip.begin() && (iter - 1)->pos >= pos)
+    {
+        pos = (iter - 1)->pos;
+        doc = (iter - 1)->prev;
+    }
+    while (doc < target)
+        if (!Next())
+            return false;
+    return true;
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="history"> -- индексируемая история </param>
+/// <param name="logger"> -- объект для логгирования </param>
+searchIndex_t::searchIndex_t(const history_t& history, log_t& logger) : indexed(0), records(0), lastRecord(0), b_open(false), history(history), logger(logger)
+{}
+
+/// <summary>
+/// деструктор, сохраняет индекс
+/// </summary>
+searchIndex_t::~searchIndex_t()
+{
+    Close();
+}
+
+/// <summary>
+/// метод открытия индекса: загрузка сохраненного индекса, если он есть
+/// </summary>
+/// <param name="path"> -- путь к файлу индекса без расширения </param>
+/// <returns> 1 -- сохраненный индекс загружен; 0 -- индекс строится заново </returns>
+bool searchIndex_t::Open(const std::string& path)
+{
+    Close();
+    if (history.End() == 0) // без истории индексировать нечего, сохраненный индекс не трогаем
+        return false;
+
+    this->path = path + ".fts";
+    b_open = true;
+    bool b_result = Load();
+    if (!b_result)
+    {   // индекса нет либо он от другой истории - строим заново в Update()
+        m_posting.clear();
+        indexed = history.Begin();
+        records = 0;
+        lastRecord = 0;
+    }
+    return b_result;
+}
+
+/// <summary>
+/// метод сохранения и закрытия индекса
+/// </summary>
+void searchIndex_t::Close()
+{
+    if (!b_open)
+        return;
+    Save();
+    b_open = false;
+    m_posting.clear();
+}
+
+/// <summary>
+/// метод дополнения индекса записями, добавленными в историю
+/// </summary>
+/// <param name="budget"> -- наибольшее количество записей за вызов </param>
+/// <returns> количество проиндексированных записей </returns>
+size_t searchIndex_t::Update(size_t budget)
+{
+    size_t count = 0;
+    uint64_t end = history.End();
+    history_t::record_t record;
+
+    while (b_open && indexed < end && count < budget)
+    {
+        uint64_t next = history.Read(indexed, record);
+        if (next == 0)
+        {   // испорченная запись: дальше история не читается
+            indexed = end;
+            break;
+        }
+        Add(indexed, record.text);
+        lastRecord = indexed;
+        indexed = next;
+        ++records;
+        ++count;
+    }
+
+    return count;
+}
+
+/// <summary>
+/// метод поиска записей, содержащих все слова запроса
+/// </summary>
+/// <param name="words"> -- слова запроса через пробел </param>
+/// <param name="v_result"> -- смещения последних найденных записей по возрастанию </param>
+/// <param name="limit"> -- наибольшее количество смещений в v_result </param>
+/// <returns> количество найденных записей (может быть больше limit) </returns>
+size_t searchIndex_t::Find(std::string_view words, std::vector<uint64_t>& v_result, size_t limit) const
+{
+    v_result.clear();
+
+    std::vector<std::string> v_query;
+    size_t size = Split(words, v_query);
+    if (size == 0)
+        return 0;
+
+    std::vector<cursor_t> v_cursor;
+    for (size_t indx = 0; indx < size; ++indx)
+    {
+        auto iter = m_posting.find(v_query[indx]);
+        if (iter == m_posting.end()) // слова нет ни в одной записи
+            return 0;
+        v_cursor.emplace_back(iter->second);
+    }
+    // ведет самый короткий список, остальные только пропускают до его записей
+    std::sort(v_cursor.begin(), v_cursor.end(), [](const cursor_t& left, const cursor_t& right) { return left.posting->count < right.posting->count; });
+
+    size_t total = 0; // найдено записей
+    size_t skipped = 0; // записей пропущено без чтения в кольцо
+    cursor_t& lead = v_cursor.front();
+    if (v_cursor.size() == 1 && lead.posting->count > limit)
+    {   // одно слово: все записи списка совпадают, читаем только хвост от нужной точки пропуска
+        skipped = lead.posting->count - limit;
+        const skip_t& skip = lead.posting->v_skip[skipped / skipStep];
+        lead.pos = skip.pos;
+        lead.doc = skip.prev;
+        lead.Next();
+        for (size_t indx = skipped / skipStep * skipStep; indx < skipped; ++indx)
+            lead.Next();
+    }
+    while (!lead.b_end)
+    {
+        uint64_t candidate = lead.doc;
+        bool b_match = true;
+        for (size_t indx = 1; indx < v_cursor.size() && b_match; ++indx)
+        {
+            if (!v_cursor[indx].SkipTo(candidate)) // один из списков закончился - совпадений больше нет
+            {
+                lead.b_end = true;
+                break;
+            }
+            if (v_cursor[indx].doc > candidate)
+            {
+                b_match = false;
+                lead.SkipTo(v_cursor[indx].doc);
+            }
+        }
+        if (!b_match || lead.b_end)
+            continue;
+
+        // храним только последние limit совпадений: кольцо поверх v_result
+        if (v_result.size() < limit)
+            v_result.push_back(candidate);
+        else if (limit > 0)
+            v_result[total % limit] = candidate;
+        ++total;
+        lead.Next();
+    }
+
+    if (total > limit && limit > 0)
+        std::rotate(v_result.begin(), v_result.begin() + total % limit, v_result.end());
+    return skipped + total;
+}
+
+/// <summary>
+/// метод возврата количества слов в индексе
+/// </summary>
+/// <returns> количество слов </returns>
+size_t searchIndex_t::Terms() const
+{
+    return m_posting.size();
+}
+
+/// <summary>
+/// метод разбиения текста на слова: буквы и цифры, латиница приводится к нижнему регистру,
+/// байты UTF-8 (кириллица и др.) входят в слово без изменений
+/// </summary>
+/// <param name="text"> -- текст </param>
+/// <param name="v_word"> -- слова текста; лишние элементы не удаляются, чтобы сохранить их память </param>
+/// <returns> количество слов </returns>
+size_t searchIndex_t::Split(std::string_view text, std::vector<std::string>& v_word)
+{
+    size_t count = 0;
+    size_t indx = 0;
+    while (indx < text.size())
+    {
+        unsigned char c = static_cast<unsigned char>(text[indx]);
+        if (!(isalnum(c) || c >= 0x80))
+        {
+            ++indx;
+            continue;
+        }
+
+        if (count == v_word.size())
+            v_word.emplace_back();
+        std::string& word = v_word[count++];
+        word.clear();
+        for (; indx < text.size(); ++indx)
+        {
+            c = static_cast<unsigned char>(text[indx]);
+            if (!(isalnum(c) || c >= 0x80))
+                break;
+            if (word.size() < maxWord)
+                word.push_back(static_cast<char>(tolower(c)));
+        }
+    }
+    return count;
+}
+
+/// <summary>
+/// метод добавления записи в индекс
+/// </summary>
+/// <param name="offset"> -- смещение записи в истории </param>
+/// <param name="text"> -- текст записи </param>
+void searchIndex_t::Add(uint64_t offset, std::string_view text)
+{
+    size_t size = Split(text, v_word);
+    for (size_t indx = 0; indx < size; ++indx)
+    {
+        posting_t& posting = m_posting[v_word[indx]];
+        if (posting.count > 0 && posting.last == offset) // слово повторяется в записи
+            continue;
+        if (posting.count % skipStep == 0)
+            posting.v_skip.push_back(skip_t{ posting.last, static_cast<uint32_t>(posting.data.size()) });
+        PutVarint(posting.data, offset - posting.last); // записи идут по возрастанию смещений
+        posting.last = offset;
+        ++posting.count;
+    }
+}
+
+/// <summary>
+/// метод загрузки индекса из файла
+/// </summary>
+/// <returns> 1 -- индекс загружен </returns>
+bool searchIndex_t::Load()
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) // индекс еще не сохранялся
+        return false;
+    std::string buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    bool b_result = buf.size() >= sizeof(indexMagic) && buf.compare(0, sizeof(indexMagic), indexMagic, sizeof(indexMagic)) == 0;
+    size_t pos = sizeof(indexMagic);
+    uint64_t firstTime = 0, lastTime = 0, terms = 0;
+    b_result = b_result && GetVarint(buf, pos, indexed) && GetVarint(buf, pos, records) && GetVarint(buf, pos, lastRecord)
+        && GetVarint(buf, pos, firstTime) && GetVarint(buf, pos, lastTime) && GetVarint(buf, pos, terms);
+    if (b_result && !Matches(firstTime, lastTime))
+    {   // индекс от другой истории (файл пересоздан либо подменен): не ошибка, строим заново
+        logger.doLog("searchIndex_t: index of another history " + path);
+        return false;
+    }
+    m_posting.reserve(static_cast<size_t>(b_result ? terms : 0));
+    for (uint64_t term = 0; term < terms && b_result; ++term)
+    {
+        uint64_t length = 0, count = 0, last = 0, skips = 0;
+        b_result = GetVarint(buf, pos, length) && length <= buf.size() - pos;
+        if (!b_result)
+            break;
+        posting_t& posting = m_posting[buf.substr(pos, static_cast<size_t>(length))];
+        pos += static_cast<size_t>(length);
+        b_result = GetVarint(buf, pos, count) && GetVarint(buf, pos, last) && GetVarint(buf, pos, length) && length <= buf.size() - pos;
+        if (!b_result)
+            break;
+        posting.count = static_cast<uint32_t>(count);
+        posting.last = last;
+        posting.data.assign(buf, pos, static_cast<size_t>(length));
+        pos += static_cast<size_t>(length);
+        b_result = GetVarint(buf, pos, skips) && skips <= buf.size() - pos;
+        for (uint64_t skip = 0; skip < skips && b_result; ++skip)
+        {
+            uint64_t prev = 0, offset = 0;
+            b_result = GetVarint(buf, pos, prev) && GetVarint(buf, pos, offset) && offset < posting.data.size();
+            posting.v_skip.push_back(skip_t{ prev, static_cast<uint32_t>(offset) });
+        }
+        // точка пропуска на каждые skipStep записей: Find() обращается к ним по номеру записи
+        b_result = b_result && count > 0 && posting.v_skip.size() == (count + skipStep - 1) / skipStep;
+    }
+
+    if (!b_result)
+        logger.doLog("searchIndex_t: bad index file " + path);
+    return b_result;
+}
+
+/// <summary>
+/// метод сверки загруженного индекса с историей
+/// </summary>
+/// <param name="firstTime"> -- время первой записи истории при сохранении </param>
+/// <param name="lastTime"> -- время последней проиндексированной записи </param>
+/// <returns> 1 -- индекс построен по этой истории </returns>
+bool searchIndex_t::Matches(uint64_t firstTime, uint64_t lastTime) const
+{
+    if (records > history.Count() || indexed > history.End())
+        return false;
+    history_t::record_t record;
+    if (records == 0)
+        return indexed == history.Begin();
+    // первая запись та же, последняя проиндексированная на месте и кончается там, где индекс остановился
+    return history.Read(history.Begin(), record) && record.time == firstTime
+        && history.Read(lastRecord, record) == indexed && record.time == lastTime;
+}
+
+/// <summary>
+/// метод сохранения индекса в файл
+/// </summary>
+/// <returns> 1 -- индекс сохранен </returns>
+bool searchIndex_t::Save()
+{
+    // пишем во временный файл и подменяем: сбой при сохранении не портит прежний индекс
+    std::string temp = path + ".tmp";
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        logger.doLog("searchIndex_t: can't create " + temp);
+        return false;
+    }
+
+    history_t::record_t record;
+    uint64_t firstTime = history.Read(history.Begin(), record) ? record.time : 0;
+    uint64_t lastTime = records > 0 && history.Read(lastRecord, record) ? record.time : 0;
+
+    std::string buf(indexMagic, sizeof(indexMagic));
+    PutVarint(buf, indexed);
+    PutVarint(buf, records);
+    PutVarint(buf, lastRecord);
+    PutVarint(buf, firstTime);
+    PutVarint(buf, lastTime);
+    PutVarint(buf, m_posting.size());
+    for (const auto& item : m_posting)
+    {
+        const posting_t& posting = item.second;
+        PutVarint(buf, item.first.size());
+        buf.append(item.first);
+        PutVarint(buf, posting.count);
+        PutVarint(buf, posting.last);
+        PutVarint(buf, posting.data.size());
+        buf.append(posting.data);
+        PutVarint(buf, posting.v_skip.size());
+        for (const skip_t& skip : posting.v_skip)
+        {
+            PutVarint(buf, skip.prev);
+            PutVarint(buf, skip.pos);
+        }
+        if (buf.size() >= 64 * 1024)
+        {
+            file.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+    file.write(buf.data(), buf.size());
+    file.close();
+
+    if (!file)
+    {
+        logger.doLog("searchIndex_t: can't write " + temp);
+        std::remove(temp.c_str());
+        return false;
+    }
+    std::remove(path.c_str()); // rename в windows не заменяет существующий файл
+    if (std::rename(temp.c_str(), path.c_str()) != 0)
+    {
+        logger.doLog("searchIndex_t: can't rename " + temp);
+        return false;
+    }
+    return true;
+}
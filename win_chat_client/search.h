@@ -0,0 +1,176 @@
+﻿#pragma once
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "log.h"
+#include "history.h"
+
+/// <summary>
+/// Класс полнотекстового (инвертированного) индекса истории чата. Для каждого слова хранится
+/// список записей истории, где оно встречается: смещения записей по возрастанию, разности соседних
+/// смещений сжаты в varint (обычно 1-2 байта на запись). Каждые skipStep записей списка
+/// запоминается точка пропуска, поэтому пересечение редкого слова с частым не читает частый список целиком.
+/// Индекс дополняется по мере роста истории (Update()), сохраняется в "<путь>.fts" при закрытии
+/// и после загрузки дочитывает только записи, добавленные в историю после сохранения. Вместе с индексом
+/// хранятся приметы истории (время первой записи, последняя проиндексированная запись и ее время,
+/// количество записей): индекс от другой истории с тем же путем не подходит и строится заново
+/// </summary>
+class searchIndex_t
+{
+public:
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="history"> -- индексируемая история </param>
+    /// <param name="logger"> -- объект для логгирования </param>
+    searchIndex_t(const history_t& history, log_t& logger);
+
+    /// <summary>
+    /// деструктор, сохраняет индекс
+    /// </summary>
+    ~searchIndex_t();
+
+    searchIndex_t(const searchIndex_t&) = delete;
+    searchIndex_t& operator = (const searchIndex_t&) = delete;
+
+    /// <summary>
+    /// метод открытия индекса: загрузка сохраненного индекса, если он есть
+    /// </summary>
+    /// <param name="path"> -- путь к файлу индекса без расширения </param>
+    /// <returns> 1 -- сохраненный индекс загружен; 0 -- индекс строится заново </returns>
+    bool Open(const std::string& path);
+
+    /// <summary>
+    /// метод сохранения и закрытия индекса
+    /// </summary>
+    void Close();
+
+    /// <summary>
+    /// метод дополнения индекса записями, добавленными в историю
+    /// </summary>
+    /// <param name="budget"> -- наибольшее количество записей за вызов </param>
+    /// <returns> количество проиндексированных записей </returns>
+    size_t Update(size_t budget = SIZE_MAX);
+
+    /// <summary>
+    /// метод поиска записей, содержащих все слова запроса
+    /// </summary>
+    /// <param name="words"> -- слова запроса через пробел </param>
+    /// <param name="v_result"> -- смещения последних найденных записей по возрастанию </param>
+    /// <param name="limit"> -- наибольшее количество смещений в v_result </param>
+    /// <returns> количество найденных записей (может быть больше limit) </returns>
+    size_t Find(std::string_view words, std::vector<uint64_t>& v_result, size_t limit) const;
+
+    /// <summary>
+    /// метод возврата количества слов в индексе
+    /// </summary>
+    /// <returns> количество слов </returns>
+    size_t Terms() const;
+protected:
+    /// <summary>
+    /// точка пропуска в списке записей
+    /// </summary>
+    struct skip_t
+    {
+        uint64_t prev; // смещение записи перед точкой (0 - перед первой)
+        uint32_t pos; // позиция точки в сжатом списке
+    };
+
+    /// <summary>
+    /// список записей одного слова
+    /// </summary>
+    struct posting_t
+    {
+        std::string data; // разности смещений записей, varint
+        uint64_t last = 0; // смещение последней записи
+        uint32_t count = 0; // количество записей
+        std::vector<skip_t> v_skip; // точки пропуска через каждые skipStep записей
+    };
+
+    /// <summary>
+    /// курсор чтения списка записей
+    /// </summary>
+    struct cursor_t
+    {
+        /// <summary>
+        /// конструктор, курсор встает на первую запись
+        /// </summary>
+        /// <param name="posting"> -- список записей </param>
+        cursor_t(const posting_t& posting);
+
+        /// <summary>
+        /// метод перехода к следующей записи
+        /// </summary>
+        /// <returns> 1 -- запись есть </returns>
+        bool Next();
+
+        /// <summary>
+        /// метод перехода к первой записи не меньше заданной
+        /// </summary>
+        /// <param name="target"> -- смещение записи </param>
+        /// <returns> 1 -- запись есть </returns>
+        bool SkipTo(uint64_t target);
+
+        const posting_t* posting; // список записей
+        size_t pos; // позиция следующей разности
+        uint64_t doc; // текущая запись
+        bool b_end; // список закончился
+    };
+
+    static const uint32_t skipStep = 64; // записей между точками пропуска
+    static const size_t maxWord = 64; // длинные слова индексируются по первым байтам
+
+    /// <summary>
+    /// метод разбиения текста на слова: буквы и цифры, латиница приводится к нижнему регистру,
+    /// байты UTF-8 (кириллица и др.) входят в слово без изменений
+    /// </summary>
+    /// <param name="text"> -- текст </param>
+    /// <param name="v_word"> -- слова текста; лишние элементы не удаляются, чтобы сохранить их память </param>
+    /// <returns> количество слов </returns>
+    static size_t Split(std::string_view text, std::vector<std::string>& v_word);
+
+    /// <summary>
+    /// метод добавления записи в индекс
+    /// </summary>
+    /// <param name="offset"> -- смещение записи в истории </param>
+    /// <param name="text"> -- текст записи </param>
+    void Add(uint64_t offset, std::string_view text);
+
+    /// <summary>
+    /// метод загрузки индекса из файла
+    /// </summary>
+    /// <returns> 1 -- индекс загружен </returns>
+    bool Load();
+
+    /// <summary>
+    /// метод сверки загруженного индекса с историей
+    /// </summary>
+    /// <param name="firstTime"> -- время первой записи истории при сохранении </param>
+    /// <param name="lastTime"> -- время последней проиндексированной записи </param>
+    /// <returns> 1 -- индекс построен по этой истории </returns>
+    bool Matches(uint64_t firstTime, uint64_t lastTime) const;
+
+    /// <summary>
+    /// метод сохранения индекса в файл
+    /// </summary>
+    /// <returns> 1 -- индекс сохранен </returns>
+    bool Save();
+
+    std::unordered_map<std::string, posting_t> m_posting; // списки записей по словам
+    std::vector<std::string> v_word; // слова записи, буфер Add() без выделений памяти
+    uint64_t indexed; // смещение в истории, до которого записи проиндексированы
+    uint64_t records; // количество проиндексированных записей
+    uint64_t lastRecord; // смещение последней проиндексированной записи
+    std::string path; // путь к файлу индекса
+    bool b_open; // флаг открытого индекса
+    const history_t& history; // индексируемая история
+    log_t& logger; // объект логгирования
+};
+
+#endif /* SEARCH_H_ */
@@ -0,0 +1,241 @@
+﻿#include "session.h"
+
+/// <summary>
+/// конструктор, сеанс 0 открыт сразу
+/// </summary>
+/// <param name="socket"> -- подключенный неблокирующий транспорт </param>
+/// <param name="logger"> -- объект для логгирования </param>
+sessionMux_t::sessionMux_t(const std::shared_ptr<network::transport_t>& socket, log_t& logger) : socket(socket), queued(0), b_resume(false), b_blocked(false), blockedId(0), logger(logger)
+{
+    socket->SetFrameLength(&msg_t::FrameLength); // кадры с длиной отделяются по длине и под меткой сеанса
+    Open(0);
+}
+
+/// <summary>
+/// метод открытия сеанса; открытый сеанс не меняется
+/// </summary>
+/// <param name="id"> -- номер сеанса </param>
+void sessionMux_t::Open(unsigned id)
+{
+    m_session.emplace(id, session_t());
+}
+
+/// <summary>
+/// метод закрытия сеанса: неотправленные и непрочитанные кадры сеанса отбрасываются
+/// </summary>
+/// <param name="id"> -- номер сеанса </param>
+void sessionMux_t::Close(unsigned id)
+{
+    auto it = m_session.find(id);
+    if (it == m_session.end())
+        return;
+
+    queued -= it->second.l_outbox.size();
+    if (it->second.b_active)
+    {
+        if (b_resume && l_active.front() == id)
+            b_resume = false;
+        l_active.remove(id); // иначе вновь открытый сеанс с тем же номером встал бы в круг дважды
+    }
+    m_session.erase(it);
+    l_accepted.remove(id);
+    if (b_blocked && blockedId == id)
+        b_blocked = false;
+}
+
+/// <summary>
+/// метод постановки кадра в очередь исходящих сеанса
+/// </summary>
+/// <param name="id"> -- номер сеанса </param>
+/// <param name="msg"> -- кадр, перемещается в очередь при успехе </param>
+/// <returns> 0 - кадр в очереди; -1 - сеанс не открыт; -3 - очередь сеанса полна, повторить после Work() </returns>
+int sessionMux_t::Send(unsigned id, msg_t&& msg)
+{
+    auto it = m_session.find(id);
+    if (it == m_session.end())
+        return -1;
+
+    session_t& session = it->second;
+    if (session.l_outbox.size() >= queueLimit)
+        return -3;
+
+    session.l_outbox.push_back(std::move(msg));
+    ++queued;
+    if (!session.b_active)
+    {   // сеанс встает в конец круга и ждет своей очереди
+        session.b_active = true;
+        l_active.push_back(id);
+    }
+    return 0;
+}
+
+/// <summary>
+/// метод извлечения принятого кадра сеанса
+/// </summary>
+/// <param name="id"> -- номер сеанса </param>
+/// <param name="msg"> -- принятый кадр без метки сеанса </param>
+/// <returns> 1 - кадр извлечен </returns>
+bool sessionMux_t::Recive(unsigned id, msg_t& msg)
+{
+    auto it = m_session.find(id);
+    if (it == m_session.end() || it->second.l_inbox.empty())
+        return false;
+
+    msg = std::move(it->second.l_inbox.front());
+    it->second.l_inbox.pop_front();
+    if (b_blocked && blockedId == id)
+        b_blocked = false; // место в очереди появилось, сокет снова читаем
+    return true;
+}
+
+/// <summary>
+/// метод получения сеанса, открытого собеседником
+/// </summary>
+/// <param name="id"> -- номер нового сеанса </param>
+/// <returns> 1 - есть новый сеанс </returns>
+bool sessionMux_t::Accept(unsigned& id)
+{
+    if (l_accepted.empty())
+        return false;
+
+    id = l_accepted.front();
+    l_accepted.pop_front();
+    return true;
+}
+
+/// <summary>
+/// метод обслуживания соединения
+/// </summary>
+/// <returns> 0 - исходящие отправлены;
+///           1 - исходящие ждут готовности сокета к отправке;
+///           -1 - системная ошибка;
+///           -2 - соединение закрыто</returns>
+int sessionMux_t::Work()
+{
+    int code = socket->Flush(); // сначала то, что сокет не принял в прошлый раз
+    if (code < 0)
+        return code;
+
+    code = Pump();
+    if (code < 0)
+        return code;
+
+    code = Drain();
+    if (code < 0)
+        return code;
+
+    return queued > 0 || socket->Backlog() > 0 ? 1 : 0;
+}
+
+/// <summary>
+/// метод возврата количества открытых сеансов
+/// </summary>
+/// <returns> количество сеансов </returns>
+size_t sessionMux_t::Sessions() const
+{
+    return m_session.size();
+}
+
+/// <summary>
+/// метод отправки очередей сеансов по кругу, пока буфер исходящих сокета меньше окна.
+/// За круг сеанс получает квант байт и отправляет кадры, пока их длина укладывается в накопленный кредит.
+/// Ход, прерванный заполнением окна, продолжается первым и без нового кванта: иначе сеанс получал бы квант
+/// за каждый кадр, кредит рос бы без предела, и круг делил бы соединение поровну по кадрам, а не по байтам
+/// </summary>
+/// <returns> 0 - удачно; -1 - системная ошибка; -2 - соединение закрыто </returns>
+int sessionMux_t::Pump()
+{
+    while (!l_active.empty() && socket->Backlog() < window)
+    {
+        unsigned id = l_active.front();
+        l_active.pop_front();
+        session_t& session = m_session[id]; // в круге только открытые сеансы (Close() снимает с круга)
+
+        if (!b_resume)
+            session.deficit += quantum;
+        b_resume = false;
+        size_t header = id == 0 ? 0 : msg_t::streamSize; // метка сеанса занимает соединение наравне с кадром
+        while (!session.l_outbox.empty() && session.l_outbox.front().Str().size() + header <= session.deficit && socket->Backlog() < window)
+        {
+            const std::string& frame = session.l_outbox.front().Str();
+            session.deficit -= frame.size() + header;
+            int code;
+            if (id == 0) // сеанс 0 без метки
+                code = socket->SendBuffered(frame);
+            else
+            {   // метка и кадр одним вызовом, буфер переиспользуется
+                frame_TX.clear();
+                msg_t::StreamHeader(frame_TX, id);
+                frame_TX.append(frame);
+                code = socket->SendBuffered(frame_TX);
+            }
+            session.l_outbox.pop_front();
+            --queued;
+            if (code < 0)
+            {
+                logger.doLog("sessionMux_t::Pump() send fail, code: ", code);
+                return code;
+            }
+        }
+
+        if (session.l_outbox.empty())
+        {   // кредит не копится, пока сеансу нечего отправить
+            session.deficit = 0;
+            session.b_active = false;
+        }
+        else if (session.l_outbox.front().Str().size() + header <= session.deficit)
+        {   // кредит остался, ход прервало окно
+            l_active.push_front(id);
+            b_resume = true;
+        }
+        else
+            l_active.push_back(id);
+    }
+    return 0;
+}
+
+/// <summary>
+/// метод приема кадров и раскладки их по сеансам. Кадр с новым номером открывает сеанс собеседника,
+/// пока сеансов меньше sessionLimit; сверх предела кадр отбрасывается. Если очередь принятых сеанса полна, сокет не читается, пока владелец сеанса не заберет кадры:
+/// у соединения один поток байт, обогнать непрочитанный кадр нельзя
+/// </summary>
+/// <returns> 0 - удачно; -1 - системная ошибка; -2 - соединение закрыто </returns>
+int sessionMux_t::Drain()
+{
+    for (size_t count = 0; count < recvBudget && !b_blocked; ++count)
+    {
+        int code = socket->Recive(frame_RX.Update(), msg_t::EOM());
+        if (-3 == code) // данных больше нет
+            break;
+        if (code < 0)
+            return code;
+        if (code > 0) // часть кадра, дочитываем
+            continue;
+
+        unsigned id = 0;
+        std::string& text = frame_RX.Update();
+        if (msg_t::StreamId(text, id))
+            text.erase(0, msg_t::streamSize);
+
+        auto it = m_session.find(id);
+        if (it == m_session.end())
+        {
+            if (m_session.size() >= sessionLimit)
+            {   // номер сеанса выбирает собеседник: без предела каждый новый номер занимал бы память
+                logger.doLog("sessionMux_t::Drain() session limit reached, frame dropped, session: ", static_cast<int>(id));
+                frame_RX.Update().clear();
+                continue;
+            }
+            it = m_session.emplace(id, session_t()).first;
+            l_accepted.push_back(id);
+        }
+        it->second.l_inbox.push_back(std::move(frame_RX));
+        frame_RX = msg_t(); // новый буфер из пула потока
+        if (it->second.l_inbox.size() >= queueLimit)
+        {
+            b_blocked = true;
+            blockedId = id;
+        }
+    }
+    return 0;
+}
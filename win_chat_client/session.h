@@ -0,0 +1,131 @@
+﻿#pragma once
+#ifndef SESSION_H_
+#define SESSION_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "log.h"
+#include "network.h"
+#include "message.h"
+
+/// <summary>
+/// Класс сеансового уровня над клиентским сокетом: много независимых логических чатов через одно соединение.
+/// Кадр сеанса - обычный кадр с меткой [STRM] + номер сеанса (8 шестнадцатеричных цифр) впереди; кадры без метки
+/// принадлежат сеансу 0, поэтому сеанс 0 совместим с клиентом без сеансов. У каждого сеанса своя очередь исходящих,
+/// очереди делят соединение поровну по байтам вместе с метками (круговой обход с кредитом, deficit round robin): длинная очередь
+/// одного сеанса не задерживает остальные дольше одного кванта. Сокет обслуживает только этот объект:
+/// его нужно записать в мультиплексор читателем, а отправителем - пока Work() сообщает о недописанных исходящих
+/// </summary>
+class sessionMux_t
+{
+public:
+    static const size_t quantum = 16 * 1024; // байт, добавляемых сеансу за круг
+
+    /// <summary>
+    /// конструктор, сеанс 0 открыт сразу
+    /// </summary>
+    /// <param name="socket"> -- подключенный неблокирующий транспорт </param>
+    /// <param name="logger"> -- объект для логгирования </param>
+    sessionMux_t(const std::shared_ptr<network::transport_t>& socket, log_t& logger);
+
+    sessionMux_t(const sessionMux_t&) = delete;
+    sessionMux_t& operator = (const sessionMux_t&) = delete;
+
+    /// <summary>
+    /// метод открытия сеанса; открытый сеанс не меняется
+    /// </summary>
+    /// <param name="id"> -- номер сеанса </param>
+    void Open(unsigned id);
+
+    /// <summary>
+    /// метод закрытия сеанса: неотправленные и непрочитанные кадры сеанса отбрасываются
+    /// </summary>
+    /// <param name="id"> -- номер сеанса </param>
+    void Close(unsigned id);
+
+    /// <summary>
+    /// метод постановки кадра в очередь исходящих сеанса
+    /// </summary>
+    /// <param name="id"> -- номер сеанса </param>
+    /// <param name="msg"> -- кадр, перемещается в очередь при успехе </param>
+    /// <returns> 0 - кадр в очереди; -1 - сеанс не открыт; -3 - очередь сеанса полна, повторить после Work() </returns>
+    int Send(unsigned id, msg_t&& msg);
+
+    /// <summary>
+    /// метод извлечения принятого кадра сеанса
+    /// </summary>
+    /// <param name="id"> -- номер сеанса </param>
+    /// <param name="msg"> -- принятый кадр без метки сеанса </param>
+    /// <returns> 1 - кадр извлечен </returns>
+    bool Recive(unsigned id, msg_t& msg);
+
+    /// <summary>
+    /// метод получения сеанса, открытого собеседником: первый кадр с новым номером открывает сеанс,
+    /// пока сеансов меньше sessionLimit (кадры сверх предела отбрасываются)
+    /// </summary>
+    /// <param name="id"> -- номер нового сеанса </param>
+    /// <returns> 1 - есть новый сеанс </returns>
+    bool Accept(unsigned& id);
+
+    /// <summary>
+    /// метод обслуживания соединения: дописывание буфера исходящих, отправка очередей сеансов
+    /// поровну, прием кадров и раскладка их по сеансам. Вызывается на каждом такте цикла событий
+    /// </summary>
+    /// <returns> 0 - исходящие отправлены;
+    ///           1 - исходящие ждут готовности сокета к отправке;
+    ///           -1 - системная ошибка;
+    ///           -2 - соединение закрыто</returns>
+    int Work();
+
+    /// <summary>
+    /// метод возврата количества открытых сеансов
+    /// </summary>
+    /// <returns> количество сеансов </returns>
+    size_t Sessions() const;
+protected:
+    /// <summary>
+    /// состояние сеанса
+    /// </summary>
+    struct session_t
+    {
+        std::list<msg_t> l_outbox; // кадры на отправку
+        std::list<msg_t> l_inbox; // принятые кадры
+        size_t deficit = 0; // байт, которые сеанс может отправить в текущем круге
+        bool b_active = false; // сеанс стоит в круге отправки
+    };
+
+    static const size_t window = 64 * 1024; // буфер исходящих сокета, сверх которого кадры ждут в очередях сеансов
+    static const size_t queueLimit = 1024; // наибольшее количество кадров в очереди сеанса
+    static const size_t recvBudget = 256; // наибольшее количество приемов из сокета за один вызов Work()
+    static const size_t sessionLimit = 256; // наибольшее количество сеансов, включая открытые собеседником
+
+    /// <summary>
+    /// метод отправки очередей сеансов по кругу, пока буфер исходящих сокета меньше окна.
+    /// Ход, прерванный заполнением окна, продолжается первым и без нового кванта
+    /// </summary>
+    /// <returns> 0 - удачно; -1 - системная ошибка; -2 - соединение закрыто </returns>
+    int Pump();
+
+    /// <summary>
+    /// метод приема кадров и раскладки их по сеансам
+    /// </summary>
+    /// <returns> 0 - удачно; -1 - системная ошибка; -2 - соединение закрыто </returns>
+    int Drain();
+
+    std::shared_ptr<network::transport_t> socket; // транспорт соединения (TCP сокет, канал в памяти)
+    std::unordered_map<unsigned, session_t> m_session; // сеансы по номерам
+    std::list<unsigned> l_active; // круг сеансов с исходящими
+    std::list<unsigned> l_accepted; // сеансы, открытые собеседником и еще не выданные Accept()
+    msg_t frame_RX; // буфер принимаемого кадра
+    std::string frame_TX; // буфер метки сеанса и кадра для отправки
+    size_t queued; // кадров во всех очередях исходящих
+    bool b_resume; // ход первого сеанса круга прерван окном: продолжается без нового кванта
+    bool b_blocked; // очередь принятых какого-то сеанса полна, сокет не читаем
+    unsigned blockedId; // сеанс с полной очередью принятых
+    log_t& logger; // объект логгирования
+};
+
+#endif /* SESSION_H_ */
@@ -0,0 +1,445 @@
+﻿#include "shm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifndef __WIN32__
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// конструктор, транспорт не соединен
+/// </summary>
+/// <param name="logger"> - объект для логгирования </param>
+network::shmTransport_t::shmTransport_t(log_t& logger) : socket_t(logger), transport_t(logger), region(nullptr), regionSize(0), ringSize(0), memory(-1), peerDoorbell(-1), spin(0), b_sendWait(false)
+{}
+
+/// <summary>
+/// деструктор, закрывает канал
+/// </summary>
+network::shmTransport_t::~shmTransport_t()
+{
+    Shutdown();
+}
+
+/// <summary>
+/// Метод создания сегмента; прежний канал закрывается. Отправленное до подключения собеседника ждет его в кольце
+/// </summary>
+/// <param name="ringSize"> - емкость кольца одного направления, степень двойки </param>
+/// <returns> 1 - сегмент создан </returns>
+bool network::shmTransport_t::Create(size_t ringSize)
+{
+    Shutdown();
+    if (ringSize == 0 || (ringSize & (ringSize - 1)) != 0 || ringSize > INT32_MAX)
+    {
+        logger.doLog("shmTransport_t::Create() ring size is not a power of two: ", static_cast<int>(ringSize));
+        return false;
+    }
+#ifdef __WIN32__
+    logger.doLog("shmTransport_t::Create() shared memory transport is not supported", 0);
+    return false;
+#else
+    int segment = memfd_create("chat_shm", MFD_CLOEXEC);
+    int doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int peer = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (segment < 0 || doorbell < 0 || peer < 0 || ftruncate(segment, dataOffset + 2 * ringSize) != 0)
+    {
+        logger.doLog("shmTransport_t::Create() fail, errno: ", GetError());
+        for (int fd : { segment, doorbell, peer })
+            if (fd >= 0)
+                close(fd);
+        return false;
+    }
+    return Map(segment, doorbell, peer, true);
+#endif
+}
+
+/// <summary>
+/// Метод передачи дескрипторов созданного сегмента собеседнику через подключенный локальный сокет (AF_UNIX)
+/// </summary>
+/// <param name="channel"> - подключенный локальный сокет </param>
+/// <returns> 0 - передано; -1 - ошибка; -3 - сокет не готов к отправке </returns>
+int network::shmTransport_t::Offer(socket_t& channel)
+{
+    if (memory < 0)
+    {
+        logger.doLog("shmTransport_t::Offer() no segment to offer", 0);
+        return -1;
+    }
+#ifdef __WIN32__
+    return -1;
+#else
+    int fds[3] = { memory, peerDoorbell, Socket }; // у собеседника звонки меняются местами
+    char tag = 's';
+    iovec part = { &tag, 1 };
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+    msghdr message = {};
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+    if (sendmsg(channel.getSocket(), &message, MSG_NOSIGNAL) == 1)
+    {   // третья сторона к кольцам с одним писателем не подключится
+        close(memory);
+        memory = -1;
+        return 0;
+    }
+    if (GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
+        return -3;
+    logger.doLog("shmTransport_t::Offer() fail, errno: ", GetError());
+    return -1;
+#endif
+}
+
+/// <summary>
+/// Метод подключения к сегменту собеседника по дескрипторам из локального сокета; прежний канал закрывается
+/// </summary>
+/// <param name="channel"> - подключенный локальный сокет </param>
+/// <returns> 0 - подключен; -1 - ошибка; -2 - сокет закрыт; -3 - дескрипторы еще не пришли </returns>
+int network::shmTransport_t::Attach(socket_t& channel)
+{
+    Shutdown();
+#ifdef __WIN32__
+    logger.doLog("shmTransport_t::Attach() shared memory transport is not supported", 0);
+    return -1;
+#else
+    int fds[3] = { -1, -1, -1 };
+    char tag = 0;
+    iovec part = { &tag, 1 };
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+    msghdr message = {};
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t result = recvmsg(channel.getSocket(), &message, MSG_CMSG_CLOEXEC);
+    if (result == 0)
+        return -2;
+    if (result < 0)
+    {
+        if (GetError() == error_t::NON_BLOCK_SOCKET_NOT_READY)
+            return -3;
+        logger.doLog("shmTransport_t::Attach() fail, errno: ", GetError());
+        return -1;
+    }
+
+    size_t count = 0;
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (header != nullptr && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+    {
+        count = std::min<size_t>((header->cmsg_len - CMSG_LEN(0)) / sizeof(int), 3);
+        std::memcpy(fds, CMSG_DATA(header), count * sizeof(int));
+    }
+    if (tag != 's' || count != 3)
+    {   // чужое сообщение: пришедшие дескрипторы не нужны
+        logger.doLog("shmTransport_t::Attach() unexpected message, descriptors: ", static_cast<int>(count));
+        for (size_t indx = 0; indx < count; ++indx)
+            close(fds[indx]);
+        return -1;
+    }
+    return Map(fds[0], fds[1], fds[2], false) ? 0 : -1;
+#endif
+}
+
+/// <summary>
+/// Метод соединения пары транспортов одного процесса новым сегментом; прежние каналы закрываются
+/// </summary>
+/// <param name="first"> - первый транспорт </param>
+/// <param name="second"> - второй транспорт </param>
+/// <param name="ringSize"> - емкость кольца одного направления, степень двойки </param>
+/// <returns> 1 - пара соединена </returns>
+bool network::shmTransport_t::Connect(shmTransport_t& first, shmTransport_t& second, size_t ringSize)
+{
+    second.Shutdown();
+    if (!first.Create(ringSize))
+        return false;
+#ifdef __WIN32__
+    return false;
+#else
+    int segment = dup(first.memory);
+    int doorbell = dup(first.peerDoorbell);
+    int peer = dup(first.Socket);
+    close(first.memory);
+    first.memory = -1;
+    if (segment < 0 || doorbell < 0 || peer < 0)
+    {
+        first.logger.doLog("shmTransport_t::Connect() dup fail, errno: ", first.GetError());
+        for (int fd : { segment, doorbell, peer })
+            if (fd >= 0)
+                close(fd);
+        first.Shutdown();
+        return false;
+    }
+    return second.Map(segment, doorbell, peer, false);
+#endif
+}
+
+/// <summary>
+/// Метод задания числа проверок пустого кольца перед засыпанием: при частом обмене собеседник
+/// успевает записать без звонка, ценой холостых проверок
+/// </summary>
+/// <param name="spin"> - число проверок (0 - засыпать сразу) </param>
+void network::shmTransport_t::SetSpin(unsigned spin)
+{
+    this->spin = spin;
+}
+
+/// <summary>
+/// Метод закрытия канала: собеседник дочитывает записанное и получает закрытие соединения, его запись возвращает -2
+/// </summary>
+void network::shmTransport_t::Shutdown()
+{
+    if (region != nullptr)
+    {
+        tx.header->b_writerClosed.store(1, std::memory_order_seq_cst);
+        rx.header->b_readerClosed.store(1, std::memory_order_seq_cst);
+        Ring(peerDoorbell); // спит ли собеседник, не важно: закрытие он должен увидеть
+    }
+    Unmap();
+    Close();
+    b_connected = false;
+}
+
+/// <summary>
+/// Метод отображения сегмента, дескрипторы переходят объекту
+/// </summary>
+/// <param name="memory"> - дескриптор сегмента </param>
+/// <param name="doorbell"> - свой звонок </param>
+/// <param name="peerDoorbell"> - звонок собеседника </param>
+/// <param name="b_creator"> - объект создал сегмент </param>
+/// <returns> 1 - сегмент отображен </returns>
+bool network::shmTransport_t::Map(int memory, int doorbell, int peerDoorbell, bool b_creator)
+{
+#ifdef __WIN32__
+    return false;
+#else
+    struct stat info;
+    size_t size = fstat(memory, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+    void* address = size > dataOffset ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0) : MAP_FAILED;
+    segment_t* segment = static_cast<segment_t*>(address);
+    if (address != MAP_FAILED && b_creator)
+    {   // оба читателя начинают спящими: звонок не взведен, первая запись позвонит
+        segment = new (address) segment_t();
+        segment->ringSize = (size - dataOffset) / 2;
+        segment->ring[0].b_readerParked.store(1, std::memory_order_relaxed);
+        segment->ring[1].b_readerParked.store(1, std::memory_order_relaxed);
+        segment->magic = segmentMagic;
+    }
+    // емкость пишет создатель сегмента: читаем ее один раз, и только степень двойки, целиком умещающаяся
+    // в отображении, дает маску индекса в пределах кольца (сравнение без 2 * ring не переполняется)
+    uint64_t ring = address != MAP_FAILED ? segment->ringSize : 0;
+    if (address == MAP_FAILED || segment->magic != segmentMagic || ring == 0 || (ring & (ring - 1)) != 0
+        || ring > (size - dataOffset) / 2 || dataOffset + 2 * ring != size)
+    {
+        logger.doLog("shmTransport_t::Map() invalid segment, size: ", static_cast<int>(size));
+        if (address != MAP_FAILED)
+            munmap(address, size);
+        for (int fd : { memory, doorbell, peerDoorbell })
+            close(fd);
+        return false;
+    }
+
+    region = address;
+    regionSize = size;
+    ringSize = static_cast<size_t>(ring);
+    char* data = static_cast<char*>(address) + dataOffset;
+    tx.header = &segment->ring[b_creator ? 0 : 1];
+    tx.data = data + (b_creator ? 0 : ringSize);
+    rx.header = &segment->ring[b_creator ? 1 : 0];
+    rx.data = data + (b_creator ? ringSize : 0);
+    if (b_creator)
+        this->memory = memory; // до передачи собеседнику
+    else
+        close(memory); // отображение остается после закрытия дескриптора
+    this->peerDoorbell = peerDoorbell;
+    b_sendWait = false;
+    Socket = doorbell;
+    nonBlock = true;
+    ResetFraming();
+    b_connected = true;
+    return true;
+#endif
+}
+
+/// <summary>
+/// Метод приема байт из входящего кольца; на пустом кольце читатель засыпает до звонка
+/// </summary>
+/// <param name="data"> - буфер приема </param>
+/// <param name="size"> - размер буфера </param>
+/// <returns> N>0 - принято N байт; 0 - соединение закрыто; -1 - позиции кольца искажены, канал закрыт; -3 - данных нет </returns>
+int network::shmTransport_t::RawRecive(char* data, size_t size)
+{
+    ringHeader_t& ring = *rx.header;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    for (unsigned count = 0; count < spin && head == tail; ++count)
+        tail = ring.tail.load(std::memory_order_acquire);
+
+    if (head == tail)
+    {
+        if (!ring.b_writerClosed.load(std::memory_order_acquire))
+        {   // признак сна до повторной проверки: запись после нее увидит признак и позвонит
+            Park();
+            tail = ring.tail.load(std::memory_order_acquire);
+            if (head == tail && !ring.b_writerClosed.load(std::memory_order_acquire))
+                return -3;
+            Unpark();
+        }
+        tail = ring.tail.load(std::memory_order_acquire); // после закрытия хвост не меняется
+        if (head == tail)
+            return 0;
+    }
+    if (tail - head > ringSize) // хвост пишет собеседник: хвост перед головой (разность переходит через ноль) либо дальше кольца
+    {
+        logger.doLog("shmTransport_t::Recive() ring positions corrupted, head " + std::to_string(head) + ", tail " + std::to_string(tail));
+        Shutdown();
+        return -1;
+    }
+
+    size_t count = std::min<size_t>(size, tail - head);
+    size_t offset = head & (ringSize - 1);
+    size_t first = std::min(count, ringSize - offset);
+    std::memcpy(data, rx.data + offset, first);
+    std::memcpy(data + first, rx.data, count - first);
+    ring.head.store(head + count, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // место освобождено раньше проверки признака писателя
+    if (ring.b_writerParked.load(std::memory_order_relaxed) && ring.b_writerParked.exchange(0))
+        Ring(peerDoorbell);
+    return static_cast<int>(count);
+}
+
+/// <summary>
+/// Метод записи байт в исходящее кольцо, не больше свободного места
+/// </summary>
+/// <param name="data"> - данные для отправки </param>
+/// <param name="size"> - количество байт </param>
+/// <returns> N>0 - записано N байт; -1 - позиции кольца искажены, канал закрыт; -2 - собеседник закрыл канал; -3 - кольцо полно </returns>
+int network::shmTransport_t::RawSend(const char* data, size_t size)
+{
+    ringHeader_t& ring = *tx.header;
+    if (ring.b_readerClosed.load(std::memory_order_acquire))
+        return -2;
+
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (tail - head == ringSize)
+    {   // ждем места: читатель, освободив его, увидит признак и позвонит
+        ring.b_writerParked.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        head = ring.head.load(std::memory_order_acquire);
+        b_sendWait = tail - head == ringSize;
+        if (b_sendWait)
+            return -3;
+    }
+    if (tail - head > ringSize) // голову пишет собеседник: голова за хвостом (разность переходит через ноль) либо отстает больше кольца
+    {
+        logger.doLog("shmTransport_t::Send() ring positions corrupted, head " + std::to_string(head) + ", tail " + std::to_string(tail));
+        Shutdown();
+        return -1;
+    }
+
+    size_t count = std::min<size_t>(size, ringSize - (tail - head));
+    size_t offset = tail & (ringSize - 1);
+    size_t first = std::min(count, ringSize - offset);
+    std::memcpy(tx.data + offset, data, first);
+    std::memcpy(tx.data, data + first, count - first);
+    b_sendWait = count < size;
+    if (b_sendWait) // кольцо заполнено: остаток владелец допишет по звонку читателя, как по готовности сокета к отправке
+        ring.b_writerParked.store(1, std::memory_order_relaxed);
+    ring.tail.store(tail + count, std::memory_order_release); // признак виден читателю вместе с записью
+
+    std::atomic_thread_fence(std::memory_order_seq_cst); // запись видна раньше проверки признака читателя
+    if (ring.b_readerParked.load(std::memory_order_relaxed) && ring.b_readerParked.exchange(0))
+        Ring(peerDoorbell);
+    return static_cast<int>(count);
+}
+
+/// <summary>
+/// Метод проверки наличия сегмента
+/// </summary>
+/// <returns> 1 - сегмент отображен </returns>
+bool network::shmTransport_t::RawValid()
+{
+    return region != nullptr;
+}
+
+/// <summary>
+/// Метод проверки режима: транспорт всегда неблокирующий
+/// </summary>
+/// <returns> 1 </returns>
+bool network::shmTransport_t::NonBlocking() const
+{
+    return true;
+}
+
+/// <summary>
+/// Метод засыпания читателя: сброс своего звонка и признак сна во входящем кольце. Звонок сбрасывается
+/// всегда: он мог прийти и от читателя собеседника, освободившего место в исходящем кольце;
+/// если отправитель этого места ждет, звонок взводится снова
+/// </summary>
+void network::shmTransport_t::Park()
+{
+#ifndef __WIN32__
+    uint64_t value;
+    if (read(Socket, &value, sizeof(value)) < 0 && GetError() != error_t::NON_BLOCK_SOCKET_NOT_READY)
+        logger.doLog("shmTransport_t::Park() fail, errno: ", GetError());
+#endif
+    // сброшенный звонок мог быть звонком писателю: место уже есть, а второго звонка не будет
+    if (b_sendWait && tx.header->tail.load(std::memory_order_relaxed) - tx.header->head.load(std::memory_order_acquire) < ringSize)
+        Ring(Socket);
+    rx.header->b_readerParked.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+/// <summary>
+/// Метод отмены сна, если данные пришли между признаком и проверкой: пока читатель не спит, звонок
+/// должен оставаться взведенным, иначе мультиплексор не вернет готовность к недочитанному кольцу
+/// </summary>
+void network::shmTransport_t::Unpark()
+{
+    if (rx.header->b_readerParked.exchange(0))
+        Ring(Socket); // писатель признак не застал и не звонил
+}
+
+/// <summary>
+/// Метод звонка
+/// </summary>
+/// <param name="doorbell"> - звонок </param>
+void network::shmTransport_t::Ring(int doorbell)
+{
+#ifndef __WIN32__
+    uint64_t value = 1;
+    if (write(doorbell, &value, sizeof(value)) < 0 && GetError() != error_t::NON_BLOCK_SOCKET_NOT_READY)
+        logger.doLog("shmTransport_t::Ring() fail, errno: ", GetError());
+#endif
+}
+
+/// <summary>
+/// Метод освобождения сегмента и дескрипторов, кроме своего звонка
+/// </summary>
+void network::shmTransport_t::Unmap()
+{
+#ifndef __WIN32__
+    if (region != nullptr)
+        munmap(region, regionSize);
+    for (int fd : { memory, peerDoorbell })
+        if (fd >= 0)
+            close(fd);
+#endif
+    region = nullptr;
+    regionSize = 0;
+    rx = tx = ring_t();
+    memory = peerDoorbell = -1;
+}
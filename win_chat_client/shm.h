@@ -0,0 +1,192 @@
+﻿#pragma once
+#ifndef SHM_H_
+#define SHM_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "network.h"
+
+/// <summary>
+/// простанство имен классов для работы с сетью
+/// </summary>
+namespace network
+{
+    /// <summary>
+    /// Класс транспорта через общую память для процессов одной машины: пара колец байт (по одному на направление)
+    /// с одним писателем и одним читателем в отображенном сегменте. Данные идут без системных вызовов; звонок
+    /// собеседнику (eventfd) нужен, только если он уснул на пустом кольце (либо ждет места в полном).
+    /// Дескриптор сокета объекта - свой звонок, поэтому транспорт ставится в NonBlockSocket_manager_t читателем:
+    /// готовность к чтению означает новые данные, освободившееся место в исходящем кольце либо закрытие,
+    /// и по ней владелец вызывает и Recive(), и Flush(). Отправителем (AddSender()) транспорт не ставится:
+    /// eventfd к записи готов всегда. Сегмент создает одна сторона (Create()) и передает его дескрипторы
+    /// собеседнику через локальный сокет (Offer()/Attach()). Только Linux
+    /// </summary>
+    class shmTransport_t : public socket_t, public transport_t
+    {
+    public:
+        static const size_t defaultRing = 1 << 20; // емкость кольца по умолчанию, байт
+
+        /// <summary>
+        /// конструктор, транспорт не соединен
+        /// </summary>
+        /// <param name="logger"> - объект для логгирования </param>
+        shmTransport_t(log_t& logger);
+
+        /// <summary>
+        /// деструктор, закрывает канал
+        /// </summary>
+        virtual ~shmTransport_t();
+
+        /// <summary>
+        /// Метод создания сегмента; прежний канал закрывается. Отправленное до подключения собеседника ждет его в кольце
+        /// </summary>
+        /// <param name="ringSize"> - емкость кольца одного направления, степень двойки </param>
+        /// <returns> 1 - сегмент создан </returns>
+        bool Create(size_t ringSize = defaultRing);
+
+        /// <summary>
+        /// Метод передачи дескрипторов созданного сегмента собеседнику через подключенный локальный сокет (AF_UNIX)
+        /// </summary>
+        /// <param name="channel"> - подключенный локальный сокет </param>
+        /// <returns> 0 - передано; -1 - ошибка; -3 - сокет не готов к отправке </returns>
+        int Offer(socket_t& channel);
+
+        /// <summary>
+        /// Метод подключения к сегменту собеседника по дескрипторам из локального сокета; прежний канал закрывается
+        /// </summary>
+        /// <param name="channel"> - подключенный локальный сокет </param>
+        /// <returns> 0 - подключен; -1 - ошибка; -2 - сокет закрыт; -3 - дескрипторы еще не пришли </returns>
+        int Attach(socket_t& channel);
+
+        /// <summary>
+        /// Метод соединения пары транспортов одного процесса новым сегментом; прежние каналы закрываются
+        /// </summary>
+        /// <param name="first"> - первый транспорт </param>
+        /// <param name="second"> - второй транспорт </param>
+        /// <param name="ringSize"> - емкость кольца одного направления, степень двойки </param>
+        /// <returns> 1 - пара соединена </returns>
+        static bool Connect(shmTransport_t& first, shmTransport_t& second, size_t ringSize = defaultRing);
+
+        /// <summary>
+        /// Метод задания числа проверок пустого кольца перед засыпанием: при частом обмене собеседник
+        /// успевает записать без звонка, ценой холостых проверок
+        /// </summary>
+        /// <param name="spin"> - число проверок (0 - засыпать сразу) </param>
+        void SetSpin(unsigned spin);
+
+        /// <summary>
+        /// Метод закрытия канала: собеседник дочитывает записанное и получает закрытие соединения, его запись возвращает -2
+        /// </summary>
+        void Shutdown() override;
+    protected:
+        /// <summary>
+        /// заголовок кольца одного направления; позиции растут монотонно, индекс в кольце - позиция по маске
+        /// </summary>
+        struct ringHeader_t
+        {
+            alignas(64) std::atomic<uint64_t> head; // прочитано байт (пишет читатель)
+            alignas(64) std::atomic<uint64_t> tail; // записано байт (пишет писатель)
+            alignas(64) std::atomic<uint32_t> b_readerParked; // читатель спит до звонка: писатель звонит, сбросив признак
+            std::atomic<uint32_t> b_writerParked; // писатель ждет места: читатель звонит, сбросив признак
+            std::atomic<uint32_t> b_readerClosed; // читатель закрыл канал
+            std::atomic<uint32_t> b_writerClosed; // писатель закрыл канал, после признака хвост не меняется
+        };
+
+        /// <summary>
+        /// заголовок сегмента; данные колец начинаются со страницы после него
+        /// </summary>
+        struct segment_t
+        {
+            uint64_t magic; // признак сегмента транспорта
+            uint64_t ringSize; // емкость кольца
+            ringHeader_t ring[2]; // 0 - от создателя, 1 - к создателю
+        };
+
+        /// <summary>
+        /// кольцо в отображении сегмента
+        /// </summary>
+        struct ring_t
+        {
+            ringHeader_t* header = nullptr; // заголовок
+            char* data = nullptr; // данные
+        };
+
+        static const uint64_t segmentMagic = 0x316d687374616863ull; // "chatshm1"
+        static const size_t dataOffset = 4096; // смещение данных колец от начала сегмента
+
+        /// <summary>
+        /// Метод отображения сегмента, дескрипторы переходят объекту
+        /// </summary>
+        /// <param name="memory"> - дескриптор сегмента </param>
+        /// <param name="doorbell"> - свой звонок </param>
+        /// <param name="peerDoorbell"> - звонок собеседника </param>
+        /// <param name="b_creator"> - объект создал сегмент </param>
+        /// <returns> 1 - сегмент отображен </returns>
+        bool Map(int memory, int doorbell, int peerDoorbell, bool b_creator);
+
+        /// <summary>
+        /// Метод приема байт из входящего кольца; на пустом кольце читатель засыпает до звонка
+        /// </summary>
+        /// <param name="data"> - буфер приема </param>
+        /// <param name="size"> - размер буфера </param>
+        /// <returns> N>0 - принято N байт; 0 - соединение закрыто; -1 - позиции кольца искажены, канал закрыт; -3 - данных нет </returns>
+        int RawRecive(char* data, size_t size) override;
+
+        /// <summary>
+        /// Метод записи байт в исходящее кольцо, не больше свободного места
+        /// </summary>
+        /// <param name="data"> - данные для отправки </param>
+        /// <param name="size"> - количество байт </param>
+        /// <returns> N>0 - записано N байт; -1 - позиции кольца искажены, канал закрыт; -2 - собеседник закрыл канал; -3 - кольцо полно </returns>
+        int RawSend(const char* data, size_t size) override;
+
+        /// <summary>
+        /// Метод проверки наличия сегмента
+        /// </summary>
+        /// <returns> 1 - сегмент отображен </returns>
+        bool RawValid() override;
+
+        /// <summary>
+        /// Метод проверки режима: транспорт всегда неблокирующий
+        /// </summary>
+        /// <returns> 1 </returns>
+        bool NonBlocking() const override;
+
+        /// <summary>
+        /// Метод засыпания читателя: сброс своего звонка и признак сна во входящем кольце. Звонок сбрасывается
+        /// всегда: он мог прийти и от читателя собеседника, освободившего место в исходящем кольце;
+        /// если отправитель этого места ждет, звонок взводится снова
+        /// </summary>
+        void Park();
+
+        /// <summary>
+        /// Метод отмены сна, если данные пришли между признаком и проверкой: пока читатель не спит, звонок
+        /// должен оставаться взведенным, иначе мультиплексор не вернет готовность к недочитанному кольцу
+        /// </summary>
+        void Unpark();
+
+        /// <summary>
+        /// Метод звонка
+        /// </summary>
+        /// <param name="doorbell"> - звонок </param>
+        void Ring(int doorbell);
+
+        /// <summary>
+        /// Метод освобождения сегмента и дескрипторов, кроме своего звонка
+        /// </summary>
+        void Unmap();
+
+        void* region; // отображение сегмента
+        size_t regionSize; // размер отображения
+        size_t ringSize; // емкость кольца
+        ring_t rx; // входящее кольцо
+        ring_t tx; // исходящее кольцо
+        int memory; // дескриптор сегмента до передачи собеседнику
+        int peerDoorbell; // звонок собеседника
+        unsigned spin; // проверок пустого кольца перед засыпанием
+        bool b_sendWait; // последняя запись не уместилась в исходящее кольцо, отправитель ждет места
+    };
+}
+
+#endif /* SHM_H_ */
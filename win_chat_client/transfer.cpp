@@ -0,0 +1,403 @@
+﻿#include "transfer.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef __WIN32__
+#include <io.h>
+#define OPEN_READ(path) _open(path, _O_RDONLY | _O_BINARY)
+#define OPEN_WRITE(path) _open(path, _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define CLOSE_FILE(fd) _close(fd)
+#define WRITE_FILE(fd, data, size) _write(fd, data, static_cast<unsigned>(size))
+#else
+#include <unistd.h>
+#define OPEN_READ(path) open(path, O_RDONLY)
+#define OPEN_WRITE(path) open(path, O_WRONLY | O_CREAT | O_EXCL, 0644)
+#define CLOSE_FILE(fd) close(fd)
+#define WRITE_FILE(fd, data, size) write(fd, data, size)
+#endif
+
+/// <summary>
+/// функция выделения имени файла из пути
+/// </summary>
+/// <param name="path"> -- путь </param>
+/// <returns> имя файла </returns>
+static std::string_view BaseName(std::string_view path)
+{
+    size_t pos = path.find_last_of("/\\");
+    return pos == std::string_view::npos ? path : path.substr(pos + 1);
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="logger"> -- объект для логгирования </param>
+fileSender_t::fileSender_t(log_t& logger) : fd(-1), stage(idle), frameOffset(0), position(0), chunkLeft(0), b_short(false), logger(logger)
+{}
+
+/// <summary>
+/// деструктор, закрывает файл
+/// </summary>
+fileSender_t::~fileSender_t()
+{
+    Stop();
+}
+
+/// <summary>
+/// метод начала отправки файла
+/// </summary>
+/// <param name="path"> -- путь к файлу </param>
+/// <returns> 1 -- файл открыт, отправка начата </returns>
+bool fileSender_t::Start(const std::string& path)
+{
+    Stop();
+
+    fd = OPEN_READ(path.c_str());
+    if (fd < 0)
+    {
+        logger.doLog("fileSender_t: can't open " + path, errno);
+        return false;
+    }
+
+#ifdef __WIN32__
+    struct _stati64 info;
+    bool b_stat = _fstati64(fd, &info) == 0;
+#else
+    struct stat info;
+    bool b_stat = fstat(fd, &info) == 0;
+#endif
+    if (!b_stat || (info.st_mode & S_IFMT) != S_IFREG)
+    {
+        logger.doLog("fileSender_t: not a regular file " + path, errno);
+        Stop();
+        return false;
+    }
+
+    progress = progress_t();
+    progress.total = info.st_size;
+    progress.start = progress.last = progress_t::clock_t::now();
+    position = 0;
+    chunkLeft = 0;
+    b_short = false;
+    frame = msg_t(TypeMsg::fileBegin, std::to_string(progress.total) + ' ', BaseName(path)).Str();
+    frameOffset = 0;
+    stage = begin;
+    return true;
+}
+
+/// <summary>
+/// метод продвижения отправки
+/// </summary>
+/// <param name="socket"> -- сокет собеседника </param>
+/// <param name="b_frameOnly"> -- только дописать начатый кадр </param>
+/// <returns> 0 -- файл отправлен полностью;
+///           1 -- отправка продолжается;
+///          -1 -- ошибка, отправка прекращена </returns>
+int fileSender_t::Work(network::TCP_socketClient_t& socket, bool b_frameOnly)
+{
+    size_t budget = workBudget;
+
+    while (stage != idle)
+    {
+        if (stage == next)
+        {   // граница кадров: здесь можно уступить сокет сообщениям чата
+            if (b_frameOnly || budget == 0)
+                return 1;
+            if (static_cast<unsigned long long>(position) < progress.total)
+            {
+                chunkLeft = static_cast<size_t>(std::min<unsigned long long>(chunkSize, progress.total - position));
+                frame = msg_t::DataHeader(chunkLeft);
+                stage = header;
+            }
+            else
+            {
+                frame = b_short ? msg_t(TypeMsg::fileEnd, "short").Str() : msg_t(TypeMsg::fileEnd).Str();
+                stage = end;
+            }
+            frameOffset = 0;
+        }
+
+        int code = 0;
+        if (stage == payload)
+        {   // тело части - из файла прямо в сокет
+            long long before = position;
+            code = socket.SendFile(fd, position, chunkLeft);
+            chunkLeft -= static_cast<size_t>(position - before);
+            progress.done = position;
+            progress.last = progress_t::clock_t::now();
+            size_t sent = static_cast<size_t>(position - before);
+            budget = sent < budget ? budget - sent : 0;
+        }
+        else
+            code = socket.Send(frame, frameOffset);
+
+        if (code == -4) // файл укоротили: заголовок части уже ушел, добиваем тело нулями и кончаем файл с отказом
+        {
+            logger.doLog("fileSender_t: file shrank during transfer", 0);
+            frame.assign(chunkLeft, '\0').append(msg_t::EOM());
+            frameOffset = 0;
+            chunkLeft = 0;
+            position = static_cast<long long>(progress.total);
+            b_short = true;
+            stage = trailer;
+            continue;
+        }
+
+        if (code > 0) // отправлено частично, сокет заполнен
+        {
+            if (stage != payload)
+                frameOffset = code;
+            return 1;
+        }
+        if (code == -3) // сокет не готов
+            return 1;
+        if (code < 0)
+        {
+            Stop();
+            return -1;
+        }
+
+        // этап завершен
+        switch (stage)
+        {
+        case header:
+            stage = payload;
+            break;
+        case payload:
+            frame = msg_t::EOM();
+            frameOffset = 0;
+            stage = trailer;
+            break;
+        case end:
+            Stop();
+            return b_short ? -1 : 0;
+        default: // begin, trailer
+            stage = next;
+            break;
+        }
+    }
+
+    return -1;
+}
+
+/// <summary>
+/// метод проверки наличия незавершенной отправки
+/// </summary>
+/// <returns> 1 -- идет отправка </returns>
+bool fileSender_t::Active() const
+{
+    return stage != idle;
+}
+
+/// <summary>
+/// метод проверки незавершенного кадра: пока кадр не дописан, другие сообщения в сокет отправлять нельзя
+/// </summary>
+/// <returns> 1 -- кадр отправлен частично </returns>
+bool fileSender_t::InFrame() const
+{
+    return stage == header || stage == payload || stage == trailer || ((stage == begin || stage == end) && frameOffset > 0);
+}
+
+/// <summary>
+/// метод прекращения отправки
+/// </summary>
+void fileSender_t::Stop()
+{
+    if (fd >= 0)
+        CLOSE_FILE(fd);
+    fd = -1;
+    stage = idle;
+    frame.clear();
+    frameOffset = 0;
+}
+
+/// <summary>
+/// метод возврата хода отправки
+/// </summary>
+/// <returns> ход отправки </returns>
+const progress_t& fileSender_t::Progress() const
+{
+    return progress;
+}
+
+/// <summary>
+/// конструктор
+/// </summary>
+/// <param name="logger"> -- объект для логгирования </param>
+fileReceiver_t::fileReceiver_t(log_t& logger) : fd(-1), maxSize(defaultMaxSize), b_allowed(false), logger(logger)
+{}
+
+/// <summary>
+/// деструктор, удаляет недопринятый файл
+/// </summary>
+fileReceiver_t::~fileReceiver_t()
+{
+    Discard();
+}
+
+/// <summary>
+/// метод разрешения приема следующего файла (команда пользователя ACCEPT)
+/// </summary>
+void fileReceiver_t::Allow()
+{
+    b_allowed = true;
+}
+
+/// <summary>
+/// метод начала приема файла; недопринятый прежний файл удаляется
+/// </summary>
+/// <param name="payload"> -- текст кадра начала: "размер имя" </param>
+/// <returns> 0 -- файл создан; 1 -- прием не разрешен пользователем, файл не создан; -1 -- ошибка </returns>
+int fileReceiver_t::Begin(std::string_view payload)
+{
+    Discard();
+
+    size_t space = payload.find(' ');
+    std::string_view name = space == std::string_view::npos ? std::string_view() : BaseName(payload.substr(space + 1));
+    if (name.empty() || name == "." || name == "..")
+        name = "file";
+    path = "recv_" + std::string(name); // только имя: отправитель не выбирает каталог получателя
+
+    progress = progress_t();
+    std::string size(payload.substr(0, space == std::string_view::npos ? payload.size() : space));
+    char* end = nullptr;
+    errno = 0;
+    progress.total = std::strtoull(size.c_str(), &end, 10);
+    if (size.empty() || *end != '\0' || errno == ERANGE || size[0] == '-')
+    {
+        logger.doLog("fileReceiver_t: bad size " + size, 0);
+        return -1;
+    }
+    if (progress.total > maxSize) // размер задает собеседник
+    {
+        logger.doLog("fileReceiver_t: file too large " + size, 0);
+        return -1;
+    }
+    if (!b_allowed) // файлы на диске создает только согласие пользователя, а не кадр собеседника
+    {
+        progress = progress_t();
+        return 1;
+    }
+    b_allowed = false;
+    progress.start = progress.last = progress_t::clock_t::now();
+
+    // существующий файл не перезаписываем: при совпадении имени добавляем номер
+    std::string base(name);
+    fd = OPEN_WRITE(path.c_str());
+    for (unsigned indx = 1; fd < 0 && errno == EEXIST && indx < maxSuffix; ++indx)
+    {
+        path = "recv_" + std::to_string(indx) + "_" + base;
+        fd = OPEN_WRITE(path.c_str());
+    }
+    if (fd < 0)
+    {
+        logger.doLog("fileReceiver_t: can't create " + path, errno);
+        return -1;
+    }
+    // место заранее не выделяем: размер объявляет собеседник, файл растет только на принятые данные
+    return 0;
+}
+
+/// <summary>
+/// метод записи части файла
+/// </summary>
+/// <param name="data"> -- тело части </param>
+/// <returns> 1 -- часть записана </returns>
+bool fileReceiver_t::Data(std::string_view data)
+{
+    if (fd < 0)
+        return false;
+    if (data.size() > progress.total - progress.done) // больше объявленного размера: ошибка собеседника
+    {
+        logger.doLog("fileReceiver_t: data past end " + path, 0);
+        Discard();
+        return false;
+    }
+
+    while (!data.empty())
+    {
+        auto size = WRITE_FILE(fd, data.data(), data.size());
+        if (size <= 0)
+        {
+            logger.doLog("fileReceiver_t: write fail " + path, errno);
+            Discard();
+            return false;
+        }
+        data.remove_prefix(size);
+        progress.done += size;
+    }
+    progress.last = progress_t::clock_t::now();
+
+    return true;
+}
+
+/// <summary>
+/// метод завершения приема файла
+/// </summary>
+/// <param name="payload"> -- текст кадра конца: пустой, если отправитель передал файл целиком </param>
+/// <returns> 0 -- файл принят полностью; 1 -- файл не принимался; -1 -- файл принят не полностью и удален </returns>
+int fileReceiver_t::End(std::string_view payload)
+{
+    if (fd < 0)
+        return 1;
+    if (progress.done < progress.total || !payload.empty()) // передача оборвалась либо отправитель добил часть нулями
+    {
+        Discard();
+        return -1;
+    }
+    Close();
+    return 0;
+}
+
+/// <summary>
+/// метод задания предела размера принимаемого файла: файл больше предела не создается
+/// </summary>
+/// <param name="size"> -- предел, байт </param>
+void fileReceiver_t::SetMaxSize(unsigned long long size)
+{
+    maxSize = size;
+}
+
+/// <summary>
+/// метод возврата пути к принимаемому файлу
+/// </summary>
+/// <returns> путь к файлу </returns>
+const std::string& fileReceiver_t::Path() const
+{
+    return path;
+}
+
+/// <summary>
+/// метод возврата хода приема
+/// </summary>
+/// <returns> ход приема </returns>
+const progress_t& fileReceiver_t::Progress() const
+{
+    return progress;
+}
+
+/// <summary>
+/// метод закрытия принятого файла
+/// </summary>
+void fileReceiver_t::Close()
+{
+    if (fd >= 0)
+        CLOSE_FILE(fd);
+    fd = -1;
+}
+
+/// <summary>
+/// метод закрытия и удаления недопринятого файла
+/// </summary>
+void fileReceiver_t::Discard()
+{
+    if (fd < 0)
+        return;
+    Close();
+    if (std::remove(path.c_str()) != 0)
+        logger.doLog("fileReceiver_t: can't remove " + path, errno);
+}
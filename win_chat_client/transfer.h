@@ -0,0 +1,216 @@
+﻿#pragma once
+#ifndef TRANSFER_H_
+#define TRANSFER_H_
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "network.h"
+#include "message.h"
+
+/// <summary>
+/// Ход передачи файла
+/// </summary>
+struct progress_t
+{
+    typedef std::chrono::steady_clock clock_t;
+
+    unsigned long long done = 0; // передано байт
+    unsigned long long total = 0; // размер файла
+    clock_t::time_point start; // начало передачи
+    clock_t::time_point last; // последнее продвижение передачи
+
+    /// <summary>
+    /// метод вычисления скорости передачи
+    /// </summary>
+    /// <returns> скорость, байт в секунду </returns>
+    double Rate() const
+    {
+        double sec = std::chrono::duration<double>(last - start).count();
+        return sec > 0 ? done / sec : 0;
+    }
+};
+
+/// <summary>
+/// Класс отправки файла собеседнику кадрами:
+/// [FILB]размер имя[EOM], затем [FILD]длина тело[EOM] по частям, затем [FILE][EOM].
+/// Тело частей уходит в сокет через sendfile, минуя пространство пользователя.
+/// Отправка не блокирует цикл событий: за один вызов Work() отправляется ограниченный объем,
+/// а между кадрами могут уходить сообщения чата
+/// </summary>
+class fileSender_t
+{
+public:
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="logger"> -- объект для логгирования </param>
+    fileSender_t(log_t& logger);
+
+    /// <summary>
+    /// деструктор, закрывает файл
+    /// </summary>
+    ~fileSender_t();
+
+    fileSender_t(const fileSender_t&) = delete;
+    fileSender_t& operator = (const fileSender_t&) = delete;
+
+    /// <summary>
+    /// метод начала отправки файла
+    /// </summary>
+    /// <param name="path"> -- путь к файлу </param>
+    /// <returns> 1 -- файл открыт, отправка начата </returns>
+    bool Start(const std::string& path);
+
+    /// <summary>
+    /// метод продвижения отправки
+    /// </summary>
+    /// <param name="socket"> -- сокет собеседника </param>
+    /// <param name="b_frameOnly"> -- только дописать начатый кадр </param>
+    /// <returns> 0 -- файл отправлен полностью;
+    ///           1 -- отправка продолжается;
+    ///          -1 -- ошибка, отправка прекращена </returns>
+    int Work(network::TCP_socketClient_t& socket, bool b_frameOnly);
+
+    /// <summary>
+    /// метод проверки наличия незавершенной отправки
+    /// </summary>
+    /// <returns> 1 -- идет отправка </returns>
+    bool Active() const;
+
+    /// <summary>
+    /// метод проверки незавершенного кадра: пока кадр не дописан, другие сообщения в сокет отправлять нельзя
+    /// </summary>
+    /// <returns> 1 -- кадр отправлен частично </returns>
+    bool InFrame() const;
+
+    /// <summary>
+    /// метод прекращения отправки
+    /// </summary>
+    void Stop();
+
+    /// <summary>
+    /// метод возврата хода отправки
+    /// </summary>
+    /// <returns> ход отправки </returns>
+    const progress_t& Progress() const;
+protected:
+    /// <summary>
+    /// этапы отправки
+    /// </summary>
+    enum stage_t
+    {
+        idle, // отправки нет
+        begin, // кадр начала файла
+        next, // между кадрами
+        header, // заголовок части
+        payload, // тело части (sendfile)
+        trailer, // конец сообщения части
+        end // кадр конца файла
+    };
+
+    static const size_t chunkSize = 64 * 1024; // длина тела одной части
+    static const size_t workBudget = 1024 * 1024; // наибольший объем за один вызов Work()
+
+    int fd; // дескриптор файла
+    stage_t stage; // текущий этап
+    std::string frame; // служебный кадр либо его часть на отправку
+    unsigned frameOffset; // отправленная часть frame
+    long long position; // смещение в файле
+    size_t chunkLeft; // остаток тела текущей части
+    bool b_short; // файл укоротили во время отправки, собеседник получит кадр конца с отказом
+    progress_t progress; // ход отправки
+    log_t& logger; // объект логгирования
+};
+
+/// <summary>
+/// Класс приема файла от собеседника. Файл создается, только если пользователь разрешил прием (Allow()),
+/// в текущем каталоге с префиксом "recv_" (существующий не перезаписывается, к имени добавляется номер).
+/// Файл растет по мере прихода частей, размер из кадра начала ограничен SetMaxSize().
+/// Недопринятый файл (новый кадр начала, ошибка, обрыв передачи) удаляется
+/// </summary>
+class fileReceiver_t
+{
+public:
+    static const unsigned long long defaultMaxSize = 1ull << 30; // предел размера файла по умолчанию, байт
+
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="logger"> -- объект для логгирования </param>
+    fileReceiver_t(log_t& logger);
+
+    /// <summary>
+    /// деструктор, удаляет недопринятый файл
+    /// </summary>
+    ~fileReceiver_t();
+
+    fileReceiver_t(const fileReceiver_t&) = delete;
+    fileReceiver_t& operator = (const fileReceiver_t&) = delete;
+
+    /// <summary>
+    /// метод разрешения приема следующего файла (команда пользователя ACCEPT)
+    /// </summary>
+    void Allow();
+
+    /// <summary>
+    /// метод начала приема файла; недопринятый прежний файл удаляется
+    /// </summary>
+    /// <param name="payload"> -- текст кадра начала: "размер имя" </param>
+    /// <returns> 0 -- файл создан; 1 -- прием не разрешен пользователем, файл не создан; -1 -- ошибка </returns>
+    int Begin(std::string_view payload);
+
+    /// <summary>
+    /// метод записи части файла
+    /// </summary>
+    /// <param name="data"> -- тело части </param>
+    /// <returns> 1 -- часть записана </returns>
+    bool Data(std::string_view data);
+
+    /// <summary>
+    /// метод завершения приема файла
+    /// </summary>
+    /// <param name="payload"> -- текст кадра конца: пустой, если отправитель передал файл целиком </param>
+    /// <returns> 0 -- файл принят полностью; 1 -- файл не принимался; -1 -- файл принят не полностью и удален </returns>
+    int End(std::string_view payload);
+
+    /// <summary>
+    /// метод задания предела размера принимаемого файла: файл больше предела не создается
+    /// </summary>
+    /// <param name="size"> -- предел, байт </param>
+    void SetMaxSize(unsigned long long size);
+
+    /// <summary>
+    /// метод возврата пути к принимаемому файлу
+    /// </summary>
+    /// <returns> путь к файлу </returns>
+    const std::string& Path() const;
+
+    /// <summary>
+    /// метод возврата хода приема
+    /// </summary>
+    /// <returns> ход приема </returns>
+    const progress_t& Progress() const;
+protected:
+    /// <summary>
+    /// метод закрытия принятого файла
+    /// </summary>
+    void Close();
+
+    /// <summary>
+    /// метод закрытия и удаления недопринятого файла
+    /// </summary>
+    void Discard();
+
+    static const unsigned maxSuffix = 1000; // попыток подобрать свободное имя
+
+    int fd; // дескриптор файла
+    std::string path; // путь к файлу
+    progress_t progress; // ход приема
+    unsigned long long maxSize; // предел размера файла
+    bool b_allowed; // пользователь разрешил прием следующего файла
+    log_t& logger; // объект логгирования
+};
+
+#endif /* TRANSFER_H_ */
@@ -1,10 +1,24 @@
 ﻿
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <list>
 #include <chrono>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <cstdio>
 
 #include "network.h"
+#include "dns.h"
+#include "transfer.h"
+#include "render.h"
+#include "history.h"
+#include "search.h"
+#include "queue.h"
+#include "message.h"
+#include "alloc.h"
+#include "bench.h"
 
 #ifdef __WIN32__
 #include <conio.h>
@@ -16,191 +30,86 @@
 
 
 /// <summary>
-/// тип сообщений
-/// </summary>
-enum TypeMsg
-{
-    defaul, // неопознанное
-    normal, // нормальное, с полезной нагрузкой
-    // сервисные:
-    Exit, // отключение клиента
-    shutDown, // отключение сервера
-    linkOn, // собеседники на связи
-    printinfo // вывод информации по соединению
-};
-
-/// <summary>
-/// класс декоратор над std::string для хранения сообщения, состоящего из 
-/// заголовка (тип сообщения)-6 символов + текст + конец сообщения(EOM)-5 символов
+/// класс наблюдатель за соединением
 /// </summary>
-class msg_t
+class info_t
 {
-public:
+protected:
     /// <summary>
-    /// контсруктор
+    /// метод получения секунд с 1970 года
     /// </summary>
-    /// <param name="type"> -- тип сообщения</param>
-    /// <param name="text"> -- текст сообщения</param>
-    msg_t(TypeMsg type = TypeMsg::defaul, std::string text = "") : offset(0)
+    /// <returns> секунды с 1970 года </returns>
+    long long GetTimeSec() const
     {
-        switch (type)
-        {
-        case normal:
-            this->text = "[NORM]" + text + "[EOM]"; // полезная нагрузка лишь здесь
-            break;
-        case Exit:
-            this->text = "[EXIT][EOM]";
-            break;
-        case shutDown:
-            this->text = "[SHUT][EOM]";
-            break;
-        case linkOn:
-            this->text = "[LINK][EOM]";
-            break;
-        case printinfo:
-            this->text = "[INFO][EOM]"; 
-            break;
-        default:
-            break;
-        }
+        auto now = std::chrono::system_clock::now().time_since_epoch(); // 1970 год
+        auto sec = std::chrono::duration_cast<std::chrono::seconds>(now); // секунды
+        return sec.count();
     }
-
+public:
     /// <summary>
-    /// метод получения не константной ссылки на внутренний std::string с сообщением
+    /// конструктор
     /// </summary>
-    /// <returns> не константная ссылка на внутренний std::string с сообщением </returns>
-    std::string& Update()
-    {
-        offset = 0;
-        return text;
-    }
+    info_t() : b_connectedVisavi(false), b_connectedServer(false), byte(0), sec(0), spinUs(0), sleepMs(0)
+    {}
 
     /// <summary>
-    /// метод получения константной ссылки на внутренний std::string с сообщением 
+    /// метод учета времени ожидания событий мультиплексором
     /// </summary>
-    /// <returns> константная ссылка на внутренний std::string с сообщением </returns>
-    const std::string& Str() const
+    /// <param name="spin"> -- время активного опроса </param>
+    /// <param name="sleep"> -- время блокирующего ожидания </param>
+    void WaitTime(std::chrono::microseconds spin, std::chrono::microseconds sleep)
     {
-        return text;
+        spinUs = spin.count();
+        sleepMs = std::chrono::duration_cast<std::chrono::milliseconds>(sleep).count();
     }
 
     /// <summary>
-    /// метод получения типа сообщения
+    /// метод учета хода передачи файлов
     /// </summary>
-    /// <returns> типа сообщения </returns>
-    TypeMsg Type() const
+    /// <param name="out"> -- ход отправки </param>
+    /// <param name="in"> -- ход приема </param>
+    void FileProgress(const progress_t& out, const progress_t& in)
     {
-        TypeMsg result = TypeMsg::defaul;
-
-        if (text.size() >= 6)
-        {
-            std::string header(text, 0, 6); // извлекаем заголовок
-            if (header == "[NORM]")
-                result = TypeMsg::normal;
-            else if (header == "[EXIT]")
-                result = TypeMsg::Exit;
-            else if (header == "[SHUT]")
-                result = TypeMsg::shutDown;
-            else if (header == "[LINK]")
-                result = TypeMsg::linkOn;
-            else if (header == "[INFO]")
-                result = TypeMsg::printinfo;
-        }
-
-        return result;
+        fileOut = out;
+        fileIn = in;
     }
 
     /// <summary>
-    /// метод получения конца сообщения
+    /// метод возврата хода отправки файла
     /// </summary>
-    /// <returns> конец сообщения </returns>
-    std::string EOM() const
+    /// <returns> ход отправки </returns>
+    const progress_t& FileOut() const
     {
-        return "[EOM]";
+        return fileOut;
     }
 
     /// <summary>
-    /// метод получения текста сообщения без заголовка и конца сообщения
+    /// метод возврата хода приема файла
     /// </summary>
-    /// <param name="buf"> -- ссылка на буфер, куда будет положен полезный текст сообщения </param>
-    ///  <returns> 1 -- текст получен </returns>
-    bool Print(std::string& buf) const
+    /// <returns> ход приема </returns>
+    const progress_t& FileIn() const
     {
-        buf.clear();
-        switch (Type())
-        { // расшифровка сервесных сообщений
-        case TypeMsg::shutDown:
-            buf = "SYSTEM MSG: server get command shutdown";
-            break;
-        case TypeMsg::Exit:
-            buf = "SYSTEM MSG: server get command exit from visavi client";
-            break;
-        case TypeMsg::printinfo:
-            buf = "SYSTEM MSG: other visavi not connected";
-            break;
-        case TypeMsg::linkOn:
-            buf = "SYSTEM MSG: server get connected from other visavi";
-            break;
-        case TypeMsg::defaul:
-            buf = "SYSTEM MSG: server recived defined message";
-            break;
-        case TypeMsg::normal:
-            buf.assign(text, 6, text.size() - 11); // выдаем текст без заголовка и конца сообщения
-            break;
-        default:
-            break;
-        }
-        
-        return !text.empty();
+        return fileIn;
     }
 
     /// <summary>
-    /// метод задания смещения
+    /// метод возврата времени активного опроса
     /// </summary>
-    /// <param name="offset"> -- смещение </param>
-    void SetOffset(unsigned offset)
+    /// <returns> N - микросекунды </returns>
+    long long SpinUs() const
     {
-        if (offset < text.size())
-            this->offset = offset;
+        return spinUs;
     }
 
     /// <summary>
-    /// метод возврата смещения
+    /// метод возврата времени блокирующего ожидания
     /// </summary>
-    /// <returns> -- смещение </returns>
-    unsigned GetOffset() const
+    /// <returns> N - миллисекунды </returns>
+    long long SleepMs() const
     {
-        return offset;
+        return sleepMs;
     }
 
-protected:
-    std::string text; // строка хранящее сообщение, согласно формату, опраделенному выше
-    unsigned offset; // смещение от начала сообщения
-};
-
-/// <summary>
-/// класс наблюдатель за соединением
-/// </summary>
-class info_t
-{
-protected:
-    /// <summary>
-    /// метод получения секунд с 1970 года
-    /// </summary>
-    /// <returns> секунды с 1970 года </returns>
-    long long GetTimeSec() const
-    {
-        auto now = std::chrono::system_clock::now().time_since_epoch(); // 1970 год
-        auto sec = std::chrono::duration_cast<std::chrono::seconds>(now); // секунды
-        return sec.count();
-    }
-public:
-    /// <summary>
-    /// конструктор
-    /// </summary>
-    info_t() : b_connectedVisavi(false), b_connectedServer(false), byte(0), sec(0)
-    {}
-
     /// <summary>
     /// метод мониторинга связи с собеседником
     /// </summary>
@@ -286,6 +195,10 @@ protected:
     bool b_connectedServer; // флаг состояния связи с сервером
     unsigned byte; // количество байт в трафике с момента подключения
     long long sec; // количество секунд с момента подключения
+    long long spinUs; // время активного опроса мультиплексора
+    long long sleepMs; // время блокирующего ожидания мультиплексора
+    progress_t fileOut; // ход отправки файла
+    progress_t fileIn; // ход приема файла
 };
 
 #ifdef __WIN32__
@@ -310,11 +223,11 @@ public:
     /// <summary>
     /// конструктор
     /// </summary>
-    console_t(log_t& logger) : network::socket_t(logger)
+    console_t(log_t& logger) : network::socket_t(logger), scanner("\n"), b_eof(false)
     {
         Socket = 0; // дескриптор stdin
 #endif
-        std::cout << "command :\nINFO -- print info client connection\nSHUTDOWN -- close server\nEXIT -- close this client\n";
+        render.Text("command :\nINFO -- print info client connection\nSENDFILE <path> -- send file to visavi\nACCEPT -- receive the next file from visavi\nPAGE <n> -- scroll back n pages\nHISTORY <from> [to] -- messages from local history (now, sec, hh:mm[:ss], yyyy-mm-dd[Thh:mm[:ss]])\nFIND <words> -- messages from local history with all the words\nSHUTDOWN -- close server\nEXIT -- close this client\n");
     }
 
     /// <summary>
@@ -331,42 +244,83 @@ public:
         if (_kbhit()) // для винды определяет нажатие клавишы
         {
             std::getline(std::cin, buf);
-            result = true;
+            result = AddLine(buf, msgBuf);
         }
 #else
-        buf.resize(512, '\0');
-        unsigned size = read(Socket, &buf[0], buf.size());
-        if (size > 0) 
-        {   // избавляемся от лишнего в буфере
-            std::string tmp(buf, 0, size - 1); 
-            buf.swap(tmp);
-            result = true;
-        }
-#endif
-        if (result) // что то прочитали?
-        {   // парсим команды
-            if (buf == "EXIT")
-                msgBuf.push_back(msg_t(TypeMsg::Exit));
-            else if (buf == "SHUTDOWN")
-                msgBuf.push_back(msg_t(TypeMsg::shutDown));
-            else if (buf == "INFO")
-                msgBuf.push_back(msg_t(TypeMsg::printinfo));
-            else
-                msgBuf.push_back(msg_t(TypeMsg::normal, "VISAVI MSG: " + buf));
+        // читаем все, что накопилось во входном потоке (вставка из буфера обмена, конвейер), до EAGAIN
+        int size = 0;
+        do {
+            size_t old = buf.size(); // хвост незавершенной строки с прошлого такта остается в начале буфера
+            buf.resize(old + chunkSize);
+            size = read(Socket, &buf[old], chunkSize);
+            buf.resize(old + (size > 0 ? size : 0));
+            if (size > 0)
+            {   // ищем переводы строк только в новых байтах
+                size_t first = v_bounds.size();
+                scanner.Scan(buf.data() + old, size, v_bounds);
+                for (size_t indx = first; indx < v_bounds.size(); ++indx)
+                    v_bounds[indx] += old;
+            }
+        } while (size > 0);
+
+        size_t begin = 0; // начало очередной строки
+        for (size_t end : v_bounds)
+        {   // каждая полная строка - отдельное сообщение, перевод строки отбрасываем
+            result |= AddLine(std::string_view(buf.data() + begin, end - begin - 1), msgBuf);
+            begin = end;
         }
+        v_bounds.clear();
 
+        b_eof = size == 0;
+        if (b_eof && begin < buf.size())
+        {   // конец входного потока: последняя строка без перевода строки
+            result |= AddLine(std::string_view(buf.data() + begin, buf.size() - begin), msgBuf);
+            begin = buf.size();
+            scanner.Reset();
+        }
+        buf.erase(0, begin); // оставляем только незавершенную строку
+#endif
         return result;
     }
 
+#ifndef __WIN32__
+    /// <summary>
+    /// метод проверки конца входного потока (конвейер закрыт либо Ctrl+D)
+    /// </summary>
+    /// <returns> 1 -- входной поток закончился </returns>
+    bool Eof() const
+    {
+        return b_eof;
+    }
+#endif
+
     /// <summary>
     /// метод вывода сообщения на экран
     /// </summary>
     /// <param name="msgBuf"> ссылка на сообщение для вывода </param>
-    void PrintMsg(const msg_t msgBuf) const
+    void PrintMsg(const msg_t& msgBuf)
     {
-        std::string out;
-        if (msgBuf.Print(out))
-            std::cout << out << '\n';
+        std::string_view text = msgBuf.Print(); // части файла текста не имеют
+        if (!text.empty())
+            render.Line(text); // прямо из буфера сообщения в буфер вывода такта
+    }
+
+    /// <summary>
+    /// метод вывода накопленного за такт текста на экран
+    /// </summary>
+    /// <param name="b_force"> -- вывести, не дожидаясь окончания периода </param>
+    void Flush(bool b_force = false)
+    {
+        render.Flush(b_force);
+    }
+
+    /// <summary>
+    /// метод расчета времени до следующего вывода на экран
+    /// </summary>
+    /// <returns> миллисекунды до вывода; -1 -- выводить нечего </returns>
+    int Due() const
+    {
+        return render.Due();
     }
 
     /// <summary>
@@ -375,16 +329,123 @@ public:
     /// <param name="info"> -- ссылка на класс наблюдатель за соединением </param>
     void PrintInfo(const info_t& info)
     {
-        std::cout << "info: connected visavi: " << info.ConnectedVisavi()
+        std::ostringstream text;
+        text << "info: connected visavi: " << info.ConnectedVisavi()
             << " connected server: " << info.ConnectedServer()
-            << " time: " << info.Sec() << "sec byte: " << info.Byte() << '\n';
+            << " time: " << info.Sec() << "sec byte: " << info.Byte()
+            << " spin: " << info.SpinUs() << "us sleep: " << info.SleepMs() << "ms" << '\n';
+        PrintProgress(text, "file out", info.FileOut());
+        PrintProgress(text, "file in", info.FileIn());
+        allocTrace_t::Report(text); // только в сборке с ALLOC_TRACE
+        render.Text(text.str());
+    }
+
+    /// <summary>
+    /// метод вывода записей истории
+    /// </summary>
+    /// <param name="v_record"> -- записи истории </param>
+    void PrintHistory(const std::vector<history_t::record_t>& v_record)
+    {
+        std::string text;
+        for (const history_t::record_t& record : v_record)
+            text.append(history_t::FormatTime(record.time)).append(record.direction == history_t::out ? " > " : " < ").append(record.text).push_back('\n');
+        render.Text(text);
     }
 protected:
+    /// <summary>
+    /// метод вывода хода передачи файла
+    /// </summary>
+    /// <param name="text"> -- поток вывода </param>
+    /// <param name="label"> -- направление передачи </param>
+    /// <param name="progress"> -- ход передачи </param>
+    void PrintProgress(std::ostream& text, const char* label, const progress_t& progress)
+    {
+        if (progress.total == 0 && progress.done == 0) // передач не было
+            return;
+        text << label << ": " << progress.done << '/' << progress.total << " byte ("
+            << (progress.total ? progress.done * 100 / progress.total : 100) << "%) "
+            << progress.Rate() / (1024 * 1024) << " MB/s" << '\n';
+    }
+
+    /// <summary>
+    /// метод разбора одной строки ввода: команда либо текст сообщения
+    /// </summary>
+    /// <param name="line"> -- строка без перевода строки </param>
+    /// <param name="msgBuf"> -- ссылка на список буферных сообщений </param>
+    /// <returns> 1 -- добавлено валидное сообщение </returns>
+    bool AddLine(std::string_view line, std::list<msg_t>& msgBuf)
+    {
+        const std::string_view sendFileCmd = "SENDFILE ";
+        const std::string_view pageCmd = "PAGE";
+        const std::string_view historyCmd = "HISTORY ";
+        const std::string_view findCmd = "FIND ";
+
+        if (!line.empty() && line.back() == '\r') // перевод строки windows во входном файле
+            line.remove_suffix(1);
+
+        if (line == "EXIT")
+            msgBuf.emplace_back(TypeMsg::Exit);
+        else if (line == "SHUTDOWN")
+            msgBuf.emplace_back(TypeMsg::shutDown);
+        else if (line == "INFO")
+            msgBuf.emplace_back(TypeMsg::printinfo);
+        else if (line == "ACCEPT")
+            msgBuf.emplace_back(TypeMsg::acceptFile);
+        else if (line.substr(0, sendFileCmd.size()) == sendFileCmd)
+            msgBuf.emplace_back(TypeMsg::sendFile, line.substr(sendFileCmd.size()));
+        else if (line.substr(0, historyCmd.size()) == historyCmd)
+            msgBuf.emplace_back(TypeMsg::history, line.substr(historyCmd.size()));
+        else if (line.substr(0, findCmd.size()) == findCmd)
+            msgBuf.emplace_back(TypeMsg::find, line.substr(findCmd.size()));
+        else if (line.substr(0, pageCmd.size()) == pageCmd && (line.size() == pageCmd.size() || line[pageCmd.size()] == ' '))
+        {   // прокрутка - локальная команда, сообщение не создается
+            render.Page(std::strtoul(std::string(line.substr(pageCmd.size())).c_str(), NULL, 10));
+            return false;
+        }
+        else // текст копируется один раз - сразу в буфер сообщения
+            msgBuf.emplace_back(TypeMsg::normal, "VISAVI MSG: ", line);
+
+        return true;
+    }
+
     std::string buf; // буферная строка
+    render_t render; // вывод на экран и кольцо прокрутки
+#ifndef __WIN32__
+    static const size_t chunkSize = 4096; // размер одного чтения из входного потока
+    network::delimiterScanner_t scanner; // поиск переводов строк
+    std::vector<size_t> v_bounds; // концы полных строк в buf
+    bool b_eof; // входной поток закончился
+#endif
 };
 
 /// <summary>
-/// класс управления чатом
+/// параметры командной строки
+/// </summary>
+struct param_t
+{
+    unsigned port = 0; // порт сервера
+    std::string host = IP_ADRES; // имя узла либо IP адрес сервера
+    std::string unixPath; // путь локального сокета сервера (AF_UNIX) вместо узла и порта
+    int profile = network::profile_t::NONE; // профиль производительности сокета
+    unsigned spin = 0; // бюджет активного опроса мультиплексора, мкс (0 - только блокирующее ожидание)
+    int cpu = -1; // ядро процессора для цикла событий (-1 - без привязки)
+    std::string history = "chat_history"; // путь к файлам истории без расширения
+    bool threads = false; // сеть и интерфейс в отдельных потоках
+    unsigned heartbeat = 5000; // период проверки связи с сервером, мс (0 - без проверки)
+    size_t maxFrame = 16 * 1024 * 1024; // наибольший размер принимаемого кадра, байт (0 - без ограничения)
+    unsigned long long maxFile = fileReceiver_t::defaultMaxSize; // наибольший размер принимаемого файла, байт
+    size_t bench = 0; // сообщений прогона через канал в памяти (0 - обычная работа чата)
+    size_t benchSize = 100; // длина текста сообщения прогона, байт
+    network::pipeProfile_t pipe; // параметры канала прогона
+    size_t benchShm = 0; // емкость кольца общей памяти прогона (0 - прогон через канал в памяти)
+};
+
+/// <summary>
+/// класс управления чатом. Работа делится на две половины: ввод-вывод (сокеты, подключение к серверу,
+/// передача файла) и интерфейс (консоль, история, поиск, вывод на экран). Половины обмениваются
+/// сообщениями через ограниченные очереди SPSC. В однопоточном режиме обе половины выполняются
+/// по очереди в одном цикле; в двухпоточном (--threads) у каждой свой поток и свое ожидание событий,
+/// поток ввода-вывода будит сокет пробуждения, и медленный терминал не задерживает прием и отправку
 /// </summary>
 class chat_manager_t
 {
@@ -392,24 +453,36 @@ public:
     /// <summary>
     /// конструктор
     /// </summary>
-    /// <param name="port"> -- номер порта для подключения </param>
-    chat_manager_t(unsigned port) : logger(), multiplexor(logger), u_counter(0), b_exit(false), b_shut(false), b_echo(false)
+    /// <param name="param"> -- параметры подключения </param>
+    chat_manager_t(const param_t& param) : logger(), multiplexor(logger), uiMultiplexor(logger), resolver(logger), connector(multiplexor, logger), sender(logger), receiver(logger), history(logger), search(history, logger), txQueue(queueSize), rxQueue(queueSize), infoQueue(infoQueueSize), ioBuffers(bufferQueueSize), uiBuffers(bufferQueueSize), host(param.host), unixPath(param.unixPath), port(param.port), b_rxStream(false), rxStreamType(TypeMsg::defaul), u_counter(0), b_exit(false), b_shut(false), b_echo(false), b_connect(true), b_sendInterest(false), b_online(false), b_reconnect(false), b_threads(param.threads), b_done(false), heartbeat(param.heartbeat), retryDelay(retryMin), maxFrame(param.maxFrame)
     {
-        socket = std::make_shared<network::TCP_socketClient_t>(IP_ADRES, port, logger);
-        multiplexor.AddReader(socket);
+        connector.SetProfile(param.profile);
+        connector.SetDeadTimeout(param.heartbeat * deadPeriods); // неподтвержденные данные (в т.ч. [HRBT]) разрывают соединение
+        receiver.SetMaxSize(param.maxFile);
+        multiplexor.SetSpin(std::chrono::microseconds(param.spin), param.cpu);
+        if (param.bench == 0 && history.Open(param.history)) // без истории чат работает, ошибка уже в логе; прогону история не нужна
+            search.Open(param.history); // индекс дочитывает историю в цикле, запуск не ждет
 #ifndef __WIN32__
         console = std::make_shared<console_t>(logger);
-        multiplexor.AddReader(console);
+        UiMultiplexor().AddReader(console);
 #endif
+        if (b_threads)
+        {   // каждый поток ждет свои события и свой сокет пробуждения
+            ioWakeup = std::make_shared<network::wakeup_t>(logger);
+            uiWakeup = std::make_shared<network::wakeup_t>(logger);
+            multiplexor.AddReader(ioWakeup);
+            uiMultiplexor.AddReader(uiWakeup);
+        }
     }
 
     // деструктор
     ~chat_manager_t()
     {
-        if (socket->GetConnected() && !b_exit) // отключаем свое соединение на сервере
+        if (socket && socket->GetConnected() && !b_exit) // отключаем свое соединение на сервере
         {
             msg_t tmp(TypeMsg::Exit);
-            socket->Send(tmp.Str());
+            if (0 == socket->SendBuffered(tmp.Str())) // за недописанным затором, чтобы не разорвать его
+                DrainOutbox();
         }
     }
     /// <summary>
@@ -417,128 +490,947 @@ public:
     /// </summary>
     void Work()
     {
-        while (!b_exit)
+        allocTrace_t::Reset(); // выделения запуска не относятся к сообщениям
+        if (b_threads)
         {
-            multiplexor.Work(50);
-            // отправка
-#ifdef __WIN32__
-            if (console.ParseInput(l_msg_TX) || !l_msg_TX.empty())
-#else
-            if (multiplexor.GetReadyReader(console) && console->ParseInput(l_msg_TX) || !l_msg_TX.empty())
-#endif
-            {
-                //std::cout << "OUT: " << l_msg_TX.front().Str() << '\n'; ////////////////////////////////наладка
-                for (auto it = l_msg_TX.begin(); it != l_msg_TX.end(); ) // идем по списку сообщений
-                    if (it->Type() == TypeMsg::printinfo)
-                    {
-#ifdef __WIN32__
-                        console.PrintInfo(info); // вывод информации
-#else
-                        console->PrintInfo(info); // вывод информации
-#endif
-                        it = l_msg_TX.erase(it);
-                    }
-                    else
+            std::thread io([this]
+                {
+                    while (!b_exit)
                     {
-                        if (it->Type() == TypeMsg::Exit) // мониторим команду на выход
-                        {
-                            b_exit = true;
-                            if (!socket->GetConnected())
-                            {
-                                it = l_msg_TX.erase(it);
-                                continue;
-                            }
-                        }
-                        if (it->Type() == TypeMsg::shutDown) // мониторим команду на отключение сервера
-                            b_shut = true;
-
-                        int code = socket->Send(it->Str(), it->GetOffset()); // отправляем сообщение
-                        if (0 == code) // если сообщение отправлено полностью
-                        {
-                            info.AddCountByte(it->Str().size()); // считаем трафик
-                            it = l_msg_TX.erase(it); // удаляем сообщение
-                        }
-                        else if (0 < code) // если отправили часть
-                        {
-                            it->SetOffset(code); // запоминаем где остановились
-                            break; // до следующей итерации
-                        }
-                        else if (-3 == code) // сокет не готов к отправке
-                            break; // до следующей итерации
-                        else if (-1 == code)// системная ошибка
-                            it = l_msg_TX.erase(it); // удаляем сообщения
-                        else if (-2 == code) // сокет закрыт
-                        {
-                            it = l_msg_TX.erase(it);
-#ifdef __WIN32__
-                            console.PrintMsg(msg_t(TypeMsg::normal, "SYSTEM MSG: server not connected")); // диагностируем
-#else 
-                            console->PrintMsg(msg_t(TypeMsg::normal, "SYSTEM MSG: server not connected")); // диагностируем
-#endif
-                        }
+                        multiplexor.Work(IoTimeout());
+                        IoTick();
                     }
+                    b_done = true; // интерфейс завершается вслед за сетью
+                    uiWakeup->Notify();
+                });
+            while (!b_done)
+            {
+                int due = Console().Due();
+                uiMultiplexor.Work(due >= 0 && due < 50 ? due : 50); // не пропускаем момент вывода на экран
+                UiTick();
             }
-            // прием
-            if (multiplexor.GetReadyReader(socket) && 0 == socket->Recive(msg_RX.Update(), msg_RX.EOM())) // если пришли данные и сообщение полное
+            io.join();
+            UiTick(); // последние сообщения сети
+        }
+        else
+            while (!b_exit)
             {
-                //std::cout << "IN: " << msg_RX.Str() << '\n'; ////////////////////////////////наладка
-                info.AddCountByte(msg_RX.Str().size()); // считаем трафик
+                int due = Console().Due();
+                int timeout = IoTimeout();
+                multiplexor.Work(due >= 0 && due < timeout ? due : timeout); // не пропускаем момент вывода на экран
+                IoTick();
+                UiTick();
+            }
+        Console().Flush(true);
+    }
 
-                switch (msg_RX.Type())
-                {
-                case TypeMsg::linkOn: // подключение собеседника
-                    ++u_counter;
-                    break;
-                case TypeMsg::Exit: // отключение собеседника
-                    u_counter = u_counter > 0 ? u_counter - 1 : 0;
-                    break;
-                case TypeMsg::printinfo: // отсутствует собеседник
-                    u_counter = 0;
-                    break;
-                case TypeMsg::shutDown: // если сервер закрывается, толкаем свои соединения
-                    l_msg_TX.push_back(msg_t(TypeMsg::shutDown));
-                    b_echo = true;
-                    break;
-                default:
+protected:
+    /// <summary>
+    /// метод расчета таймаута ожидания событий сети
+    /// </summary>
+    /// <returns> таймаут, мс </returns>
+    int IoTimeout()
+    {
+        if (socket && socket->PendingFrame()) // кадры уже приняты, ждать сокет не нужно
+            return 0;
+        if (!l_msg_RX.empty()) // очередь интерфейса полна, пробуем снова через 1 мс
+            return 1;
+        return 50;
+    }
+
+    /// <summary>
+    /// метод такта половины ввода-вывода: подключение, отправка, прием
+    /// </summary>
+    void IoTick()
+    {
+        if (b_threads)
+        {
+            ioWakeup->Drain(); // до чтения очереди, иначе можно пропустить пробуждение
+            msgPool_t::Local().Give(uiBuffers, poolKeep); // буферы отправленных сообщений создал интерфейс, возвращаем ему
+            msgPool_t::Local().Take(ioBuffers);
+            msg_t msg;
+            while (txQueue.Pop(msg))
+                l_msg_TX.push_back(std::move(msg));
+            while (!l_msg_RX.empty() && rxQueue.Push(std::move(l_msg_RX.front()))) // что не поместилось в прошлый раз
+                l_msg_RX.pop_front();
+            uiWakeup->Notify();
+        }
+        // подключение к серверу, не блокирует цикл
+        if (b_connect)
+            Connect();
+        if (sender.InFrame()) // начатую часть файла дописываем раньше сообщений чата
+            SendFileWork(true);
+        // отправка: служебные кадры раньше массовых, массовые - частями по мере освобождения буфера исходящих
+        SortLanes();
+        if (!l_msg_control.empty() || !l_msg_bulk.empty())
+        {
+            ALLOC_SCOPE(allocSend);
+            socket->Cork(true); // пачка сообщений такта уходит полными сегментами (профиль throughput)
+            SendControl();
+            SendBulk();
+            socket->Cork(false);
+        }
+        if (sender.Active() && l_msg_control.empty() && l_msg_bulk.empty() && socket->Backlog() == 0) // файл идет в паузах между сообщениями чата
+            SendFileWork(false);
+        UpdateSendInterest();
+        // прием; пока интерфейс не забрал прошлые сообщения, сокет не читаем - очередь ограничена
+        int rxCode = -3;
+        if (l_msg_RX.empty() && (!tcpSocket || multiplexor.GetReadyReader(tcpSocket) || socket->PendingFrame())) // транспорт прогона без дескриптора читается каждый такт
+        {
+            ALLOC_SCOPE(allocRecv);
+            rxCode = socket->ReciveStream(msg_RX.Update(), msg_RX.EOM(), rxChunk); // длинный кадр приходит частями
+        }
+        if (0 == rxCode || 1 == rxCode)
+            info.AddCountByte(msg_RX.Str().size()); // считаем трафик
+        if (-4 == rxCode && b_online) // сокет уже разорвал соединение
+            Reconnect("SYSTEM MSG: message from server exceeds size limit, reconnecting");
+        if (1 == rxCode || (0 == rxCode && b_rxStream)) // часть длинного кадра
+        {
+            ALLOC_SCOPE(allocParse);
+            rxCode = TakeStream(0 == rxCode) ? 0 : 2;
+            if (0 != rxCode)
+                msg_RX.Update().clear();
+        }
+        if (0 == rxCode) // если сообщение полное
+        {
+            ALLOC_SCOPE(allocParse);
+            //std::cout << "IN: " << msg_RX.Str() << '\n'; ////////////////////////////////наладка
+
+            int fileCode = 0; // результат приема файла
+            switch (msg_RX.Type())
+            {
+            case TypeMsg::linkOn: // подключение собеседника
+                ++u_counter;
+                rxPartial.clear();
+                break;
+            case TypeMsg::Exit: // отключение собеседника
+                u_counter = u_counter > 0 ? u_counter - 1 : 0;
+                rxPartial.clear(); // остаток недосланного сообщения уже не придет
+                break;
+            case TypeMsg::printinfo: // отсутствует собеседник
+                u_counter = 0;
+                rxPartial.clear();
+                break;
+            case TypeMsg::part: // часть длинного сообщения
+                if (u_counter > 1)
+                {   // сервер не указывает отправителя: части сообщений разных собеседников перемешались бы, выводим как есть
+                    msg_RX = msg_t(TypeMsg::normal, msg_RX.Payload());
                     break;
                 }
-                // вывод сообщения
+                rxPartial.append(msg_RX.Payload());
+                if (rxPartial.size() >= rxChunk) // набранное выводим, не дожидаясь конца сообщения
+                {
+                    msg_RX = msg_t(TypeMsg::normal, rxPartial);
+                    rxPartial.clear();
+                }
+                break;
+            case TypeMsg::normal: // последняя часть длинного сообщения дополняет собранное начало
+                if (!rxPartial.empty())
+                {
+                    msg_RX = msg_t(TypeMsg::normal, rxPartial, msg_RX.Payload());
+                    rxPartial.clear();
+                }
+                break;
+            case TypeMsg::shutDown: // если сервер закрывается, толкаем свои соединения
+                l_msg_TX.push_back(msg_t(TypeMsg::shutDown));
+                b_echo = true;
+                break;
+            case TypeMsg::fileBegin: // файл создается, только если пользователь заранее дал ACCEPT
+                fileCode = receiver.Begin(msg_RX.Payload());
+                if (fileCode == 1)
+                    msg_RX = msg_t(TypeMsg::systemMsg, "SYSTEM MSG: visavi sends a file, not accepted (type ACCEPT to receive the next one)");
+                else if (fileCode < 0)
+                    msg_RX = msg_t(TypeMsg::systemMsg, "SYSTEM MSG: file from visavi refused");
+                break;
+            case TypeMsg::fileData:
+                receiver.Data(msg_RX.Data());
+                break;
+            case TypeMsg::fileEnd:
+                fileCode = receiver.End(msg_RX.Payload());
+                if (fileCode == 1)
+                    msg_RX = msg_t(TypeMsg::systemMsg, "SYSTEM MSG: file from visavi skipped");
+                else if (fileCode < 0)
+                    msg_RX = msg_t(TypeMsg::systemMsg, "SYSTEM MSG: file from visavi is incomplete, removed");
+                break;
+            default:
+                break;
+            }
+            // вывод сообщения; части файла текста не имеют и в интерфейс не передаются
+            if (!msg_RX.Print().empty())
+                Deliver(msg_RX);
+            msg_RX.Update().clear();
+
+            if (b_shut) // сервер отключился по нашей команде
+                socket->ResetConnected();
+        }
+
+        if (b_exit && socket->GetConnected()) // кадр выхода мог остаться в буфере исходящих
+            DrainOutbox();
+        if (b_shut && b_echo || b_exit) // сервер отключился по команде другого клиента
+            socket->ResetConnected();
+        // проверка связи и переподключение
+        if (b_online && !socket->GetConnected() && !b_shut && !b_exit)
+            Reconnect("SYSTEM MSG: connection to server lost, reconnecting");
+        Heartbeat();
+        if (b_reconnect && !b_connect && clock_t::now() >= retryAt)
+            b_connect = true;
+
+        // обновление диагностики
+        info.ConnectedServer(socket->GetConnected());
+        info.ConnectedVisavi(u_counter > 0);
+        info.WaitTime(multiplexor.GetWaitStat().spin, multiplexor.GetWaitStat().sleep);
+        info.FileProgress(sender.Progress(), receiver.Progress());
+        b_exit |= !socket->GetConnected() && b_shut;
+        // временные строки такта больше не нужны
+        tickArena_t::Local().Reset();
+    }
+
+    /// <summary>
+    /// метод такта половины интерфейса: ввод с консоли, локальные команды, вывод сообщений сети
+    /// </summary>
+    void UiTick()
+    {
+        if (b_threads)
+        {
+            uiWakeup->Drain(); // до чтения очередей, иначе можно пропустить пробуждение
+            msgPool_t::Local().Give(ioBuffers, poolKeep); // буферы выведенных сообщений создала сеть, возвращаем ей
+            msgPool_t::Local().Take(uiBuffers);
+        }
+        // ввод
+        std::list<msg_t> l_msg_input; // сообщения, введенные за такт
 #ifdef __WIN32__
-                console.PrintMsg(msg_RX);
+        {
+            ALLOC_SCOPE(allocInput);
+            console.ParseInput(l_msg_input);
+        }
 #else
-                console->PrintMsg(msg_RX);
+        if (UiMultiplexor().GetReadyReader(console))
+        {
+            {
+                ALLOC_SCOPE(allocInput);
+                console->ParseInput(l_msg_input);
+            }
+            if (console->Eof()) // после конца потока poll() сообщал бы готовность к чтению на каждом такте
+                UiMultiplexor().deleteReader(console);
+        }
 #endif
-                msg_RX.Update().clear();
+        for (msg_t& msg : l_msg_input)
+            if (msg.Type() == TypeMsg::history)
+                PrintHistory(msg.Payload());
+            else if (msg.Type() == TypeMsg::find)
+                Find(msg.Payload());
+            else
+            {   // остальное - для сети; свое сообщение попадает в историю, когда передано на отправку
+                if (msg.Type() == TypeMsg::normal)
+                {
+                    ALLOC_SCOPE(allocRender);
+                    ALLOC_MESSAGE();
+                    history.Append(history_t::out, msg);
+                }
+                l_msg_UI.push_back(std::move(msg));
+            }
+        // передача сообщений половине ввода-вывода
+        if (!b_threads)
+            l_msg_TX.splice(l_msg_TX.end(), l_msg_UI);
+        else if (!l_msg_UI.empty())
+        {
+            while (!l_msg_UI.empty() && txQueue.Push(std::move(l_msg_UI.front()))) // что не поместилось - в следующем такте
+                l_msg_UI.pop_front();
+            ioWakeup->Notify();
+        }
+        // сообщения от половины ввода-вывода
+        if (b_threads)
+        {
+            msg_t msg;
+            while (rxQueue.Pop(msg))
+                OnMessage(msg);
+            info_t snapshot;
+            while (infoQueue.Pop(snapshot))
+                Console().PrintInfo(snapshot);
+            if (!l_msg_UI.empty())
+                ioWakeup->Notify();
+        }
+        // новые записи истории - в поисковый индекс, ограниченно за такт
+        search.Update(searchBudget);
+        // вывод всего текста такта одним вызовом
+        {
+            ALLOC_SCOPE(allocRender);
+            Console().Flush();
+        }
+        tickArena_t::Local().Reset();
+    }
+
+    /// <summary>
+    /// метод передачи сообщения сети в интерфейс (вызывается половиной ввода-вывода)
+    /// </summary>
+    /// <param name="msg"> -- сообщение; в двухпоточном режиме содержимое уходит в очередь </param>
+    virtual void Deliver(msg_t& msg)
+    {
+        if (!b_threads)
+            OnMessage(msg);
+        else
+        {
+            ALLOC_SCOPE(allocRender);   // в очередь уходит копия в буфере из пула: буфер приема msg_RX, выросший под кадр, остается у сети
+            msg_t copy(msg);
+            if (!l_msg_RX.empty() || !rxQueue.Push(std::move(copy))) // порядок сообщений сохраняется
+                l_msg_RX.push_back(std::move(copy));
+            uiWakeup->Notify();
+        }
+    }
+
+    /// <summary>
+    /// метод передачи диагностики в интерфейс (вызывается половиной ввода-вывода)
+    /// </summary>
+    void DeliverInfo()
+    {
+        if (!b_threads)
+            Console().PrintInfo(info);
+        else
+        {
+            info_t snapshot(info); // копия: info меняет только поток ввода-вывода
+            infoQueue.Push(std::move(snapshot)); // очередь полна - пользователь и так ждет ответа на прошлый запрос
+            uiWakeup->Notify();
+        }
+    }
 
-                if (b_shut) // сервер отключился по нашей команде
-                    socket->ResetConnected();
+    /// <summary>
+    /// метод обработки сообщения сети в интерфейсе: история и вывод на экран
+    /// </summary>
+    /// <param name="msg"> -- сообщение </param>
+    void OnMessage(const msg_t& msg)
+    {
+        ALLOC_SCOPE(allocRender);
+        if (msg.Type() == TypeMsg::normal)
+            ALLOC_MESSAGE();
+        if (msg.Type() != TypeMsg::systemMsg) // системные сообщения клиента не история переписки
+            history.Append(history_t::in, msg);
+        Console().PrintMsg(msg);
+    }
+
+    /// <summary>
+    /// метод продвижения подключения к серверу: разрешение имени, затем попытки подключения по всем адресам.
+    /// Сервер на том же узле доступен через локальный сокет (--unix), имя тогда не разрешается
+    /// </summary>
+    void Connect()
+    {
+        if (!socket) // транспорт по умолчанию - TCP сокет, он переживает переподключения
+        {
+            tcpSocket = std::make_shared<network::TCP_socketClient_t>(logger);
+            socket = tcpSocket;
+            socket->SetFrameLength(&msg_t::FrameLength); // части файла отделяются по длине
+            socket->SetMaxFrame(maxFrame); // кадр сверх предела - ошибка протокола, а не повод расти памяти
+        }
+        if (!connector.Active() && !unixPath.empty())
+        {
+            std::vector<network::endpoint_t> v_endpoint(1);
+            v_endpoint.front().SetPath(unixPath.c_str()); // длина пути проверена при разборе параметров
+            connector.Start(v_endpoint);
+        }
+        else if (!connector.Active()) // адреса еще не получены
+        {
+            std::vector<network::endpoint_t> v_endpoint;
+            int code = resolver.Resolve(host, port, v_endpoint);
+            if (1 == code) // имя разрешается, ждем следующего такта
+                return;
+            if (0 > code)
+            {
+                b_connect = false;
+                PrintSystem("SYSTEM MSG: can't resolve server name");
+                return;
             }
+            connector.Start(v_endpoint);
+        }
 
-            if (b_shut && b_echo || b_exit) // сервер отключился по команде другого клиента
-                socket->ResetConnected();
+        int code = connector.Work(*tcpSocket);
+        if (0 == code) // соединение установлено
+        {
+            b_connect = false;
+            multiplexor.AddReader(tcpSocket);
+            b_online = true;
+            lastTx = txProgress = clock_t::now();
+            if (b_reconnect)
+                PrintSystem("SYSTEM MSG: reconnected to server");
+            b_reconnect = false;
+            retryDelay = retryMin;
+        }
+        else if (0 > code) // ни один адрес не ответил
+        {
+            b_connect = false;
+            resolver.Forget(host); // при следующем подключении адреса запросим заново
+            if (b_reconnect)
+            {   // связь была - пробуем снова, все реже
+                retryAt = clock_t::now() + retryDelay;
+                PrintSystem("SYSTEM MSG: server not connected, retry in " + std::to_string(retryDelay.count()) + " ms");
+                retryDelay = (std::min)(retryDelay * 2, retryMax);
+            }
+            else
+                PrintSystem("SYSTEM MSG: server not connected");
+        }
+    }
 
-            // обновление диагностики
-            info.ConnectedServer(socket->GetConnected());
-            info.ConnectedVisavi(u_counter > 0);
-            b_exit |= !socket->GetConnected() && b_shut;
+    /// <summary>
+    /// метод проверки связи с сервером. Если клиенту долго нечего отправить, уходит кадр [HRBT];
+    /// сообщения чата и части файла его заменяют. Сервер на [HRBT] не отвечает, а собеседники могут молчать,
+    /// поэтому тишина приема о связи ничего не говорит. Соединение считается мертвым, если за три периода
+    /// не сдвинулся затор в буфере исходящих; если же данные ушли в ядро, но не подтверждены, соединение
+    /// разрывает само ядро по пределу из SetDeadTimeout() (TCP_USER_TIMEOUT), и ошибку видят прием и отправка
+    /// </summary>
+    void Heartbeat()
+    {
+        if (heartbeat.count() == 0 || !b_online || !socket->GetConnected())
+            return;
+        ALLOC_SCOPE(allocSend);
+        clock_t::time_point now = clock_t::now();
+        if (socket->Backlog() == 0)
+            txProgress = now;
+        if (now - txProgress > heartbeat * deadPeriods)
+            Reconnect("SYSTEM MSG: server does not accept data, reconnecting");
+        else if (now - lastTx >= heartbeat && socket->Backlog() == 0 && !sender.InFrame())
+        {
+            msg_t tmp(TypeMsg::heartbeat);
+            if (0 == socket->SendBuffered(tmp.Str()))
+                info.AddCountByte(tmp.Str().size());
+            lastTx = now;
         }
     }
-protected:
+
+    /// <summary>
+    /// метод переподключения: мертвое соединение снимается с мультиплексора и закрывается,
+    /// адреса сервера запрашиваются заново (сервер мог переехать либо ответить другим адресом)
+    /// </summary>
+    /// <param name="reason"> -- причина для пользователя </param>
+    void Reconnect(std::string_view reason)
+    {
+        PrintSystem(reason);
+        multiplexor.deleteReader(tcpSocket); // пока у сокета прежний дескриптор
+        if (b_sendInterest)
+            multiplexor.deleteSender(tcpSocket);
+        b_sendInterest = false;
+        socket->Shutdown();
+        socket->ResetConnected();
+        if (sender.Active())
+        {
+            sender.Stop();
+            PrintSystem("SYSTEM MSG: file transfer failed");
+        }
+        resolver.Forget(host);
+        msg_RX.Update().clear(); // начало кадра прежнего соединения
+        rxPartial.clear();
+        b_rxStream = false;
+        u_counter = 0;
+        b_online = false;
+        b_reconnect = true;
+        b_connect = true;
+    }
+
+    /// <summary>
+    /// метод раскладки сообщений на отправку по полосам: сообщения чата - в массовую полосу,
+    /// служебные кадры и локальные команды - в полосу управления. Порядок внутри полосы сохраняется.
+    /// Кадр выхода ([EXIT], [SHUT]) закрывает соединение, поэтому не обгоняет набранные раньше сообщения:
+    /// пока соединение живо, он и все после него ждут, пока массовая полоса не уйдет целиком (не дольше exitDrain)
+    /// </summary>
+    void SortLanes()
+    {
+        while (!l_msg_TX.empty())
+        {
+            TypeMsg type = l_msg_TX.front().Type();
+            if ((type == TypeMsg::Exit || type == TypeMsg::shutDown) && !l_msg_bulk.empty() && socket->GetConnected())
+            {
+                clock_t::time_point now = clock_t::now();
+                if (exitHold == clock_t::time_point())
+                    exitHold = now;
+                if (now - exitHold < exitDrain) // сервер не принимает данные - выходим без остатка
+                    break;
+            }
+            exitHold = clock_t::time_point();
+            std::list<msg_t>& lane = type == TypeMsg::normal ? l_msg_bulk : l_msg_control;
+            lane.splice(lane.end(), l_msg_TX, l_msg_TX.begin());
+        }
+    }
+
+    /// <summary>
+    /// метод отправки полосы управления. Служебные кадры малы и принимаются в буфер исходящих без ограничения,
+    /// поэтому ждут не дольше, чем уходит уже принятое в него: не больше bulkWindow массовых данных
+    /// </summary>
+    void SendControl()
+    {
+        for (auto it = l_msg_control.begin(); it != l_msg_control.end(); ) // идем по списку сообщений
+            if (it->Type() == TypeMsg::printinfo)
+            {
+                DeliverInfo(); // вывод информации
+                it = l_msg_control.erase(it);
+            }
+            else if (it->Type() == TypeMsg::sendFile)
+            {
+                std::string path(it->Payload());
+                if (sender.Active())
+                    PrintSystem("SYSTEM MSG: file transfer already in progress");
+                else if (!socket->GetConnected())
+                    PrintSystem("SYSTEM MSG: server not connected");
+                else if (!tcpSocket) // файл уходит через sendfile() сокета
+                    PrintSystem("SYSTEM MSG: file transfer needs a TCP connection");
+                else if (!sender.Start(path)) // дальше файл идет в тактах, пока сокет готов к отправке
+                    PrintSystem("SYSTEM MSG: can't open file");
+                it = l_msg_control.erase(it);
+            }
+            else if (it->Type() == TypeMsg::acceptFile)
+            {
+                receiver.Allow();
+                PrintSystem("SYSTEM MSG: next file from visavi will be received");
+                it = l_msg_control.erase(it);
+            }
+            else
+            {
+                if (it->Type() == TypeMsg::Exit) // мониторим команду на выход
+                {
+                    b_exit = true;
+                    if (!socket->GetConnected())
+                    {
+                        it = l_msg_control.erase(it);
+                        continue;
+                    }
+                }
+                if (it->Type() == TypeMsg::shutDown) // мониторим команду на отключение сервера
+                    b_shut = true;
+
+                if (b_connect || b_reconnect || sender.InFrame()) // подключение еще не завершено либо сокет занят частью файла, сообщения ждут
+                    break;
+
+                SendFrame(it->Str());
+                it = l_msg_control.erase(it); // при ошибке кадр не повторяем
+            }
+    }
+
+    /// <summary>
+    /// метод отправки массовой полосы. Сообщение длиннее bulkChunk уходит частями [PART], последняя часть -
+    /// обычным кадром [NORM]; собеседник склеивает их. Новые части добавляются, только пока буфер исходящих
+    /// меньше bulkWindow, поэтому служебный кадр вклинивается между частями, а не ждет все сообщение
+    /// </summary>
+    void SendBulk()
+    {
+        if (b_exit) // пользователь уходит: при живом соединении полоса ушла до кадра выхода, без связи отправлять некуда
+            l_msg_bulk.clear();
+        while (!l_msg_bulk.empty() && !b_connect && !b_reconnect && !sender.InFrame() && socket->Backlog() < bulkWindow)
+        {
+            msg_t& msg = l_msg_bulk.front();
+            std::string_view rest = msg.Payload().substr(msg.GetOffset()); // смещение - сколько текста уже ушло частями
+            if (rest.size() > bulkChunk)
+            {
+                size_t cut = bulkChunk;
+                while (cut > 0 && (static_cast<unsigned char>(rest[cut]) & 0xC0) == 0x80) // не режем символ UTF-8: граница - перед ведущим байтом
+                    --cut;
+                if (cut == 0) // не UTF-8, ведущего байта нет
+                    cut = bulkChunk;
+                msg_t chunk(TypeMsg::part, rest.substr(0, cut));
+                if (0 == SendFrame(chunk.Str()))
+                    msg.SetOffset(msg.GetOffset() + cut);
+                else
+                    l_msg_bulk.pop_front(); // при ошибке сообщение не повторяем
+            }
+            else
+            {
+                if (msg.GetOffset() == 0) // сообщение уходит целиком
+                    SendFrame(msg.Str());
+                else
+                    SendFrame(msg_t(TypeMsg::normal, rest).Str());
+                l_msg_bulk.pop_front();
+            }
+        }
+    }
+
+    /// <summary>
+    /// метод отправки кадра через буфер исходящих: что сокет не принял, дописывается по готовности
+    /// </summary>
+    /// <param name="frame"> -- кадр </param>
+    /// <returns> 0 - кадр отправлен либо принят в буфер; -1 - системная ошибка; -2 - соединение закрыто </returns>
+    int SendFrame(const std::string& frame)
+    {
+        int code = socket->SendBuffered(frame);
+        if (0 == code)
+        {
+            info.AddCountByte(frame.size()); // считаем трафик
+            lastTx = clock_t::now(); // сообщения чата заменяют проверку связи
+        }
+        else if (-2 == code) // сокет закрыт
+            PrintSystem("SYSTEM MSG: server not connected"); // диагностируем
+        return code;
+    }
+
+    /// <summary>
+    /// метод разбора части длинного кадра, выданной потоковым приемом. Текст сообщения чата пересобирается
+    /// в msg_RX кадром [PART] (последняя часть - кадром исходного типа) и дальше разбирается как обычный кадр,
+    /// поэтому сообщение любой длины выводится частями не длиннее rxChunk. Части прочих кадров отбрасываются
+    /// </summary>
+    /// <param name="b_last"> -- последняя часть, заканчивается признаком конца сообщения </param>
+    /// <returns> 1 - в msg_RX кадр для разбора </returns>
+    bool TakeStream(bool b_last)
+    {
+        std::string_view chunk(msg_RX.Str());
+        if (!b_rxStream) // первая часть начинается с заголовка
+        {
+            b_rxStream = true;
+            rxStreamType = msg_RX.Type();
+            chunk.remove_prefix(msg_t::headerSize);
+        }
+        if (b_last)
+        {
+            chunk.remove_suffix(msg_t::eomSize);
+            b_rxStream = false;
+        }
+
+        bool b_text = rxStreamType == TypeMsg::normal || rxStreamType == TypeMsg::part;
+        if (b_text)
+            msg_RX = msg_t(b_last ? rxStreamType : TypeMsg::part, chunk);
+        else if (b_last)
+            msg_RX = msg_t(); // конец длинного служебного кадра - как нераспознанное сообщение
+        return b_text || b_last;
+    }
+
+    /// <summary>
+    /// метод дописывания буфера исходящих перед закрытием сокета. Массовых данных в буфере не больше
+    /// bulkWindow, поэтому ожидание коротко; неотвечающий сервер задерживает выход не дольше exitDrain
+    /// </summary>
+    void DrainOutbox()
+    {
+        ALLOC_SCOPE(allocSend);
+        clock_t::time_point deadline = clock_t::now() + exitDrain;
+        while (socket->Flush() > 0 && clock_t::now() < deadline)
+        {
+            UpdateSendInterest();
+            multiplexor.Work(10);
+        }
+    }
+
+    /// <summary>
+    /// метод продвижения отправки файла
+    /// </summary>
+    /// <param name="b_frameOnly"> -- только дописать начатую часть </param>
+    void SendFileWork(bool b_frameOnly)
+    {
+        ALLOC_SCOPE(allocSend);
+        int code = sender.Work(*tcpSocket, b_frameOnly); // файл начинается только на TCP сокете (SendControl())
+        if (code >= 0)
+            lastTx = clock_t::now(); // части файла заменяют проверку связи
+        if (code == 0)
+            PrintSystem("SYSTEM MSG: file sent");
+        else if (code < 0)
+            PrintSystem("SYSTEM MSG: file transfer failed");
+    }
+
+    /// <summary>
+    /// метод управления ожиданием готовности сокета к отправке: сокет ждет POLLOUT, только пока
+    /// в буфере исходящих есть затор либо идет файл, иначе готовый к отправке сокет будил бы poll впустую.
+    /// У транспорта прогона дескриптора нет, его затор дописывается в каждом такте
+    /// </summary>
+    void UpdateSendInterest()
+    {
+        bool b_want = socket->GetConnected() && (socket->Backlog() > 0 || sender.Active());
+        if (!tcpSocket)
+        {
+            if (b_want)
+                OnWritable();
+            return;
+        }
+        if (b_want == b_sendInterest)
+            return;
+        if (b_want)
+            b_sendInterest = multiplexor.AddSender(tcpSocket, [this] { OnWritable(); });
+        else
+        {
+            multiplexor.deleteSender(tcpSocket);
+            b_sendInterest = false;
+        }
+    }
+
+    /// <summary>
+    /// обработчик готовности сокета к отправке, вызывается прямо из NonBlockSocket_manager_t::Work():
+    /// затор дописывается, как только ядро освободило место, не дожидаясь разбора такта
+    /// </summary>
+    void OnWritable()
+    {
+        ALLOC_SCOPE(allocSend);
+        size_t before = socket->Backlog();
+        if (socket->Flush() < 0)
+        {   // сокет с ошибкой готов к отправке на каждом poll: снимаем соединение, IoTick() уберет
+            // ожидание отправки и переподключится (из обработчика мультиплексор не трогаем)
+            socket->ResetConnected();
+            return;
+        }
+        if (socket->Backlog() < before) // файл продолжит IoTick()
+            txProgress = lastTx = clock_t::now();
+    }
+
+    /// <summary>
+    /// метод выполнения команды HISTORY
+    /// </summary>
+    /// <param name="args"> -- аргументы команды: начало и конец интервала </param>
+    void PrintHistory(std::string_view args)
+    {
+        size_t space = args.find(' ');
+        uint64_t from = 0, to = UINT64_MAX; // без конца - до последней записи
+        if (!history_t::ParseTime(args.substr(0, space), from) || (space != std::string_view::npos && !history_t::ParseTime(args.substr(space + 1), to, true)))
+        {
+            PrintLocal("SYSTEM MSG: bad time, use now, seconds, hh:mm[:ss] or yyyy-mm-dd[Thh:mm[:ss]]");
+            return;
+        }
+        std::vector<history_t::record_t> v_record;
+        int code = history.Query(from, to, v_record, historyLimit);
+        Console().PrintHistory(v_record);
+        if (code > 0)
+            PrintLocal("SYSTEM MSG: history has more messages, narrow the interval");
+        else if (code < 0)
+            PrintLocal("SYSTEM MSG: history is not available");
+        else if (v_record.empty())
+            PrintLocal("SYSTEM MSG: no messages in history for the interval");
+    }
+
+    /// <summary>
+    /// метод выполнения команды FIND
+    /// </summary>
+    /// <param name="words"> -- слова запроса </param>
+    void Find(std::string_view words)
+    {
+        search.Update(); // индекс догоняет историю целиком, иначе свежие сообщения не найдутся
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint64_t> v_offset;
+        size_t total = search.Find(words, v_offset, historyLimit);
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        std::vector<history_t::record_t> v_record(v_offset.size());
+        for (size_t indx = 0; indx < v_offset.size(); ++indx)
+            history.Read(v_offset[indx], v_record[indx]);
+        Console().PrintHistory(v_record);
+        PrintLocal("SYSTEM MSG: found " + std::to_string(total) + " message(s) in " + std::to_string(time.count()) + " us"
+            + (total > v_record.size() ? ", last " + std::to_string(v_record.size()) + " shown" : ""));
+    }
+
+    /// <summary>
+    /// метод вывода системного сообщения половины ввода-вывода
+    /// </summary>
+    /// <param name="text"> -- текст сообщения </param>
+    void PrintSystem(std::string_view text)
+    {
+        msg_t msg(TypeMsg::systemMsg, text);
+        Deliver(msg);
+    }
+
+    /// <summary>
+    /// метод вывода системного сообщения половины интерфейса
+    /// </summary>
+    /// <param name="text"> -- текст сообщения </param>
+    void PrintLocal(std::string_view text)
+    {
+        Console().PrintMsg(msg_t(TypeMsg::systemMsg, text));
+    }
+
+    /// <summary>
+    /// метод доступа к консоли
+    /// </summary>
+    /// <returns> ссылка на консоль </returns>
+    console_t& Console()
+    {
+#ifdef __WIN32__
+        return console;
+#else
+        return *console;
+#endif
+    }
+
+    /// <summary>
+    /// метод доступа к мультиплексору интерфейса
+    /// </summary>
+    /// <returns> в двухпоточном режиме - свой мультиплексор интерфейса, иначе общий </returns>
+    network::NonBlockSocket_manager_t& UiMultiplexor()
+    {
+        return b_threads ? uiMultiplexor : multiplexor;
+    }
+
+    static const size_t queueSize = 1024; // емкость очередей сообщений между потоками
+    static const size_t infoQueueSize = 4; // емкость очереди диагностики
+    static const size_t bufferQueueSize = 64; // емкость очередей свободных буферов сообщений между потоками
+    static const size_t poolKeep = 32; // свободных буферов сообщений, которые поток оставляет себе, излишек уходит другому потоку
+    static const size_t historyLimit = 200; // наибольшее количество записей истории в ответе
+    static const size_t searchBudget = 1000; // наибольшее количество записей истории, индексируемых за такт
+    static const size_t bulkChunk = 16 * 1024; // наибольший текст одной части сообщения чата
+    static const size_t rxChunk = 16 * 1024; // наибольший текст принятого сообщения, который копится до вывода
+    static const size_t bulkWindow = 2 * bulkChunk; // буфер исходящих, сверх которого части сообщений ждут в массовой полосе
+    static constexpr std::chrono::milliseconds exitDrain{ 1000 }; // наибольшее ожидание отправки буфера исходящих при выходе
+    static constexpr int deadPeriods = 3; // периодов проверки связи без признаков жизни до переподключения
+    static constexpr std::chrono::milliseconds retryMin{ 500 }; // первая задержка повторного подключения
+    static constexpr std::chrono::milliseconds retryMax{ 30000 }; // наибольшая задержка повторного подключения
+
+    typedef std::chrono::steady_clock clock_t;
+
     log_t logger;  // объект логгирования
-    std::shared_ptr<network::TCP_socketClient_t> socket; // клиентский сокет
+    std::shared_ptr<network::transport_t> socket; // транспорт соединения с сервером (TCP сокет создает Connect(), прогон подставляет канал в памяти)
+    std::shared_ptr<network::TCP_socketClient_t> tcpSocket; // TCP сокет транспорта для мультиплексора, подключения и отправки файла (пусто у прогона)
 #ifdef __WIN32__
     console_t console; // консоль
 #else
-    std::shared_ptr<console_t> console; // консоль 
+    std::shared_ptr<console_t> console; // консоль
 #endif
-    network::NonBlockSocket_manager_t multiplexor; // мультиплексор неблокирующих сокетов
+    network::NonBlockSocket_manager_t multiplexor; // мультиплексор неблокирующих сокетов (половина ввода-вывода)
+    network::NonBlockSocket_manager_t uiMultiplexor; // мультиплексор консоли в двухпоточном режиме
+    std::shared_ptr<network::wakeup_t> ioWakeup; // пробуждение потока ввода-вывода
+    std::shared_ptr<network::wakeup_t> uiWakeup; // пробуждение потока интерфейса
+    network::resolver_t resolver; // асинхронное разрешение имени сервера
+    network::connector_t connector; // подключение по нескольким адресам сервера
+    fileSender_t sender; // отправка файла
+    fileReceiver_t receiver; // прием файла
+    history_t history; // локальная история сообщений
+    searchIndex_t search; // полнотекстовый индекс истории
+    spscQueue_t<msg_t> txQueue; // сообщения от интерфейса к вводу-выводу
+    spscQueue_t<msg_t> rxQueue; // сообщения от ввода-вывода к интерфейсу
+    spscQueue_t<info_t> infoQueue; // снимки диагностики для команды INFO
+    spscQueue_t<std::string> ioBuffers; // свободные буферы сообщений от интерфейса к вводу-выводу
+    spscQueue_t<std::string> uiBuffers; // свободные буферы сообщений от ввода-вывода к интерфейсу
+    std::string host; // имя узла либо IP адрес сервера
+    std::string unixPath; // путь локального сокета сервера (пусто - подключение по узлу и порту)
+    unsigned short port; // порт сервера
     msg_t msg_RX; // буфер приходящего сообщения
+    std::string rxPartial; // начало сообщения собеседника, принятое частями [PART]; отправителя в кадре нет, поэтому буфер один и собирается только при одном собеседнике
+    bool b_rxStream; // потоковый прием выдает длинный кадр частями
+    TypeMsg rxStreamType; // тип кадра, принимаемого частями
     std::list<msg_t> l_msg_TX; // буферный список сообщений на отправку
+    std::list<msg_t> l_msg_control; // полоса управления: служебные кадры и локальные команды
+    std::list<msg_t> l_msg_bulk; // массовая полоса: сообщения чата, крупные уходят частями
+    std::list<msg_t> l_msg_RX; // принятые сообщения, не поместившиеся в очередь интерфейса
+    std::list<msg_t> l_msg_UI; // сообщения интерфейса, не поместившиеся в очередь ввода-вывода
     info_t info; // информация о соединении
     unsigned u_counter; // счетчик собеседников
     bool b_exit; // флаг выхода из программы
     bool b_shut; // флаг отправки команды на отключения сервера
     bool b_echo; // флаг эхоответа на отключение сервера
+    bool b_connect; // флаг незавершенного подключения к серверу
+    bool b_sendInterest; // сокет ждет готовности к отправке
+    bool b_online; // соединение с сервером было установлено и не закрыто нами
+    bool b_reconnect; // идет переподключение после потери связи
+    const bool b_threads; // флаг двухпоточного режима
+    std::atomic<bool> b_done; // поток ввода-вывода завершился
+    std::chrono::milliseconds heartbeat; // период проверки связи (0 - без проверки)
+    std::chrono::milliseconds retryDelay; // задержка следующего повторного подключения
+    clock_t::time_point retryAt; // время следующего повторного подключения
+    clock_t::time_point lastTx; // время последней отправки
+    clock_t::time_point txProgress; // время, когда буфер исходящих последний раз был пуст либо сдвинулся
+    clock_t::time_point exitHold; // время, с которого кадр выхода ждет отправки массовой полосы
+    size_t maxFrame; // наибольший размер принимаемого кадра (0 - без ограничения)
+};
+
+/// <summary>
+/// класс прогона цикла клиента (--bench): принятые сообщения сверяются с отправленными, а не выводятся
+/// </summary>
+class benchChat_t : public chat_manager_t
+{
+public:
+    /// <summary>
+    /// конструктор
+    /// </summary>
+    /// <param name="param"> -- параметры командной строки </param>
+    benchChat_t(const param_t& param) : chat_manager_t(param)
+    {}
+
+    /// <summary>
+    /// метод прогона цикла клиента без сервера (--bench): сообщения проходят тот же путь, что введенные с консоли
+    /// (полосы, SendBulk() с частями [PART], буфер исходящих), через канал в памяти к эхо-собеседнику и обратно
+    /// через прием IoTick() со сборкой частей. Принятый текст сверяется с отправленным вместо вывода на экран
+    /// </summary>
+    /// <param name="count"> -- количество сообщений </param>
+    /// <param name="size"> -- длина текста сообщения после номера, байт </param>
+    /// <param name="profile"> -- параметры канала </param>
+    /// <param name="out"> -- поток вывода отчета </param>
+    /// <returns> 0 - все сообщения вернулись без искажений; -1 - есть искаженные либо потерянные сообщения </returns>
+    int Bench(size_t count, size_t size, const network::pipeProfile_t& profile, std::ostream& out)
+    {
+        std::shared_ptr<network::pipeTransport_t> pipe = std::make_shared<network::pipeTransport_t>(logger);
+        network::pipeTransport_t echo(logger);
+        network::pipeTransport_t::Connect(*pipe, echo, profile);
+        socket = pipe; // транспорт задан до первого такта, Connect() его не заменяет и не вызывается
+        socket->SetFrameLength(&msg_t::FrameLength);
+        socket->SetMaxFrame(maxFrame);
+        b_connect = false;
+        b_online = true;
+        heartbeat = std::chrono::milliseconds(0); // эхо вернуло бы [HRBT] вместо текста
+        check.Reset(size);
+        out << "bench chat: " << count << " messages of " << benchText_t::seqSize + size << " bytes through IoTick() and echo\n";
+
+        std::string text; // текст очередного сообщения на отправку
+        std::string piece; // принятая эхом часть кадра
+        size_t sent = 0;
+        size_t lastBytes = 0;
+        int code = 0;
+        allocTrace_t::Reset(); // отчет не учитывает выделения запуска
+        clock_t::time_point start = clock_t::now();
+        clock_t::time_point progressAt = start;
+        while (check.Received() < count && 0 == code)
+        {
+            for (; sent < count && sent - check.Received() < queueSize; ++sent) // как интерфейс: не больше емкости очереди сообщений
+            {
+                ALLOC_SCOPE(allocInput);
+                benchText_t::Make(text, sent, size);
+                l_msg_TX.push_back(msg_t(TypeMsg::normal, text));
+            }
+            IoTick();
+            // эхо-собеседник возвращает принятые байты как есть, длинный кадр - частями
+            ALLOC_SCOPE(allocPeer);
+            int rxCode;
+            while ((rxCode = echo.ReciveStream(piece, msg_t::EOM(), rxChunk)) >= 0)
+                if (2 != rxCode) // часть еще не набрана, принятое остается в буфере
+                {
+                    if (echo.SendBuffered(piece) < 0)
+                        code = -1;
+                    piece.clear();
+                }
+            if (-3 != rxCode || echo.Flush() < 0 || b_reconnect || !socket->GetConnected())
+            {
+                logger.doLog("benchChat_t::Bench() pipe fail, code: ", rxCode);
+                code = -1;
+            }
+
+            clock_t::time_point now = clock_t::now();
+            if (check.Bytes() != lastBytes)
+            {
+                lastBytes = check.Bytes();
+                progressAt = now;
+            }
+            else if (now - progressAt > stallTimeout)
+            {
+                logger.doLog("benchChat_t::Bench() no progress, messages received: ", static_cast<int>(check.Received()));
+                code = -1;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(clock_t::now() - start).count();
+        double divider = count > 0 ? static_cast<double>(count) : 1.0;
+        out << "bench chat: " << check.Received() << " messages, " << seconds * 1000.0 << " ms, " << (seconds > 0.0 ? check.Received() / seconds : 0.0)
+            << " messages/s, " << seconds * 1e9 / divider << " ns/message, partial writes " << pipe->PartialSends() << '\n';
+        allocTrace_t::Report(out);
+        b_exit = true; // собеседнику прогона кадр выхода не нужен
+        if (check.Received() != count || check.Errors() != 0)
+        {
+            out << "bench chat failed: received " << check.Received() << " of " << count << ", corrupted " << check.Errors() << '\n';
+            return -1;
+        }
+        return 0;
+    }
+protected:
+    static constexpr std::chrono::seconds stallTimeout{ 5 }; // время прогона без принятого текста, после которого он прерывается
+
+    /// <summary>
+    /// метод сверки принятого текста с отправленным: сообщение может прийти несколькими частями
+    /// не длиннее rxChunk, каждая продолжает текст очередного сообщения
+    /// </summary>
+    /// <param name="msg"> -- принятое сообщение </param>
+    void Deliver(msg_t& msg) override
+    {
+        ALLOC_SCOPE(allocParse);
+        if (msg.Type() != TypeMsg::normal) // прогон отправляет только текст
+            check.Reject();
+        check.Check(msg.Payload());
+        if (check.Whole())
+            check.End();
+    }
+
+    benchText_t check; // сверка принятых сообщений
 };
 
 /// <summary>
@@ -546,25 +1438,37 @@ protected:
 /// </summary>
 /// <param name="argc"> - количество параметров </param>
 /// <param name="argv"> - массив параметров </param>
-/// <param name="r_port"> - ссылка на порт для прослушки </param>
+/// <param name="r_param"> - ссылка на параметры </param>
 /// <returns> 1 - праметры распознаны </returns>
-bool parseParam(int argc, char* argv[], unsigned& r_port);
+bool parseParam(int argc, char* argv[], param_t& r_param);
 
 int main(int argc, char* argv[])
 {
     printf("run_client\n");
-    unsigned u32_port = 0;
+    param_t param;
+    int result = EXIT_SUCCESS;
 
-    if (parseParam(argc, argv, u32_port))
+    if (!parseParam(argc, argv, param))
+        printf("Invalid parametr's. Please enter the number_port [server_host] (or --unix=socket_path) [--profile=default|low-latency|throughput] [--spin=us] [--cpu=N] [--history=path] [--threads] [--heartbeat=ms] [--max-frame=bytes] [--max-file=bytes]\n"
+               "or --bench=N [--bench-size=bytes] [--pipe-latency=us] [--pipe-bandwidth=bytes_per_sec] [--pipe-write=bytes] [--pipe-capacity=bytes] [--pipe-drop] [--bench-shm[=ring_bytes]]\n");
+    else if (param.bench > 0)
+    {   // прогон без сервера: сначала транспорт отдельно, затем цикл клиента через канал в памяти
+        log_t logger;
+        bench_t bench(param.pipe, param.benchShm, logger);
+        if (bench.Run(param.bench, param.benchSize, std::cout) != 0)
+            result = EXIT_FAILURE;
+        benchChat_t chat(param);
+        if (chat.Bench(param.bench, param.benchSize, param.pipe, std::cout) != 0)
+            result = EXIT_FAILURE;
+    }
+    else
     {
-        chat_manager_t chat(u32_port);
+        chat_manager_t chat(param);
         chat.Work();
     }
-    else
-        printf("Invalid parametr's. Please enter the number_port\n");
 
     printf("client_shutdown\n");
-    return EXIT_SUCCESS;
+    return result;
 }
 
 /// <summary>
@@ -572,18 +1476,136 @@ int main(int argc, char* argv[])
 /// </summary>
 /// <param name="argc"> - количество параметров </param>
 /// <param name="argv"> - массив параметров </param>
-/// <param name="r_port"> - ссылка на порт для прослушки </param>
+/// <param name="r_param"> - ссылка на параметры </param>
 /// <returns> 1 - праметры распознаны </returns>
-bool parseParam(int argc, char* argv[], unsigned& r_port)
+bool parseParam(int argc, char* argv[], param_t& r_param)
 {
-    bool b_result = false;
+    const std::string_view profileKey = "--profile=";
+    const std::string_view spinKey = "--spin=";
+    const std::string_view cpuKey = "--cpu=";
+    const std::string_view historyKey = "--history=";
+    const std::string_view heartbeatKey = "--heartbeat=";
+    const std::string_view maxFrameKey = "--max-frame=";
+    const std::string_view maxFileKey = "--max-file=";
+    const std::string_view unixKey = "--unix=";
+    const std::string_view benchKey = "--bench=";
+    const std::string_view benchSizeKey = "--bench-size=";
+    const std::string_view latencyKey = "--pipe-latency=";
+    const std::string_view bandwidthKey = "--pipe-bandwidth=";
+    const std::string_view writeKey = "--pipe-write=";
+    const std::string_view capacityKey = "--pipe-capacity=";
+    const std::string_view shmKey = "--bench-shm=";
+    int positional = 0; // количество позиционных параметров (порт, узел)
+    bool b_result = true;
 
-    if (argc == 2)
+    for (int indx = 1; indx < argc && b_result; ++indx)
     {
-        r_port = std::strtoul(argv[1], NULL, 10);
-        b_result = r_port != 0 && r_port != 0xFFFFFFFFUL;
+        std::string_view arg = argv[indx];
+        if (arg.substr(0, profileKey.size()) == profileKey)
+        {
+            r_param.profile = network::profile_t::Parse(std::string(arg.substr(profileKey.size())));
+            b_result = r_param.profile >= 0;
+        }
+        else if (arg.substr(0, spinKey.size()) == spinKey)
+            r_param.spin = std::strtoul(argv[indx] + spinKey.size(), NULL, 10);
+        else if (arg.substr(0, cpuKey.size()) == cpuKey)
+        {
+            char* end = nullptr;
+            r_param.cpu = std::strtol(argv[indx] + cpuKey.size(), &end, 10);
+            unsigned cpus = std::thread::hardware_concurrency(); // 0 - число ядер неизвестно
+            b_result = end != argv[indx] + cpuKey.size() && r_param.cpu >= 0 && (cpus == 0 || static_cast<unsigned>(r_param.cpu) < cpus);
+        }
+        else if (arg.substr(0, historyKey.size()) == historyKey)
+        {
+            r_param.history = argv[indx] + historyKey.size();
+            b_result = !r_param.history.empty();
+        }
+        else if (arg.substr(0, maxFrameKey.size()) == maxFrameKey)
+        {
+            char* end = nullptr;
+            r_param.maxFrame = std::strtoull(argv[indx] + maxFrameKey.size(), &end, 10);
+            b_result = end != argv[indx] + maxFrameKey.size();
+        }
+        else if (arg.substr(0, maxFileKey.size()) == maxFileKey)
+        {
+            char* end = nullptr;
+            r_param.maxFile = std::strtoull(argv[indx] + maxFileKey.size(), &end, 10);
+            b_result = end != argv[indx] + maxFileKey.size();
+        }
+        else if (arg.substr(0, heartbeatKey.size()) == heartbeatKey)
+        {
+            char* end = nullptr;
+            r_param.heartbeat = std::strtoul(argv[indx] + heartbeatKey.size(), &end, 10);
+            b_result = end != argv[indx] + heartbeatKey.size();
+        }
+        else if (arg.substr(0, unixKey.size()) == unixKey)
+        {
+            r_param.unixPath = argv[indx] + unixKey.size();
+            b_result = network::endpoint_t().SetPath(r_param.unixPath.c_str()); // путь должен поместиться в адрес
+        }
+        else if (arg.substr(0, benchKey.size()) == benchKey)
+        {
+            char* end = nullptr;
+            r_param.bench = std::strtoull(argv[indx] + benchKey.size(), &end, 10);
+            b_result = end != argv[indx] + benchKey.size() && r_param.bench > 0;
+        }
+        else if (arg.substr(0, benchSizeKey.size()) == benchSizeKey)
+        {
+            char* end = nullptr;
+            r_param.benchSize = std::strtoull(argv[indx] + benchSizeKey.size(), &end, 10);
+            b_result = end != argv[indx] + benchSizeKey.size();
+        }
+        else if (arg.substr(0, latencyKey.size()) == latencyKey)
+        {
+            char* end = nullptr;
+            r_param.pipe.latency = std::strtoul(argv[indx] + latencyKey.size(), &end, 10);
+            b_result = end != argv[indx] + latencyKey.size();
+        }
+        else if (arg.substr(0, bandwidthKey.size()) == bandwidthKey)
+        {
+            char* end = nullptr;
+            r_param.pipe.bandwidth = std::strtoull(argv[indx] + bandwidthKey.size(), &end, 10);
+            b_result = end != argv[indx] + bandwidthKey.size();
+        }
+        else if (arg.substr(0, writeKey.size()) == writeKey)
+        {
+            char* end = nullptr;
+            r_param.pipe.maxWrite = std::strtoull(argv[indx] + writeKey.size(), &end, 10);
+            b_result = end != argv[indx] + writeKey.size();
+        }
+        else if (arg.substr(0, capacityKey.size()) == capacityKey)
+        {
+            char* end = nullptr;
+            r_param.pipe.capacity = std::strtoull(argv[indx] + capacityKey.size(), &end, 10);
+            b_result = end != argv[indx] + capacityKey.size() && r_param.pipe.capacity > 0;
+        }
+        else if (arg == "--pipe-drop")
+            r_param.pipe.b_dropOnClose = true;
+        else if (arg == "--bench-shm")
+            r_param.benchShm = network::shmTransport_t::defaultRing;
+        else if (arg.substr(0, shmKey.size()) == shmKey)
+        {   // кольцо адресуется по маске
+            char* end = nullptr;
+            r_param.benchShm = std::strtoull(argv[indx] + shmKey.size(), &end, 10);
+            b_result = end != argv[indx] + shmKey.size() && r_param.benchShm > 0 && (r_param.benchShm & (r_param.benchShm - 1)) == 0;
+        }
+        else if (arg == "--threads")
+            r_param.threads = true;
+        else if (positional == 0)
+        {
+            r_param.port = std::strtoul(argv[indx], NULL, 10);
+            b_result = r_param.port != 0 && r_param.port <= 0xFFFF;
+            ++positional;
+        }
+        else if (positional == 1)
+        {
+            r_param.host = argv[indx];
+            ++positional;
+        }
+        else
+            b_result = false;
     }
 
-    return b_result;
+    return b_result && (positional > 0 || r_param.bench > 0 || !r_param.unixPath.empty()); // прогону сервер не нужен, локальному сокету - порт
 }
 